@@ -0,0 +1,115 @@
+"""Benchmark every fast_stringcase function, and the pure-Python stringcase
+package it is ported from, across input shapes.
+
+    pip install pyperf stringcase
+    python benchmarks/bench_stringcase.py -o before.json
+    python benchmarks/bench_stringcase.py -o after.json
+    python -m pyperf compare_to before.json after.json --table
+
+Benchmarks are named ``<library>/<case>/<text>/<form>/<length>/<mode>``:
+  text    ascii or unicode (German and Japanese words mixed in)
+  form    mixed (needs converting) or normalized (already in the target case)
+  length  input length in characters, 8 up to 1M
+  mode    single (one call) or batch (a list of inputs, via *_many for
+          fast_stringcase and a list comprehension for stringcase)
+
+The full sweep is large; narrow it with --cases, --lengths, --texts, --forms,
+--modes and --libraries, and use pyperf's own options (--fast, --rigorous,
+-p) to trade precision for time.
+"""
+
+import random
+
+import pyperf
+
+import fast_stringcase
+
+try:
+    import stringcase
+except ImportError:
+    stringcase = None
+
+CASES = [
+    "lowercase", "uppercase", "snakecase", "camelcase", "capitalcase",
+    "pascalcase", "constcase", "pathcase", "backslashcase", "spinalcase",
+    "dotcase", "titlecase", "trimcase", "alphanumcase", "sentencecase",
+]
+LENGTHS = [8, 64, 1024, 65536, 1048576]
+TEXTS = ["ascii", "unicode"]
+FORMS = ["mixed", "normalized"]
+MODES = ["single", "batch"]
+LIBRARIES = ["fast_stringcase", "stringcase"]
+
+ASCII_WORDS = ["user", "Name", "id", "HTTP", "response", "Code", "value", "x2", "Field", "count"]
+UNICODE_WORDS = ["Straße", "äpfel", "Größe", "名前", "値", "ÖL", "naïve", "Ünit", "user", "Id"]
+SEPARATORS = ["", "", "_", "-", ".", " "]
+
+# Batches hold up to this many characters in total, and at most BATCH_ITEMS inputs
+BATCH_CHARS = 1 << 20
+BATCH_ITEMS = 1000
+
+
+def make_text(rng, length, words):
+    parts = []
+    total = 0
+    while total < length:
+        part = rng.choice(SEPARATORS) + rng.choice(words)
+        parts.append(part)
+        total += len(part)
+    return "".join(parts)[:length]
+
+
+def make_inputs(case, text, form, length, count, seed):
+    rng = random.Random(seed)
+    words = ASCII_WORDS if text == "ascii" else UNICODE_WORDS
+    items = [make_text(rng, length, words) for _ in range(count)]
+    if form == "normalized":
+        convert = getattr(fast_stringcase, case)
+        items = [convert(s) for s in items]
+    return items
+
+
+def convert_each(convert, items):
+    return [convert(s) for s in items]
+
+
+def add_arguments(cmd):
+    cmd.add_argument("--cases", default=",".join(CASES), help="comma-separated case functions")
+    cmd.add_argument("--lengths", default=",".join(map(str, LENGTHS)), help="comma-separated input lengths")
+    cmd.add_argument("--texts", default=",".join(TEXTS), help="ascii, unicode")
+    cmd.add_argument("--forms", default=",".join(FORMS), help="mixed, normalized")
+    cmd.add_argument("--modes", default=",".join(MODES), help="single, batch")
+    cmd.add_argument("--libraries", default=",".join(LIBRARIES), help="fast_stringcase, stringcase")
+
+
+def main():
+    runner = pyperf.Runner(add_cmdline_args=lambda cmd, args: cmd.extend(
+        ["--cases", args.cases, "--lengths", args.lengths, "--texts", args.texts,
+         "--forms", args.forms, "--modes", args.modes, "--libraries", args.libraries]))
+    add_arguments(runner.argparser)
+    runner.metadata["fast_stringcase_simd"] = fast_stringcase.fast_stringcase._simd
+    args = runner.parse_args()
+
+    libraries = args.libraries.split(",")
+    if "stringcase" in libraries and stringcase is None:
+        libraries.remove("stringcase")
+    for case in args.cases.split(","):
+        for text in args.texts.split(","):
+            for form in args.forms.split(","):
+                for length in map(int, args.lengths.split(",")):
+                    batch_count = max(1, min(BATCH_ITEMS, BATCH_CHARS // length))
+                    items = make_inputs(case, text, form, length, batch_count, seed=length)
+                    for mode in args.modes.split(","):
+                        for library in libraries:
+                            module = fast_stringcase if library == "fast_stringcase" else stringcase
+                            name = "%s/%s/%s/%s/%d/%s" % (library, case, text, form, length, mode)
+                            if mode == "single":
+                                runner.bench_func(name, getattr(module, case), items[0])
+                            elif library == "fast_stringcase":
+                                runner.bench_func(name, getattr(module, case + "_many"), items)
+                            else:
+                                runner.bench_func(name, convert_each, getattr(module, case), items)
+
+
+if __name__ == "__main__":
+    main()
@@ -1,3 +1,5 @@
+import collections.abc
+
 from .fast_stringcase import (
     lowercase,
     uppercase,
@@ -15,4 +17,57 @@ from .fast_stringcase import (
     trimcase,
     alphanumcase,
     sentencecase,
+    lowercase_many,
+    uppercase_many,
+    snakecase_many,
+    camelcase_many,
+    capitalcase_many,
+    pascalcase_many,
+    constcase_many,
+    pathcase_many,
+    backslashcase_many,
+    spinalcase_many,
+    dotcase_many,
+    titlecase_many,
+    trimcase_many,
+    alphanumcase_many,
+    sentencecase_many,
+    lowercase_inplace,
+    uppercase_inplace,
+    snakecase_inplace,
+    constcase_inplace,
+    pathcase_inplace,
+    backslashcase_inplace,
+    spinalcase_inplace,
+    dotcase_inplace,
+    Converter,
+    transform_keys,
+    words,
+    convert,
+    CaseNormalizedDict,
+    case_equal,
+    canonical_hash,
+    detect_case,
+    detect_case_many,
+    ensure_case,
+    StreamConverter,
+    convert_file,
+    convert_arrow,
+    ArrowStringArray,
+    loads,
+    cache_configure,
+    cache_info,
+    cache_clear,
+    enable_stats,
+    stats,
+    reset_stats,
+    _C_API,
 )
+
+collections.abc.MutableMapping.register(CaseNormalizedDict)
+
+
+def get_include():
+    """Directory of fast_stringcase_capi.h, for C extensions using the C API."""
+    import os
+    return os.path.dirname(os.path.abspath(__file__))
@@ -0,0 +1,49 @@
+"""Convert the records of a file: python -m fast_stringcase --case snake [--field N] in out"""
+
+import argparse
+import codecs
+import os
+import sys
+
+from . import convert_file
+
+
+def _byte(value):
+    """A single-byte delimiter, with backslash escapes such as \\t allowed."""
+    try:
+        data = codecs.decode(value, "unicode_escape").encode("latin-1")
+    except (UnicodeDecodeError, UnicodeEncodeError):
+        data = b""
+    if len(data) != 1:
+        raise argparse.ArgumentTypeError("expected a single byte, got %r" % value)
+    return data
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(
+        prog="python -m fast_stringcase",
+        description="Convert every line of a file, or one field of every line, to another case. "
+                    "The input is memory-mapped and converted on native threads.",
+    )
+    parser.add_argument("--case", required=True, help="case function, e.g. snake, camelcase or const")
+    parser.add_argument("--field", type=int, metavar="N", help="convert only field N (1-based) of each record")
+    parser.add_argument("--field-delimiter", type=_byte, default=b",", metavar="D",
+                        help="byte separating fields (default ',')")
+    parser.add_argument("--delimiter", type=_byte, default=b"\n", metavar="D",
+                        help="byte separating records (default '\\n')")
+    parser.add_argument("--threads", type=int, default=os.cpu_count() or 1, metavar="N",
+                        help="converting threads (default: one per CPU)")
+    parser.add_argument("input")
+    parser.add_argument("output")
+    args = parser.parse_args(argv)
+    try:
+        convert_file(args.input, args.output, args.case, field=args.field, delimiter=args.delimiter,
+                     field_delimiter=args.field_delimiter, threads=args.threads)
+    except (OSError, ValueError) as e:
+        print("%s: error: %s" % (parser.prog, e), file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,383 @@
+// ASCII character classes and the bulk primitives the case kernels are built
+// on, with SSE2 and AVX2 versions picked at module init (cc_select).
+//
+// Bytes are classified here rather than through <ctype.h>, whose answers
+// depend on the process locale. Measure functions and kernels must agree
+// exactly on every byte. Only pure-ASCII strings reach these primitives;
+// everything else goes through the Unicode kernels (unicase.h).
+
+#ifndef FAST_STRINGCASE_CHARCLASS_H
+#define FAST_STRINGCASE_CHARCLASS_H
+
+#include <stddef.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define CC_HAVE_X86_64 1
+#include <immintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Signed size type used throughout the core. It has the width of
+// Py_ssize_t, so the Python binding passes lengths straight through.
+typedef ptrdiff_t fsc_ssize_t;
+
+#define CC_STR2(x) #x
+#define CC_STR(x) CC_STR2(x)
+
+// --- ASCII Character Classes ---
+
+static inline int ascii_isupper(unsigned char c) { return (unsigned char)(c - 'A') < 26; }
+static inline int ascii_islower(unsigned char c) { return (unsigned char)(c - 'a') < 26; }
+static inline int ascii_isdigit(unsigned char c) { return (unsigned char)(c - '0') < 10; }
+static inline int ascii_isalnum(unsigned char c) {
+    return ascii_isupper(c) || ascii_islower(c) || ascii_isdigit(c);
+}
+static inline int ascii_isspace(unsigned char c) { return c == ' ' || (unsigned char)(c - '\t') < 5; }
+static inline unsigned char ascii_tolower(unsigned char c) { return ascii_isupper(c) ? c + ('a' - 'A') : c; }
+static inline unsigned char ascii_toupper(unsigned char c) { return ascii_islower(c) ? c - ('a' - 'A') : c; }
+
+// Returns 1 for the separators snakecase folds into its joiner
+static inline int is_snake_separator(char c) {
+    return c == '-' || c == '.' || c == ' ' || c == '_';
+}
+
+// Byte classes for cc_span_without, combined as a bit set
+#define CC_CLASS_UPPER 0x01u
+#define CC_CLASS_LOWER 0x02u
+#define CC_CLASS_NON_ALNUM 0x04u
+#define CC_CLASS_DASH 0x08u
+#define CC_CLASS_DOT 0x10u
+#define CC_CLASS_SPACE 0x20u      // ' ' only, not other whitespace
+#define CC_CLASS_UNDERSCORE 0x40u
+#define CC_CLASS_SEPARATORS (CC_CLASS_DASH | CC_CLASS_DOT | CC_CLASS_SPACE | CC_CLASS_UNDERSCORE)
+
+// Further classes reported only by cc_classes_present, which detects case
+// styles. A word starts at index 0 and after every separator.
+#define CC_CLASS_SLASH 0x80u
+#define CC_CLASS_OTHER 0x100u          // Neither alphanumeric, a separator nor '/'
+#define CC_CLASS_UPPER_INITIAL 0x200u  // Uppercase letter starting a word
+#define CC_CLASS_UPPER_INNER 0x400u    // Uppercase letter inside a word
+#define CC_CLASS_LOWER_INITIAL 0x800u  // Lowercase letter starting a word
+
+// The one class of a byte for cc_classes_present: 0 for digits, and
+// CC_CLASS_OTHER in place of CC_CLASS_NON_ALNUM
+static inline unsigned int cc_class_of(unsigned char c) {
+    if (ascii_isupper(c)) { return CC_CLASS_UPPER; }
+    if (ascii_islower(c)) { return CC_CLASS_LOWER; }
+    if (ascii_isdigit(c)) { return 0; }
+    switch (c) {
+    case '-': return CC_CLASS_DASH;
+    case '.': return CC_CLASS_DOT;
+    case ' ': return CC_CLASS_SPACE;
+    case '_': return CC_CLASS_UNDERSCORE;
+    case '/': return CC_CLASS_SLASH;
+    default: return CC_CLASS_OTHER;
+    }
+}
+
+// cc_class_of plus the word-position class of a letter
+static inline unsigned int cc_position_class(unsigned int class_bit, int word_start) {
+    if (class_bit == CC_CLASS_UPPER) {
+        return CC_CLASS_UPPER | (word_start ? CC_CLASS_UPPER_INITIAL : CC_CLASS_UPPER_INNER);
+    }
+    return class_bit == CC_CLASS_LOWER && word_start ? CC_CLASS_LOWER | CC_CLASS_LOWER_INITIAL : class_bit;
+}
+
+static inline int cc_in_classes(unsigned char c, unsigned int classes) {
+    return ((classes & CC_CLASS_UPPER) && ascii_isupper(c))
+        || ((classes & CC_CLASS_LOWER) && ascii_islower(c))
+        || ((classes & CC_CLASS_NON_ALNUM) && !ascii_isalnum(c))
+        || ((classes & CC_CLASS_DASH) && c == '-')
+        || ((classes & CC_CLASS_DOT) && c == '.')
+        || ((classes & CC_CLASS_SPACE) && c == ' ')
+        || ((classes & CC_CLASS_UNDERSCORE) && c == '_');
+}
+
+// Index of the lowest set bit; mask must be non-zero
+static inline int cc_ctz(unsigned int mask) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (int)index;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+// --- Scalar Primitives ---
+//
+// Used on platforms without a vector path, for inputs shorter than a vector
+// and for the tail of every vector loop.
+
+static inline void cc_lower_scalar(const char* in, fsc_ssize_t len, char* out) {
+    for (fsc_ssize_t i = 0; i < len; i++) {
+        out[i] = ascii_tolower((unsigned char)in[i]);
+    }
+}
+
+static inline void cc_upper_scalar(const char* in, fsc_ssize_t len, char* out) {
+    for (fsc_ssize_t i = 0; i < len; i++) {
+        out[i] = ascii_toupper((unsigned char)in[i]);
+    }
+}
+
+static inline fsc_ssize_t cc_count_upper_scalar(const char* in, fsc_ssize_t len) {
+    fsc_ssize_t count = 0;
+    for (fsc_ssize_t i = 0; i < len; ++i) {
+        count += ascii_isupper((unsigned char)in[i]);
+    }
+    return count;
+}
+
+static inline fsc_ssize_t cc_count_alnum_scalar(const char* in, fsc_ssize_t len) {
+    fsc_ssize_t count = 0;
+    for (fsc_ssize_t i = 0; i < len; ++i) {
+        count += ascii_isalnum((unsigned char)in[i]);
+    }
+    return count;
+}
+
+static inline fsc_ssize_t cc_count_sentence_scalar(const char* in, fsc_ssize_t len) {
+    fsc_ssize_t count = 0;
+    for (fsc_ssize_t i = 0; i < len; ++i) {
+        int prev_separator = is_snake_separator(in[i - 1]);
+        if (is_snake_separator(in[i])) {
+            count += !prev_separator;
+        } else {
+            count += 1 + (ascii_isupper((unsigned char)in[i]) && !prev_separator);
+        }
+    }
+    return count;
+}
+
+static inline fsc_ssize_t cc_span_alnum_scalar(const char* in, fsc_ssize_t len) {
+    fsc_ssize_t i = 0;
+    while (i < len && ascii_isalnum((unsigned char)in[i])) { i++; }
+    return i;
+}
+
+// Length of the leading run of bytes in none of `classes`
+static inline fsc_ssize_t cc_span_without_scalar(const char* in, fsc_ssize_t len, unsigned int classes) {
+    fsc_ssize_t i = 0;
+    while (i < len && !cc_in_classes((unsigned char)in[i], classes)) { i++; }
+    return i;
+}
+
+// Union of the classes of every byte, with positions; in[-1] must be
+// readable, as it decides whether in[0] starts a word
+static inline unsigned int cc_classes_present_scalar(const char* in, fsc_ssize_t len) {
+    unsigned int classes = 0;
+    for (fsc_ssize_t i = 0; i < len; ++i) {
+        classes |= cc_position_class(cc_class_of((unsigned char)in[i]), is_snake_separator(in[i - 1]));
+    }
+    return classes;
+}
+
+static inline fsc_ssize_t cc_compact_alnum_scalar(const char* in, fsc_ssize_t len, char* out) {
+    // Branch-free: every byte is stored, but only alphanumerics advance, so
+    // one byte past the result may be overwritten
+    fsc_ssize_t written = 0;
+    for (fsc_ssize_t i = 0; i < len; i++) {
+        out[written] = in[i];
+        written += ascii_isalnum((unsigned char)in[i]);
+    }
+    return written;
+}
+
+// The run kernels copy nothing without vectors; the callers' byte loops do it
+static inline fsc_ssize_t cc_run_scalar(const char* in, fsc_ssize_t len, char* out) {
+    (void)in;
+    (void)len;
+    (void)out;
+    return 0;
+}
+
+static inline fsc_ssize_t cc_snake_run_scalar(const char* in, fsc_ssize_t len, char* out, char joiner, int upper) {
+    (void)in;
+    (void)len;
+    (void)out;
+    (void)joiner;
+    (void)upper;
+    return 0;
+}
+
+// --- Dispatch Table ---
+
+typedef struct {
+    const char* name;
+    fsc_ssize_t width; // Bytes per vector, 0 for the scalar table
+    void (*lower)(const char* in, fsc_ssize_t len, char* out);
+    void (*upper)(const char* in, fsc_ssize_t len, char* out);
+    fsc_ssize_t (*count_upper)(const char* in, fsc_ssize_t len);
+    fsc_ssize_t (*count_alnum)(const char* in, fsc_ssize_t len);
+    fsc_ssize_t (*count_sentence)(const char* in, fsc_ssize_t len);
+    fsc_ssize_t (*span_alnum)(const char* in, fsc_ssize_t len);
+    fsc_ssize_t (*span_without)(const char* in, fsc_ssize_t len, unsigned int classes);
+    unsigned int (*classes_present)(const char* in, fsc_ssize_t len);
+    fsc_ssize_t (*compact_alnum)(const char* in, fsc_ssize_t len, char* out);
+    fsc_ssize_t (*snake_run)(const char* in, fsc_ssize_t len, char* out, char joiner, int upper);
+    fsc_ssize_t (*title_run)(const char* in, fsc_ssize_t len, char* out);
+    fsc_ssize_t (*sentence_run)(const char* in, fsc_ssize_t len, char* out);
+} CharClassOps;
+
+static const CharClassOps cc_ops_scalar = {
+    "scalar",
+    0,
+    cc_lower_scalar,
+    cc_upper_scalar,
+    cc_count_upper_scalar,
+    cc_count_alnum_scalar,
+    cc_count_sentence_scalar,
+    cc_span_alnum_scalar,
+    cc_span_without_scalar,
+    cc_classes_present_scalar,
+    cc_compact_alnum_scalar,
+    cc_snake_run_scalar,
+    cc_run_scalar,
+    cc_run_scalar,
+};
+
+#ifdef CC_HAVE_X86_64
+
+#if defined(_MSC_VER)
+#define CC_TARGET_AVX2
+#else
+#define CC_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+// SSE2 is part of the x86-64 baseline, so it needs no target attribute
+#define CC_SUFFIX sse2
+#define CC_TARGET
+#define CC_WIDTH 16
+#define CC_FULL_MASK 0xFFFFu
+#define V __m128i
+#define V_LOAD(p) _mm_loadu_si128((const __m128i*)(const void*)(p))
+#define V_STORE(p, v) _mm_storeu_si128((__m128i*)(void*)(p), (v))
+#define V_SET1(c) _mm_set1_epi8((char)(c))
+#define V_ZERO _mm_setzero_si128()
+#define V_ADD _mm_add_epi8
+#define V_SUB _mm_sub_epi8
+#define V_AND _mm_and_si128
+#define V_OR _mm_or_si128
+#define V_ANDNOT _mm_andnot_si128
+#define V_CMPEQ _mm_cmpeq_epi8
+#define V_CMPLT _mm_cmplt_epi8
+#define V_MOVEMASK _mm_movemask_epi8
+#define V_HSUM(v) cc_hsum_sse2(v)
+
+static inline fsc_ssize_t cc_hsum_sse2(__m128i v) {
+    __m128i sums = _mm_sad_epu8(v, _mm_setzero_si128());
+    return (fsc_ssize_t)_mm_cvtsi128_si64(sums) + (fsc_ssize_t)_mm_cvtsi128_si64(_mm_unpackhi_epi64(sums, sums));
+}
+
+#include "charclass_simd.h"
+
+#undef CC_SUFFIX
+#undef CC_TARGET
+#undef CC_WIDTH
+#undef CC_FULL_MASK
+#undef V
+#undef V_LOAD
+#undef V_STORE
+#undef V_SET1
+#undef V_ZERO
+#undef V_ADD
+#undef V_SUB
+#undef V_AND
+#undef V_OR
+#undef V_ANDNOT
+#undef V_CMPEQ
+#undef V_CMPLT
+#undef V_MOVEMASK
+#undef V_HSUM
+
+#define CC_SUFFIX avx2
+#define CC_TARGET CC_TARGET_AVX2
+#define CC_WIDTH 32
+#define CC_FULL_MASK 0xFFFFFFFFu
+#define V __m256i
+#define V_LOAD(p) _mm256_loadu_si256((const __m256i*)(const void*)(p))
+#define V_STORE(p, v) _mm256_storeu_si256((__m256i*)(void*)(p), (v))
+#define V_SET1(c) _mm256_set1_epi8((char)(c))
+#define V_ZERO _mm256_setzero_si256()
+#define V_ADD _mm256_add_epi8
+#define V_SUB _mm256_sub_epi8
+#define V_AND _mm256_and_si256
+#define V_OR _mm256_or_si256
+#define V_ANDNOT _mm256_andnot_si256
+#define V_CMPEQ _mm256_cmpeq_epi8
+#define V_CMPLT(a, b) _mm256_cmpgt_epi8((b), (a))
+#define V_MOVEMASK _mm256_movemask_epi8
+#define V_HSUM(v) cc_hsum_avx2(v)
+
+static inline CC_TARGET_AVX2 fsc_ssize_t cc_hsum_avx2(__m256i v) {
+    __m256i sums = _mm256_sad_epu8(v, _mm256_setzero_si256());
+    __m128i pair = _mm_add_epi64(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+    return (fsc_ssize_t)_mm_cvtsi128_si64(pair) + (fsc_ssize_t)_mm_cvtsi128_si64(_mm_unpackhi_epi64(pair, pair));
+}
+
+#include "charclass_simd.h"
+
+#undef CC_SUFFIX
+#undef CC_TARGET
+#undef CC_WIDTH
+#undef CC_FULL_MASK
+#undef V
+#undef V_LOAD
+#undef V_STORE
+#undef V_SET1
+#undef V_ZERO
+#undef V_ADD
+#undef V_SUB
+#undef V_AND
+#undef V_OR
+#undef V_ANDNOT
+#undef V_CMPEQ
+#undef V_CMPLT
+#undef V_MOVEMASK
+#undef V_HSUM
+
+// Returns 1 when the CPU and the OS both support AVX2 (YMM state enabled)
+static inline int cc_cpu_has_avx2(void) {
+#if defined(_MSC_VER)
+    int regs[4];
+    __cpuid(regs, 0);
+    if (regs[0] < 7) { return 0; }
+    __cpuid(regs, 1);
+    int osxsave = (regs[2] >> 27) & 1;
+    int avx = (regs[2] >> 28) & 1;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) { return 0; }
+    __cpuidex(regs, 7, 0);
+    return (regs[1] >> 5) & 1;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // CC_HAVE_X86_64
+
+// Active table; starts scalar so the kernels work before cc_select runs
+static const CharClassOps* cc_ops = &cc_ops_scalar;
+
+// Pick the widest instruction set the CPU supports, optionally capped by
+// `requested` ("scalar", "sse2" or "avx2"). Returns the chosen name.
+static inline const char* cc_select(const char* requested) {
+    const CharClassOps* ops = &cc_ops_scalar;
+#ifdef CC_HAVE_X86_64
+    if (!requested || strcmp(requested, "scalar") != 0) {
+        ops = &cc_ops_sse2;
+        if ((!requested || strcmp(requested, "sse2") != 0) && cc_cpu_has_avx2()) { ops = &cc_ops_avx2; }
+    }
+#endif
+    // A single store: kernels already running on other threads (e.g. while
+    // another interpreter imports the module) see the old table or the new
+    cc_ops = ops;
+    return ops->name;
+}
+
+#endif // FAST_STRINGCASE_CHARCLASS_H
@@ -0,0 +1,263 @@
+// Vectorized character-class primitives, instantiated once per instruction
+// set by charclass.h. Do not include directly.
+//
+// The includer defines:
+//   CC_SUFFIX          name suffix for the instantiated functions
+//   CC_TARGET          function attribute enabling the instruction set
+//   CC_WIDTH           bytes per vector
+//   CC_FULL_MASK       V_MOVEMASK result when every byte matches
+//   V                  vector type
+//   V_LOAD, V_STORE, V_SET1, V_ZERO, V_ADD, V_SUB, V_AND, V_OR, V_ANDNOT,
+//   V_CMPEQ, V_CMPLT (signed), V_MOVEMASK, V_HSUM (sum of all bytes)
+//
+// Every function processes whole vectors and finishes, or stops, with the
+// scalar code from charclass.h so results are identical on every path.
+
+#define CC_JOIN2(a, b) a##_##b
+#define CC_JOIN(a, b) CC_JOIN2(a, b)
+#define CC_FN(name) CC_JOIN(name, CC_SUFFIX)
+
+// Byte mask of x in [lo, hi], using one add and one signed compare
+#define CC_RANGE(x, lo, hi) \
+    V_CMPLT(V_ADD((x), V_SET1((char)(0x80 - (lo)))), V_SET1((char)(0x80 + (hi) - (lo) + 1)))
+#define CC_UPPER(x) CC_RANGE(x, 'A', 'Z')
+#define CC_LOWER(x) CC_RANGE(x, 'a', 'z')
+#define CC_ALNUM(x) V_OR(V_OR(CC_UPPER(x), CC_LOWER(x)), CC_RANGE(x, '0', '9'))
+#define CC_SEPARATOR(x) \
+    V_OR(V_OR(V_CMPEQ((x), V_SET1('-')), V_CMPEQ((x), V_SET1('.'))), \
+         V_OR(V_CMPEQ((x), V_SET1(' ')), V_CMPEQ((x), V_SET1('_'))))
+// mask ? a : b
+#define CC_SELECT(mask, a, b) V_OR(V_AND((mask), (a)), V_ANDNOT((mask), (b)))
+// Clear or set bit 0x20 on the bytes selected by mask
+#define CC_TO_LOWER(x, mask) V_ADD((x), V_AND((mask), V_SET1(0x20)))
+#define CC_TO_UPPER(x, mask) V_SUB((x), V_AND((mask), V_SET1(0x20)))
+
+static CC_TARGET void CC_FN(cc_lower)(const char* in, fsc_ssize_t len, char* out) {
+    fsc_ssize_t i = 0;
+    for (; len - i >= CC_WIDTH; i += CC_WIDTH) {
+        V x = V_LOAD(in + i);
+        V_STORE(out + i, CC_TO_LOWER(x, CC_UPPER(x)));
+    }
+    cc_lower_scalar(in + i, len - i, out + i);
+}
+
+static CC_TARGET void CC_FN(cc_upper)(const char* in, fsc_ssize_t len, char* out) {
+    fsc_ssize_t i = 0;
+    for (; len - i >= CC_WIDTH; i += CC_WIDTH) {
+        V x = V_LOAD(in + i);
+        V_STORE(out + i, CC_TO_UPPER(x, CC_LOWER(x)));
+    }
+    cc_upper_scalar(in + i, len - i, out + i);
+}
+
+// Byte counters are flushed every 255 vectors so no lane can overflow
+static CC_TARGET fsc_ssize_t CC_FN(cc_count_upper)(const char* in, fsc_ssize_t len) {
+    fsc_ssize_t i = 0, total = 0;
+    while (len - i >= CC_WIDTH) {
+        V acc = V_ZERO;
+        for (int blocks = 0; blocks < 255 && len - i >= CC_WIDTH; ++blocks, i += CC_WIDTH) {
+            acc = V_SUB(acc, CC_UPPER(V_LOAD(in + i)));
+        }
+        total += V_HSUM(acc);
+    }
+    return total + cc_count_upper_scalar(in + i, len - i);
+}
+
+static CC_TARGET fsc_ssize_t CC_FN(cc_count_alnum)(const char* in, fsc_ssize_t len) {
+    fsc_ssize_t i = 0, total = 0;
+    while (len - i >= CC_WIDTH) {
+        V acc = V_ZERO;
+        for (int blocks = 0; blocks < 255 && len - i >= CC_WIDTH; ++blocks, i += CC_WIDTH) {
+            acc = V_SUB(acc, CC_ALNUM(V_LOAD(in + i)));
+        }
+        total += V_HSUM(acc);
+    }
+    return total + cc_count_alnum_scalar(in + i, len - i);
+}
+
+// Counts the bytes sentencecase emits for in[0, len); in[-1] must be readable.
+// A separator emits a space unless it follows another separator, and an
+// uppercase letter emits an extra space unless it follows a separator.
+static CC_TARGET fsc_ssize_t CC_FN(cc_count_sentence)(const char* in, fsc_ssize_t len) {
+    fsc_ssize_t i = 0, total = len;
+    while (len - i >= CC_WIDTH) {
+        V added = V_ZERO, removed = V_ZERO;
+        for (int blocks = 0; blocks < 255 && len - i >= CC_WIDTH; ++blocks, i += CC_WIDTH) {
+            V x = V_LOAD(in + i);
+            V prev_separator = CC_SEPARATOR(V_LOAD(in + i - 1));
+            added = V_SUB(added, V_ANDNOT(prev_separator, CC_UPPER(x)));
+            removed = V_SUB(removed, V_AND(prev_separator, CC_SEPARATOR(x)));
+        }
+        total += V_HSUM(added) - V_HSUM(removed);
+    }
+    return total - (len - i) + cc_count_sentence_scalar(in + i, len - i);
+}
+
+// Length of the leading run of alphanumeric bytes
+static CC_TARGET fsc_ssize_t CC_FN(cc_span_alnum)(const char* in, fsc_ssize_t len) {
+    fsc_ssize_t i = 0;
+    for (; len - i >= CC_WIDTH; i += CC_WIDTH) {
+        unsigned int mask = (unsigned int)V_MOVEMASK(CC_ALNUM(V_LOAD(in + i)));
+        if (mask != CC_FULL_MASK) {
+            return i + cc_ctz(~mask);
+        }
+    }
+    return i + cc_span_alnum_scalar(in + i, len - i);
+}
+
+// Length of the leading run of bytes in none of `classes`
+static CC_TARGET fsc_ssize_t CC_FN(cc_span_without)(const char* in, fsc_ssize_t len, unsigned int classes) {
+    fsc_ssize_t i = 0;
+    for (; len - i >= CC_WIDTH; i += CC_WIDTH) {
+        V x = V_LOAD(in + i);
+        V hits = V_ZERO;
+        if (classes & CC_CLASS_UPPER) { hits = V_OR(hits, CC_UPPER(x)); }
+        if (classes & CC_CLASS_LOWER) { hits = V_OR(hits, CC_LOWER(x)); }
+        if (classes & CC_CLASS_NON_ALNUM) { hits = V_OR(hits, V_ANDNOT(CC_ALNUM(x), V_SET1(0xFF))); }
+        if (classes & CC_CLASS_DASH) { hits = V_OR(hits, V_CMPEQ(x, V_SET1('-'))); }
+        if (classes & CC_CLASS_DOT) { hits = V_OR(hits, V_CMPEQ(x, V_SET1('.'))); }
+        if (classes & CC_CLASS_SPACE) { hits = V_OR(hits, V_CMPEQ(x, V_SET1(' '))); }
+        if (classes & CC_CLASS_UNDERSCORE) { hits = V_OR(hits, V_CMPEQ(x, V_SET1('_'))); }
+        unsigned int mask = (unsigned int)V_MOVEMASK(hits);
+        if (mask) {
+            return i + cc_ctz(mask);
+        }
+    }
+    return i + cc_span_without_scalar(in + i, len - i, classes);
+}
+
+// Union of the classes of every byte, as cc_classes_present_scalar; in[-1]
+// must be readable. Byte lanes collect each byte's class bit, which all fit
+// in 8 bits with CC_CLASS_NON_ALNUM's bit standing for CC_CLASS_OTHER, and
+// a second set collects the word positions of letters.
+static CC_TARGET unsigned int CC_FN(cc_classes_present)(const char* in, fsc_ssize_t len) {
+    fsc_ssize_t i = 0;
+    V bits = V_ZERO, positions = V_ZERO;
+    for (; len - i >= CC_WIDTH; i += CC_WIDTH) {
+        V x = V_LOAD(in + i);
+        V upper = CC_UPPER(x), lower = CC_LOWER(x);
+        V dash = V_CMPEQ(x, V_SET1('-')), dot = V_CMPEQ(x, V_SET1('.'));
+        V space = V_CMPEQ(x, V_SET1(' ')), underscore = V_CMPEQ(x, V_SET1('_'));
+        V slash = V_CMPEQ(x, V_SET1('/'));
+        V known = V_OR(V_OR(V_OR(upper, lower), V_OR(CC_RANGE(x, '0', '9'), slash)),
+                       V_OR(V_OR(dash, dot), V_OR(space, underscore)));
+        bits = V_OR(bits, V_OR(V_OR(V_AND(upper, V_SET1(CC_CLASS_UPPER)), V_AND(lower, V_SET1(CC_CLASS_LOWER))),
+                               V_ANDNOT(known, V_SET1(CC_CLASS_NON_ALNUM))));
+        bits = V_OR(bits, V_OR(V_OR(V_AND(dash, V_SET1(CC_CLASS_DASH)), V_AND(dot, V_SET1(CC_CLASS_DOT))),
+                               V_OR(V_AND(space, V_SET1(CC_CLASS_SPACE)),
+                                    V_OR(V_AND(underscore, V_SET1(CC_CLASS_UNDERSCORE)),
+                                         V_AND(slash, V_SET1((char)CC_CLASS_SLASH))))));
+        V word_start = CC_SEPARATOR(V_LOAD(in + i - 1));
+        positions = V_OR(positions, V_OR(V_AND(V_AND(upper, word_start), V_SET1(1)),
+                                         V_OR(V_AND(V_ANDNOT(word_start, upper), V_SET1(2)),
+                                              V_AND(V_AND(lower, word_start), V_SET1(4)))));
+    }
+    unsigned char lanes[2 * CC_WIDTH];
+    V_STORE(lanes, bits);
+    V_STORE(lanes + CC_WIDTH, positions);
+    unsigned int bit_union = 0, position_union = 0;
+    for (int lane = 0; lane < CC_WIDTH; ++lane) {
+        bit_union |= lanes[lane];
+        position_union |= lanes[CC_WIDTH + lane];
+    }
+    unsigned int classes = (bit_union & ~CC_CLASS_NON_ALNUM) | (bit_union & CC_CLASS_NON_ALNUM ? CC_CLASS_OTHER : 0)
+        | (position_union & 1 ? CC_CLASS_UPPER_INITIAL : 0) | (position_union & 2 ? CC_CLASS_UPPER_INNER : 0)
+        | (position_union & 4 ? CC_CLASS_LOWER_INITIAL : 0);
+    return classes | cc_classes_present_scalar(in + i, len - i);
+}
+
+// Copies the alphanumeric bytes of `in` to `out`, returning the count.
+// Like the scalar version, it may overwrite one byte past the result.
+static CC_TARGET fsc_ssize_t CC_FN(cc_compact_alnum)(const char* in, fsc_ssize_t len, char* out) {
+    fsc_ssize_t i = 0, written = 0;
+    for (; len - i >= CC_WIDTH; i += CC_WIDTH) {
+        V x = V_LOAD(in + i);
+        unsigned int mask = (unsigned int)V_MOVEMASK(CC_ALNUM(x));
+        if (mask == CC_FULL_MASK) {
+            V_STORE(out + written, x);
+            written += CC_WIDTH;
+            continue;
+        }
+        if (mask) {
+            written += cc_compact_alnum_scalar(in + i, CC_WIDTH, out + written);
+        }
+    }
+    return written + cc_compact_alnum_scalar(in + i, len - i, out + written);
+}
+
+// The *_run functions convert whole vectors for as long as no byte needs
+// more than a one-to-one rewrite, and return how many bytes they consumed.
+// The caller handles the rest with scalar code before trying again.
+
+// snakecase family after index 0: separators become the joiner and, for
+// constcase, letters are upper-cased. Stops at the first uppercase letter.
+static CC_TARGET fsc_ssize_t CC_FN(cc_snake_run)(const char* in, fsc_ssize_t len, char* out,
+                                                 char joiner, int upper) {
+    fsc_ssize_t i = 0;
+    for (; len - i >= CC_WIDTH; i += CC_WIDTH) {
+        V x = V_LOAD(in + i);
+        if (V_MOVEMASK(CC_UPPER(x))) { break; }
+        if (upper) { x = CC_TO_UPPER(x, CC_LOWER(x)); }
+        V_STORE(out + i, CC_SELECT(CC_SEPARATOR(x), V_SET1(joiner), x));
+    }
+    return i;
+}
+
+// titlecase after index 0; in[-1] must be readable. Separators become spaces
+// and the byte after a separator is upper-cased. Stops at uppercase letters.
+static CC_TARGET fsc_ssize_t CC_FN(cc_title_run)(const char* in, fsc_ssize_t len, char* out) {
+    fsc_ssize_t i = 0;
+    for (; len - i >= CC_WIDTH; i += CC_WIDTH) {
+        V x = V_LOAD(in + i);
+        if (V_MOVEMASK(CC_UPPER(x))) { break; }
+        V separator = CC_SEPARATOR(x);
+        V word_start = V_ANDNOT(separator, CC_SEPARATOR(V_LOAD(in + i - 1)));
+        V y = CC_TO_UPPER(x, V_AND(word_start, CC_LOWER(x)));
+        V_STORE(out + i, CC_SELECT(separator, V_SET1(' '), y));
+    }
+    return i;
+}
+
+// sentencecase after its first character; in[-1] must be readable.
+// Separators become spaces. Stops at uppercase letters and at separators
+// that follow another separator, since both change the output length.
+static CC_TARGET fsc_ssize_t CC_FN(cc_sentence_run)(const char* in, fsc_ssize_t len, char* out) {
+    fsc_ssize_t i = 0;
+    for (; len - i >= CC_WIDTH; i += CC_WIDTH) {
+        V x = V_LOAD(in + i);
+        V separator = CC_SEPARATOR(x);
+        V repeated = V_AND(separator, CC_SEPARATOR(V_LOAD(in + i - 1)));
+        if (V_MOVEMASK(V_OR(CC_UPPER(x), repeated))) { break; }
+        V_STORE(out + i, CC_SELECT(separator, V_SET1(' '), x));
+    }
+    return i;
+}
+
+static const CharClassOps CC_FN(cc_ops) = {
+    CC_STR(CC_SUFFIX),
+    CC_WIDTH,
+    CC_FN(cc_lower),
+    CC_FN(cc_upper),
+    CC_FN(cc_count_upper),
+    CC_FN(cc_count_alnum),
+    CC_FN(cc_count_sentence),
+    CC_FN(cc_span_alnum),
+    CC_FN(cc_span_without),
+    CC_FN(cc_classes_present),
+    CC_FN(cc_compact_alnum),
+    CC_FN(cc_snake_run),
+    CC_FN(cc_title_run),
+    CC_FN(cc_sentence_run),
+};
+
+#undef CC_JOIN2
+#undef CC_JOIN
+#undef CC_FN
+#undef CC_RANGE
+#undef CC_UPPER
+#undef CC_LOWER
+#undef CC_ALNUM
+#undef CC_SEPARATOR
+#undef CC_SELECT
+#undef CC_TO_LOWER
+#undef CC_TO_UPPER
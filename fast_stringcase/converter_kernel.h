@@ -0,0 +1,68 @@
+// The Converter word-splitting state machine, instantiated per input and
+// output width by fast_stringcase.c. Do not include directly.
+//
+// The includer defines:
+//   CV_IN       storage unit of the input (Py_UCS1, Py_UCS2 or Py_UCS4)
+//   CV_OUT      storage unit of the output (char for the ASCII path, else Py_UCS4)
+//   CV_SUFFIX   name suffix for the instantiated function
+//
+// Words are split at input separators, before an uppercase letter that
+// follows a non-uppercase character, and, with acronyms enabled, before the
+// last letter of an uppercase run that is followed by a lowercase letter
+// ("HTTPServer" is "HTTP" and "Server"). Runs of separators never produce
+// empty words. Each word is re-cased and the words are joined with the
+// joiner; "upper" words use the full uppercase mapping, so one character
+// may become up to UC_UPPER_MAX. `out` must have room for
+// len * (UC_UPPER_MAX + joiner_len) units, or len * (1 + joiner_len) when
+// no word is upper.
+
+#define CV_JOIN2(a, b) a##_##b
+#define CV_JOIN(a, b) CV_JOIN2(a, b)
+#define CV_FN(name) CV_JOIN(name, CV_SUFFIX)
+
+static Py_ssize_t CV_FN(cv_convert)(const ConverterObject* conv, const CV_IN* string, Py_ssize_t len, CV_OUT* out) {
+    Py_ssize_t result_idx = 0;
+    Py_ssize_t word_pos = 0; // Characters emitted for the current word; 0 between words
+    Py_ssize_t words = 0;
+    int prev_class = CV_SEPARATOR;
+
+    for (Py_ssize_t i = 0; i < len; ++i) {
+        Py_UCS4 current_char = string[i];
+        int current_class = cv_class(conv, current_char);
+        if (current_class == CV_SEPARATOR) {
+            word_pos = 0;
+            prev_class = current_class;
+            continue;
+        }
+        if (word_pos > 0 && current_class == CV_UPPER
+            && (!conv->acronyms || prev_class != CV_UPPER
+                || (i + 1 < len && cv_class(conv, string[i + 1]) == CV_LOWER))) {
+            word_pos = 0;
+        }
+        if (word_pos == 0) {
+            if (words > 0) {
+                for (Py_ssize_t j = 0; j < conv->joiner_len; ++j) {
+                    out[result_idx++] = (CV_OUT)conv->joiner[j];
+                }
+            }
+            words++;
+        }
+        int word_case = words == 1 ? conv->first_word_case : conv->word_case;
+        if (word_case == WORD_UPPER) {
+            uint32_t upper[UC_UPPER_MAX];
+            int count = uc_toupper_full(current_char, upper);
+            for (int j = 0; j < count; ++j) {
+                out[result_idx++] = (CV_OUT)upper[j];
+            }
+        } else {
+            out[result_idx++] = (CV_OUT)cv_recase(word_case, word_pos, current_char);
+        }
+        word_pos++;
+        prev_class = current_class;
+    }
+    return result_idx;
+}
+
+#undef CV_JOIN2
+#undef CV_JOIN
+#undef CV_FN
@@ -1,584 +1,4327 @@
 #include <Python.h>
+#include <structmember.h> // For PyMemberDef
 #include <string.h>
-#include <ctype.h>
 #include <stdlib.h> // For malloc, free
 
-// Forward declarations for functions that call each other
-static PyObject* snakecase(PyObject* self, PyObject* args);
-static PyObject* camelcase(PyObject* self, PyObject* args);
-static PyObject* capitalcase(PyObject* self, PyObject* args);
-static PyObject* lowercase(PyObject* self, PyObject* args);
-static PyObject* uppercase(PyObject* self, PyObject* args);
-static PyObject* trimcase(PyObject* self, PyObject* args);
-
-// Helper to get C string from Python Unicode object safely
-// Returns a newly allocated string that the caller must free, or NULL on error.
-static char* get_string_from_pyobject(PyObject* py_obj) {
-    if (!PyUnicode_Check(py_obj)) {
+#include "stringcase_core.h"
+#include "parallel.h"
+#include "mapped_file.h"
+#include "stats.h"
+#include "arrow_c_data.h"
+#define FAST_STRINGCASE_MODULE
+#include "fast_stringcase_capi.h"
+
+// --- Scratch Buffer ---
+
+// Growable byte buffer the kernels write into. A single buffer is reused
+// across every element of a *_many call so batches do not malloc per string.
+typedef struct {
+    char* data;
+    Py_ssize_t size;
+} ScratchBuffer;
+
+// Make sure the scratch buffer can hold at least `needed` bytes. Returns 0
+// on failure without touching Python state, so it also works without the GIL.
+static int scratch_grow(ScratchBuffer* scratch, Py_ssize_t needed) {
+    if (needed <= scratch->size) { return 1; }
+
+    Py_ssize_t new_size = scratch->size ? scratch->size : 64;
+    while (new_size < needed) { new_size = new_size > PY_SSIZE_T_MAX / 2 ? needed : new_size * 2; }
+
+    char* new_data = (char*)realloc(scratch->data, new_size);
+    if (!new_data) { return 0; }
+    scratch->data = new_data;
+    scratch->size = new_size;
+    return 1;
+}
+
+// scratch_grow that sets MemoryError on failure
+static int scratch_reserve(ScratchBuffer* scratch, Py_ssize_t needed, const char* func_name) {
+    if (!scratch_grow(scratch, needed)) {
+        PyErr_Format(PyExc_MemoryError, "Failed to allocate memory for %s", func_name);
+        return 0;
+    }
+    return 1;
+}
+
+static void scratch_free(ScratchBuffer* scratch) {
+    free(scratch->data);
+    scratch->data = NULL;
+    scratch->size = 0;
+}
+
+// --- Conversion Cache ---
+//
+// Optional per-case cache of recent conversions, for workloads that convert
+// the same few thousand names over and over. It is set-associative: a str's
+// hash picks a set of CACHE_WAYS entries, and a CLOCK hand evicts the first
+// entry that has not been hit since the hand last passed it. Entries hold
+// strong references to the input and result.
+
+#define CACHE_WAYS 4
+
+typedef struct {
+    PyObject* key;    // Exact str input, or NULL for an empty entry
+    PyObject* value;  // Converted result
+    Py_hash_t hash;
+    int referenced;   // Hit since the CLOCK hand last passed
+} CacheEntry;
+
+typedef struct {
+    CacheEntry ways[CACHE_WAYS];
+    unsigned int hand;
+} CacheSet;
+
+typedef struct {
+    CacheSet* sets;
+    Py_ssize_t nsets;  // 0 when the cache is disabled
+    int intern;        // Intern every result
+    Py_ssize_t hits;
+    Py_ssize_t misses;
+    Py_ssize_t size;   // Entries in use
+#ifdef Py_GIL_DISABLED
+    PyMutex mutex;     // Held while the entries are read or changed
+#endif
+} CaseCache;
+
+#ifdef Py_GIL_DISABLED
+#define CACHE_LOCK(cache) PyMutex_Lock(&(cache)->mutex)
+#define CACHE_UNLOCK(cache) PyMutex_Unlock(&(cache)->mutex)
+#else
+#define CACHE_LOCK(cache)
+#define CACHE_UNLOCK(cache)
+#endif
+
+// nsets and intern are written under the lock but also read without it, to
+// skip disabled caches; the locked paths re-check nsets.
+#ifdef Py_GIL_DISABLED
+#define CACHE_LOAD_SSIZE(field) _Py_atomic_load_ssize_relaxed(&(field))
+#define CACHE_STORE_SSIZE(field, value) _Py_atomic_store_ssize_relaxed(&(field), (value))
+#define CACHE_LOAD_INT(field) _Py_atomic_load_int_relaxed(&(field))
+#define CACHE_STORE_INT(field, value) _Py_atomic_store_int_relaxed(&(field), (value))
+#else
+#define CACHE_LOAD_SSIZE(field) (field)
+#define CACHE_STORE_SSIZE(field, value) ((field) = (value))
+#define CACHE_LOAD_INT(field) (field)
+#define CACHE_STORE_INT(field, value) ((field) = (value))
+#endif
+
+// --- Statistics ---
+//
+// Per-case counters read by stats(), recorded only while enable_stats(True)
+// is in effect (or FAST_STRINGCASE_STATS=1 at import). See stats.h.
+
+static CaseStats lowercase_stats, uppercase_stats, snakecase_stats, camelcase_stats,
+    capitalcase_stats, pascalcase_stats, constcase_stats, pathcase_stats, backslashcase_stats,
+    spinalcase_stats, dotcase_stats, titlecase_stats, trimcase_stats, alphanumcase_stats,
+    sentencecase_stats;
+
+// --- Case Specifications ---
+
+typedef fsc_ssize_t (*case_kernel)(const char* string, fsc_ssize_t len, char* out);
+typedef fsc_ssize_t (*case_measure)(const char* string, fsc_ssize_t len);
+typedef int (*case_normalized)(const char* string, fsc_ssize_t len);
+
+typedef struct {
+    const char* name;
+    case_measure measure;           // Exact output length of kernel
+    case_kernel kernel;
+    case_normalized is_normalized;  // 1 if kernel(string) == string
+    unicode_kernel unicode_kernels[3]; // Non-ASCII input, by PyUnicode kind
+    int index;                      // FAST_STRINGCASE_ case number: in case_specs and the module's caches
+    CaseStats* stats;
+} CaseSpec;
+
+static const CaseSpec lowercase_spec = {"lowercase", same_length_measure, lowercase_kernel, lowercase_normalized, UNICODE_KERNELS(lowercase), FAST_STRINGCASE_LOWERCASE, &lowercase_stats};
+static const CaseSpec uppercase_spec = {"uppercase", same_length_measure, uppercase_kernel, uppercase_normalized, UNICODE_KERNELS(uppercase), FAST_STRINGCASE_UPPERCASE, &uppercase_stats};
+static const CaseSpec snakecase_spec = {"snakecase", snake_measure, snakecase_kernel, snakecase_normalized, UNICODE_KERNELS(snakecase), FAST_STRINGCASE_SNAKECASE, &snakecase_stats};
+static const CaseSpec camelcase_spec = {"camelcase", alnum_measure, camelcase_kernel, camelcase_normalized, UNICODE_KERNELS(camelcase), FAST_STRINGCASE_CAMELCASE, &camelcase_stats};
+static const CaseSpec capitalcase_spec = {"capitalcase", same_length_measure, capitalcase_kernel, capitalcase_normalized, UNICODE_KERNELS(capitalcase), FAST_STRINGCASE_CAPITALCASE, &capitalcase_stats};
+static const CaseSpec pascalcase_spec = {"pascalcase", alnum_measure, pascalcase_kernel, pascalcase_normalized, UNICODE_KERNELS(pascalcase), FAST_STRINGCASE_PASCALCASE, &pascalcase_stats};
+static const CaseSpec constcase_spec = {"constcase", snake_measure, constcase_kernel, constcase_normalized, UNICODE_KERNELS(constcase), FAST_STRINGCASE_CONSTCASE, &constcase_stats};
+static const CaseSpec pathcase_spec = {"pathcase", snake_measure, pathcase_kernel, pathcase_normalized, UNICODE_KERNELS(pathcase), FAST_STRINGCASE_PATHCASE, &pathcase_stats};
+static const CaseSpec backslashcase_spec = {"backslashcase", snake_measure, backslashcase_kernel, backslashcase_normalized, UNICODE_KERNELS(backslashcase), FAST_STRINGCASE_BACKSLASHCASE, &backslashcase_stats};
+static const CaseSpec spinalcase_spec = {"spinalcase", snake_measure, spinalcase_kernel, spinalcase_normalized, UNICODE_KERNELS(spinalcase), FAST_STRINGCASE_SPINALCASE, &spinalcase_stats};
+static const CaseSpec dotcase_spec = {"dotcase", snake_measure, dotcase_kernel, dotcase_normalized, UNICODE_KERNELS(dotcase), FAST_STRINGCASE_DOTCASE, &dotcase_stats};
+static const CaseSpec titlecase_spec = {"titlecase", snake_measure, titlecase_kernel, titlecase_normalized, UNICODE_KERNELS(titlecase), FAST_STRINGCASE_TITLECASE, &titlecase_stats};
+static const CaseSpec trimcase_spec = {"trimcase", trim_measure, trimcase_kernel, trimcase_normalized, UNICODE_KERNELS(trimcase), FAST_STRINGCASE_TRIMCASE, &trimcase_stats};
+static const CaseSpec alphanumcase_spec = {"alphanumcase", alnum_measure, alphanumcase_kernel, alphanumcase_normalized, UNICODE_KERNELS(alphanumcase), FAST_STRINGCASE_ALPHANUMCASE, &alphanumcase_stats};
+static const CaseSpec sentencecase_spec = {"sentencecase", sentence_measure, sentencecase_kernel, sentencecase_normalized, UNICODE_KERNELS(sentencecase), FAST_STRINGCASE_SENTENCECASE, &sentencecase_stats};
+
+// In the order of CaseSpec.index
+static const CaseSpec* const case_specs[] = {
+    &lowercase_spec, &uppercase_spec, &snakecase_spec, &camelcase_spec, &capitalcase_spec,
+    &pascalcase_spec, &constcase_spec, &pathcase_spec, &backslashcase_spec, &spinalcase_spec,
+    &dotcase_spec, &titlecase_spec, &trimcase_spec, &alphanumcase_spec, &sentencecase_spec,
+};
+
+#define CASE_COUNT ((int)(sizeof(case_specs) / sizeof(case_specs[0])))
+
+// Fails to compile when a case is missing from fast_stringcase_capi.h
+typedef char case_count_matches_capi[CASE_COUNT == FAST_STRINGCASE_CASE_COUNT ? 1 : -1];
+
+// --- Module State ---
+//
+// Everything that holds Python objects lives in the module object (PEP
+// 489), so every interpreter that imports the module, including
+// subinterpreters with their own GIL, gets its own caches and types. The
+// kernels, the SIMD choice and the statistics counters hold no Python
+// objects and are shared by the whole process.
+
+typedef struct {
+    CaseCache caches[CASE_COUNT];      // By CaseSpec.index
+    PyObject* case_index;              // {name: index} for full and short names
+    PyObject* style_names[STYLE_COUNT]; // Interned detect_case() results, by STYLE_
+    PyObject* collections_abc;         // Mapping and views, for CaseNormalizedDict
+    PyTypeObject* arrow_string_array_type;
+    ParallelPool pool;                 // Helper threads for threads=N and convert_file
+} ModuleState;
+
+static inline ModuleState* get_module_state(PyObject* module) {
+    return (ModuleState*)PyModule_GetState(module);
+}
+
+// Free-threaded builds lock objects that other threads may change while
+// they are read; with the GIL these are plain blocks. 3.13 defines them for
+// both builds.
+#ifndef Py_BEGIN_CRITICAL_SECTION
+#define Py_BEGIN_CRITICAL_SECTION(op) {
+#define Py_END_CRITICAL_SECTION() }
+#endif
+
+
+// ASCII input is read in place and converted straight into a compact ASCII
+// result of the exact output length, so the only allocation is the result
+// object itself. Input that is already in the target case is returned as is.
+// Other input is read in its own PyUnicode kind by the matching Unicode
+// kernel, which writes code points into the scratch buffer.
+// Returns a new reference, or NULL with an exception set.
+static PyObject* convert_string(const CaseSpec* spec, PyObject* py_str, ScratchBuffer* scratch) {
+    if (!PyUnicode_Check(py_str)) {
         PyErr_SetString(PyExc_TypeError, "Expected a string object");
         return NULL;
     }
-    Py_ssize_t size;
-    const char* temp_str = PyUnicode_AsUTF8AndSize(py_obj, &size);
-    if (!temp_str) {
-        // Exception set by PyUnicode_AsUTF8AndSize
-        return NULL;
+    if (PyUnicode_READY(py_str) < 0) { return NULL; }
+
+    Py_ssize_t len = PyUnicode_GET_LENGTH(py_str);
+    if (PyUnicode_IS_ASCII(py_str)) {
+        const char* string = (const char*)PyUnicode_1BYTE_DATA(py_str);
+        if (PyUnicode_CheckExact(py_str) && spec->is_normalized(string, len)) {
+            if (stats_enabled) { stats_convert(spec->stats, 1, len, len, 0); }
+            Py_INCREF(py_str);
+            return py_str;
+        }
+        Py_ssize_t result_len = spec->measure(string, len);
+        PyObject* py_result = PyUnicode_New(result_len, 127);
+        if (!py_result) { return NULL; }
+        char* result_data = (char*)PyUnicode_1BYTE_DATA(py_result);
+        result_data[spec->kernel(string, len, result_data)] = '\0';
+        if (stats_enabled) { stats_convert(spec->stats, 1, len, result_len, 1); }
+        return py_result;
     }
-    // Allocate memory and copy the string
-    char* c_str = (char*)malloc(size + 1);
-    if (!c_str) {
-        PyErr_SetString(PyExc_MemoryError, "Failed to allocate memory for string copy");
-        return NULL;
+
+    if (len > (PY_SSIZE_T_MAX / (Py_ssize_t)sizeof(Py_UCS4)) / UK_MAX_OUT) { return PyErr_NoMemory(); }
+    Py_ssize_t scratch_size = scratch->size;
+    if (!scratch_reserve(scratch, UK_MAX_OUT * len * (Py_ssize_t)sizeof(Py_UCS4), spec->name)) { return NULL; }
+
+    Py_UCS4* out = (Py_UCS4*)scratch->data;
+    unicode_kernel kernel = spec->unicode_kernels[PyUnicode_KIND(py_str) >> 1];
+    Py_ssize_t result_len = kernel(PyUnicode_DATA(py_str), len, out);
+    PyObject* py_result = PyUnicode_FromKindAndData(PyUnicode_4BYTE_KIND, out, result_len);
+    if (py_result && stats_enabled) {
+        // Sizes are of the str storage: code points times their width
+        stats_convert(spec->stats, 1, len * PyUnicode_KIND(py_str),
+                      PyUnicode_GET_LENGTH(py_result) * PyUnicode_KIND(py_result),
+                      1 + (scratch->size != scratch_size));
     }
-    memcpy(c_str, temp_str, size + 1); // Copy null terminator too
-    return c_str;
+    return py_result;
 }
 
-// --- Function Implementations based on stringcase_base.py ---
+// Returns 1 when two exact str objects with equal hashes hold the same text.
+// Equal strings always share a kind, so their storage can be compared as is.
+static inline int cache_key_equal(PyObject* a, PyObject* b) {
+    Py_ssize_t len = PyUnicode_GET_LENGTH(a);
+    return len == PyUnicode_GET_LENGTH(b) && PyUnicode_KIND(a) == PyUnicode_KIND(b)
+        && memcmp(PyUnicode_DATA(a), PyUnicode_DATA(b), len * PyUnicode_KIND(a)) == 0;
+}
 
-// Equivalent to Python's lowercase(string)
-static PyObject* lowercase(PyObject* self, PyObject* args) {
-    const char* string;
-    if (!PyArg_ParseTuple(args, "s", &string)) { return NULL; }
+// Callers hold the cache's lock
+static void cache_clear_entries(CaseCache* cache) {
+    for (Py_ssize_t i = 0; i < cache->nsets; ++i) {
+        for (int way = 0; way < CACHE_WAYS; ++way) {
+            CacheEntry* entry = &cache->sets[i].ways[way];
+            Py_CLEAR(entry->key);
+            Py_CLEAR(entry->value);
+        }
+        cache->sets[i].hand = 0;
+    }
+    cache->size = 0;
+    cache->hits = 0;
+    cache->misses = 0;
+}
 
-    Py_ssize_t input_len = strlen(string);
-    char* result_str = (char*)malloc(input_len + 1);
-    if (!result_str) {
-        PyErr_SetString(PyExc_MemoryError, "Failed to allocate memory for lowercase");
-        return NULL;
+// Resize the cache to hold up to maxsize entries (rounded up to a whole
+// number of sets), dropping everything it held. 0 disables it.
+static int cache_resize(CaseCache* cache, Py_ssize_t maxsize, int intern) {
+    Py_ssize_t nsets = (maxsize + CACHE_WAYS - 1) / CACHE_WAYS;
+    CacheSet* sets = NULL;
+    if (nsets && !(sets = PyMem_Calloc(nsets, sizeof(CacheSet)))) {
+        PyErr_NoMemory();
+        return -1;
     }
+    CACHE_LOCK(cache);
+    cache_clear_entries(cache);
+    PyMem_Free(cache->sets);
+    cache->sets = sets;
+    CACHE_STORE_SSIZE(cache->nsets, nsets);
+    CACHE_STORE_INT(cache->intern, intern);
+    CACHE_UNLOCK(cache);
+    return 0;
+}
 
-    for (Py_ssize_t i = 0; i < input_len; i++) {
-        result_str[i] = tolower((unsigned char)string[i]);
+// Look py_str up in its set. Returns a new reference to the cached result,
+// or NULL (with no exception set) on a miss.
+static PyObject* cache_lookup(const CaseSpec* spec, CaseCache* cache, PyObject* py_str, Py_hash_t hash) {
+    PyObject* py_result = NULL;
+    CACHE_LOCK(cache);
+    if (cache->nsets) {
+        CacheSet* set = &cache->sets[(size_t)hash % (size_t)cache->nsets];
+        for (int way = 0; way < CACHE_WAYS; ++way) {
+            CacheEntry* entry = &set->ways[way];
+            if (entry->key == py_str || (entry->key && entry->hash == hash && cache_key_equal(entry->key, py_str))) {
+                entry->referenced = 1;
+                py_result = entry->value;
+                Py_INCREF(py_result);
+                break;
+            }
+        }
+        if (py_result) {
+            cache->hits++;
+        } else {
+            cache->misses++;
+        }
     }
-    result_str[input_len] = '\0';
+    CACHE_UNLOCK(cache);
+    if (py_result && stats_enabled) { stats_add(&spec->stats->cache_hits, 1); }
+    return py_result;
+}
 
-    PyObject* py_result = PyUnicode_FromString(result_str);
-    free(result_str);
-    return py_result; // PyUnicode_FromString sets error on failure
+// Store a new result, evicting with the CLOCK policy within its set
+static void cache_insert(CaseCache* cache, PyObject* py_str, Py_hash_t hash, PyObject* py_result) {
+    CACHE_LOCK(cache);
+    // The cache may have been resized or disabled while the result was built
+    if (cache->nsets) {
+        CacheSet* set = &cache->sets[(size_t)hash % (size_t)cache->nsets];
+        // Advance the CLOCK hand past recently hit entries
+        CacheEntry* victim;
+        for (;;) {
+            victim = &set->ways[set->hand];
+            set->hand = (set->hand + 1) % CACHE_WAYS;
+            if (!victim->key || !victim->referenced) { break; }
+            victim->referenced = 0;
+        }
+        if (victim->key) {
+            cache->size--;
+        }
+        // Clearing can free the old strings, but str deallocation runs no Python code
+        Py_INCREF(py_str);
+        Py_INCREF(py_result);
+        Py_XSETREF(victim->key, py_str);
+        Py_XSETREF(victim->value, py_result);
+        victim->hash = hash;
+        victim->referenced = 0;
+        cache->size++;
+    }
+    CACHE_UNLOCK(cache);
 }
 
-// Equivalent to Python's uppercase(string)
-static PyObject* uppercase(PyObject* self, PyObject* args) {
-    const char* string;
-    if (!PyArg_ParseTuple(args, "s", &string)) { return NULL; }
+// convert_string behind a module cache, when one is given and configured.
+// Only exact str inputs are cached, since subclasses can redefine equality.
+// The result is built outside the cache's lock, so threads converting
+// different strings never wait on one another.
+static PyObject* convert_cached(const CaseSpec* spec, CaseCache* cache, PyObject* py_str, ScratchBuffer* scratch) {
+    if (!cache || !PyUnicode_CheckExact(py_str)) { return convert_string(spec, py_str, scratch); }
+    int cached = CACHE_LOAD_SSIZE(cache->nsets) != 0;
+    int intern = CACHE_LOAD_INT(cache->intern);
+    if (!cached && !intern) { return convert_string(spec, py_str, scratch); }
 
-    Py_ssize_t input_len = strlen(string);
-    char* result_str = (char*)malloc(input_len + 1);
-    if (!result_str) {
-        PyErr_SetString(PyExc_MemoryError, "Failed to allocate memory for uppercase");
-        return NULL;
+    Py_hash_t hash = 0;
+    if (cached) {
+        hash = PyObject_Hash(py_str);
+        if (hash == -1) { return NULL; }
+        PyObject* py_result = cache_lookup(spec, cache, py_str, hash);
+        if (py_result) { return py_result; }
     }
 
-    for (Py_ssize_t i = 0; i < input_len; i++) {
-        result_str[i] = toupper((unsigned char)string[i]);
+    PyObject* py_result = convert_string(spec, py_str, scratch);
+    if (!py_result) { return NULL; }
+    if (intern && PyUnicode_CheckExact(py_result)) {
+        PyUnicode_InternInPlace(&py_result);
     }
-    result_str[input_len] = '\0';
-
-    PyObject* py_result = PyUnicode_FromString(result_str);
-    free(result_str);
-    return py_result; // PyUnicode_FromString sets error on failure
+    if (cached) { cache_insert(cache, py_str, hash, py_result); }
+    return py_result;
 }
 
-// Equivalent to Python's snakecase(string)
-// string = re.sub(r"[\-\.\s]", '_', str(string))
-// return lowercase(string[0]) + re.sub(r"[A-Z]", lambda matched: '_' + lowercase(matched.group(0)), string[1:])
-static PyObject* snakecase(PyObject* self, PyObject* args) {
-    const char* string;
-    if (!PyArg_ParseTuple(args, "s", &string)) { return NULL; }
+// Single-string entry point shared by every case function.
+static PyObject* convert_one(const CaseSpec* spec, CaseCache* cache, PyObject* py_str) {
+    ScratchBuffer scratch = {NULL, 0};
+    PyObject* py_result = convert_cached(spec, cache, py_str, &scratch);
+    scratch_free(&scratch);
+    return py_result;
+}
 
-    Py_ssize_t input_len = strlen(string);
-    if (input_len == 0) { return PyUnicode_FromString(""); }
+// Batch entry point shared by every *_many function.
+// Exact lists and tuples get a pre-sized result list; any other iterable is
+// consumed through the iterator protocol. One scratch buffer serves all items.
+static PyObject* convert_many(const CaseSpec* spec, CaseCache* cache, PyObject* items) {
+    ScratchBuffer scratch = {NULL, 0};
+    PyObject* result_list = NULL;
 
-    // Allocate for intermediate and final strings
-    char* temp_str = (char*)malloc(input_len + 1); // Max length for temp_str is input_len
-    char* result_str = (char*)malloc(input_len * 2 + 1); // Max length for result_str is input_len * 2
+    if (PyList_CheckExact(items) || PyTuple_CheckExact(items)) {
+        // No Python code runs in this loop, so only another thread (on a
+        // free-threaded build) could change the list; the critical section
+        // stops that
+        Py_BEGIN_CRITICAL_SECTION(items);
+        Py_ssize_t count = PySequence_Fast_GET_SIZE(items);
+        result_list = PyList_New(count);
+        for (Py_ssize_t i = 0; result_list && i < count; ++i) {
+            PyObject* converted = convert_cached(spec, cache, PySequence_Fast_GET_ITEM(items, i), &scratch);
+            if (!converted) {
+                Py_CLEAR(result_list);
+                break;
+            }
+            PyList_SET_ITEM(result_list, i, converted);
+        }
+        Py_END_CRITICAL_SECTION();
+        scratch_free(&scratch);
+        return result_list;
+    }
 
-    if (!temp_str || !result_str) {
-        free(temp_str); free(result_str);
-        PyErr_SetString(PyExc_MemoryError, "Failed to allocate memory for snakecase");
+    PyObject* iterator = PyObject_GetIter(items);
+    if (!iterator) { return NULL; }
+    result_list = PyList_New(0);
+    if (!result_list) {
+        Py_DECREF(iterator);
         return NULL;
     }
 
-    // Pass 1: Replace separators '-', '.', ' ' with '_'
-    Py_ssize_t temp_idx = 0;
-    for (Py_ssize_t i = 0; i < input_len; ++i) {
-        char current_char = string[i];
-        if (current_char == '-' || current_char == '.' || current_char == ' ') {
-            temp_str[temp_idx++] = '_';
-        } else {
-            temp_str[temp_idx++] = current_char; // Keep others including existing '_'
+    PyObject* item;
+    while ((item = PyIter_Next(iterator)) != NULL) {
+        PyObject* converted = convert_cached(spec, cache, item, &scratch);
+        Py_DECREF(item);
+        if (!converted || PyList_Append(result_list, converted) < 0) {
+            Py_XDECREF(converted);
+            goto error;
         }
+        Py_DECREF(converted);
     }
-    temp_str[temp_idx] = '\0';
+    if (PyErr_Occurred()) { goto error; } // Raised by the iterator
 
-    // Pass 2: Handle case and prepend underscores for uppercase letters after index 0
-    Py_ssize_t result_idx = 0;
-    if (temp_idx > 0) {
-        result_str[result_idx++] = tolower((unsigned char)temp_str[0]); // Lowercase first char
-        for (Py_ssize_t i = 1; i < temp_idx; ++i) {
-            char current_char = temp_str[i];
-            if (isupper(current_char)) {
-                result_str[result_idx++] = '_';
-                result_str[result_idx++] = tolower((unsigned char)current_char);
-            } else {
-                result_str[result_idx++] = current_char;
-            }
+    Py_DECREF(iterator);
+    scratch_free(&scratch);
+    return result_list;
+
+error:
+    Py_DECREF(iterator);
+    Py_DECREF(result_list);
+    scratch_free(&scratch);
+    return NULL;
+}
+
+// --- Parallel Batches ---
+//
+// *_many(items, threads=N) splits large batches across native threads.
+// Python objects can only be created under the GIL, so a batch runs in
+// three phases:
+//   1. without the GIL, measure every ASCII input (or find it already
+//      normalized);
+//   2. with the GIL, allocate each result at its exact length and convert
+//      the non-ASCII inputs, which are the minority, serially;
+//   3. without the GIL, run the kernels straight into the new objects.
+// The input is snapshotted into a tuple first, so no other thread can free
+// the strings while the GIL is released. The conversion cache is bypassed.
+
+// Batches below this many items are converted on the calling thread only
+#define PARALLEL_MIN_BATCH 8192
+// Items handed to a worker at a time
+#define PARALLEL_CHUNK 1024
+
+#define PARALLEL_NORMALIZED (-1) // Input is returned as is
+#define PARALLEL_SERIAL (-2)     // Converted under the GIL in phase 2
+
+typedef struct {
+    const CaseSpec* spec;
+    PyObject* const* items;
+    Py_ssize_t* lengths;   // Result length, or one of the PARALLEL_ markers
+    PyObject* const* results;
+} ParallelBatch;
+
+static void parallel_measure(void* arg, Py_ssize_t start, Py_ssize_t end) {
+    ParallelBatch* batch = (ParallelBatch*)arg;
+    for (Py_ssize_t i = start; i < end; ++i) {
+        PyObject* item = batch->items[i];
+        if (!PyUnicode_IS_ASCII(item)) {
+            batch->lengths[i] = PARALLEL_SERIAL;
+            continue;
         }
+        const char* string = (const char*)PyUnicode_1BYTE_DATA(item);
+        Py_ssize_t len = PyUnicode_GET_LENGTH(item);
+        batch->lengths[i] = PyUnicode_CheckExact(item) && batch->spec->is_normalized(string, len)
+                            ? PARALLEL_NORMALIZED : batch->spec->measure(string, len);
     }
-    result_str[result_idx] = '\0';
-
-    free(temp_str);
-    PyObject* py_result = PyUnicode_FromString(result_str);
-    free(result_str);
-    return py_result; // PyUnicode_FromString sets error on failure
 }
 
-// Equivalent to Python's camelcase(string)
-// string = re.sub(r"\w[\s\W]+\w", '', str(string)) # Skipping this complex regex part
-// return lowercase(string[0]) + re.sub(r"[\-_\.\s]([a-z])", lambda matched: uppercase(matched.group(1)), string[1:])
-static PyObject* camelcase(PyObject* self, PyObject* args) {
-    const char* string;
-    if (!PyArg_ParseTuple(args, "s", &string)) { return NULL; }
+static void parallel_convert(void* arg, Py_ssize_t start, Py_ssize_t end) {
+    ParallelBatch* batch = (ParallelBatch*)arg;
+    for (Py_ssize_t i = start; i < end; ++i) {
+        if (batch->lengths[i] < 0) { continue; }
+        PyObject* item = batch->items[i];
+        char* result_data = (char*)PyUnicode_1BYTE_DATA(batch->results[i]);
+        const char* string = (const char*)PyUnicode_1BYTE_DATA(item);
+        result_data[batch->spec->kernel(string, PyUnicode_GET_LENGTH(item), result_data)] = '\0';
+    }
+}
 
-    Py_ssize_t input_len = strlen(string);
-    if (input_len == 0) { return PyUnicode_FromString(""); }
+static PyObject* convert_many_parallel(const CaseSpec* spec, ParallelPool* pool, PyObject* items, int threads) {
+    PyObject* snapshot = PySequence_Tuple(items);
+    if (!snapshot) { return NULL; }
+    Py_ssize_t count = PyTuple_GET_SIZE(snapshot);
+    if (count < PARALLEL_MIN_BATCH) {
+        PyObject* result_list = convert_many(spec, NULL, snapshot);
+        Py_DECREF(snapshot);
+        return result_list;
+    }
 
-    // Allocate memory. Max length is the same as input.
-    char* result_str = (char*)malloc(input_len + 1);
-    if (!result_str) {
-        PyErr_SetString(PyExc_MemoryError, "Failed to allocate memory for camelcase");
-        return NULL;
+    PyObject* const* item_array = PySequence_Fast_ITEMS(snapshot);
+    for (Py_ssize_t i = 0; i < count; ++i) {
+        if (!PyUnicode_Check(item_array[i])) {
+            PyErr_SetString(PyExc_TypeError, "Expected a string object");
+            Py_DECREF(snapshot);
+            return NULL;
+        }
+        if (PyUnicode_READY(item_array[i]) < 0) {
+            Py_DECREF(snapshot);
+            return NULL;
+        }
     }
 
-    Py_ssize_t result_idx = 0;
-    int capitalize_next = 0; // Flag to capitalize the next *alphanumeric* character
+    ScratchBuffer scratch = {NULL, 0};
+    ParallelBatch batch = {spec, item_array, NULL, NULL};
+    Py_ssize_t* lengths = PyMem_New(Py_ssize_t, count);
+    PyObject* result_list = lengths ? PyList_New(count) : PyErr_NoMemory();
+    if (!result_list) { goto done; }
+    batch.lengths = lengths;
+    // Filled in phase 2 and read by phase 3
+    batch.results = PySequence_Fast_ITEMS(result_list);
 
-    // Process the string character by character
-    for (Py_ssize_t i = 0; i < input_len; ++i) {
-        char current_char = string[i];
+    Py_BEGIN_ALLOW_THREADS
+    parallel_for(pool, count, PARALLEL_CHUNK, threads, parallel_measure, &batch);
+    Py_END_ALLOW_THREADS
 
-        if (current_char == '-' || current_char == '_' || current_char == '.' || current_char == ' ') {
-            capitalize_next = 1; // Mark next alphanumeric to be capitalized
-        } else if (isalnum(current_char)) {
-            if (result_idx == 0) { // First character of the result string
-                result_str[result_idx++] = tolower((unsigned char)current_char);
-            } else if (capitalize_next) {
-                result_str[result_idx++] = toupper((unsigned char)current_char);
-                capitalize_next = 0; // Reset flag
+    // Totals for the ASCII items; convert_string counts the others
+    int64_t ascii_count = 0, ascii_input = 0, ascii_output = 0, ascii_allocations = 0;
+    for (Py_ssize_t i = 0; i < count; ++i) {
+        PyObject* item = item_array[i];
+        PyObject* converted;
+        if (lengths[i] == PARALLEL_SERIAL) {
+            converted = convert_string(spec, item, &scratch);
+        } else {
+            ascii_count++;
+            ascii_input += PyUnicode_GET_LENGTH(item);
+            if (lengths[i] == PARALLEL_NORMALIZED) {
+                Py_INCREF(item);
+                converted = item;
+                ascii_output += PyUnicode_GET_LENGTH(item);
             } else {
-                // Preserve existing case if not after separator
-                result_str[result_idx++] = current_char;
+                converted = PyUnicode_New(lengths[i], 127);
+                ascii_output += lengths[i];
+                ascii_allocations++;
             }
         }
-        // Ignore other characters
+        if (!converted) {
+            Py_CLEAR(result_list);
+            goto done;
+        }
+        PyList_SET_ITEM(result_list, i, converted);
     }
-    result_str[result_idx] = '\0';
-
-    PyObject* py_result = PyUnicode_FromString(result_str);
-    free(result_str);
-    return py_result; // PyUnicode_FromString sets error on failure
-}
+    if (stats_enabled) { stats_convert(spec->stats, ascii_count, ascii_input, ascii_output, ascii_allocations); }
 
-// Equivalent to Python's capitalcase(string)
-// return uppercase(string[0]) + string[1:]
-static PyObject* capitalcase(PyObject* self, PyObject* args) {
-    const char* string;
-    if (!PyArg_ParseTuple(args, "s", &string)) { return NULL; }
+    Py_BEGIN_ALLOW_THREADS
+    parallel_for(pool, count, PARALLEL_CHUNK, threads, parallel_convert, &batch);
+    Py_END_ALLOW_THREADS
 
-    Py_ssize_t input_len = strlen(string);
-    if (input_len == 0) { return PyUnicode_FromString(""); }
+done:
+    PyMem_Free(lengths);
+    scratch_free(&scratch);
+    Py_DECREF(snapshot);
+    return result_list;
+}
 
-    char* result_str = (char*)malloc(input_len + 1);
-    if (!result_str) {
-        PyErr_SetString(PyExc_MemoryError, "Failed to allocate memory for capitalcase");
+// Argument parsing for *_many(items, threads=None), shared by every case
+static PyObject* convert_many_entry(const CaseSpec* spec, ModuleState* state, PyObject* const* args, Py_ssize_t nargs,
+                                    PyObject* kwnames) {
+    Py_ssize_t nkwargs = kwnames ? PyTuple_GET_SIZE(kwnames) : 0;
+    if (nargs < 1 || nargs + nkwargs > 2) {
+        PyErr_Format(PyExc_TypeError, "%s_many() takes an iterable and an optional threads argument", spec->name);
         return NULL;
     }
+    PyObject* py_threads = nargs > 1 ? args[1] : NULL;
+    for (Py_ssize_t i = 0; i < nkwargs; ++i) {
+        PyObject* kwname = PyTuple_GET_ITEM(kwnames, i);
+        if (py_threads || !PyUnicode_Check(kwname) || PyUnicode_CompareWithASCIIString(kwname, "threads") != 0) {
+            PyErr_Format(PyExc_TypeError, "%s_many() got an unexpected keyword argument '%S'", spec->name, kwname);
+            return NULL;
+        }
+        py_threads = args[nargs + i];
+    }
 
-    result_str[0] = toupper((unsigned char)string[0]);
-    if (input_len > 1) {
-        memcpy(result_str + 1, string + 1, input_len - 1);
+    long threads = 1;
+    if (py_threads && py_threads != Py_None) {
+        threads = PyLong_AsLong(py_threads);
+        if (threads == -1 && PyErr_Occurred()) { return NULL; }
+        if (threads < 1) {
+            PyErr_SetString(PyExc_ValueError, "threads must be at least 1");
+            return NULL;
+        }
+    }
+    if (threads == 1) {
+        return convert_many(spec, &state->caches[spec->index], args[0]);
     }
-    result_str[input_len] = '\0';
+    return convert_many_parallel(spec, &state->pool, args[0],
+                                 threads > PARALLEL_MAX_THREADS ? PARALLEL_MAX_THREADS : (int)threads);
+}
+
+// --- Bytes-like Input ---
+//
+// Any object supporting the buffer protocol is converted byte by byte with
+// the ASCII kernels: bytes outside ASCII are neither letters, digits nor
+// whitespace. The result is a new bytes object, or is written into a
+// caller-supplied writable buffer.
 
-    PyObject* py_result = PyUnicode_FromString(result_str);
-    free(result_str);
-    return py_result; // PyUnicode_FromString sets error on failure
+// Returns 1 when two buffers share any memory
+static inline int buffers_overlap(const Py_buffer* a, const Py_buffer* b) {
+    const char* a_start = (const char*)a->buf;
+    const char* b_start = (const char*)b->buf;
+    return a_start < b_start + b->len && b_start < a_start + a->len;
 }
 
-// Equivalent to Python's pascalcase(string)
-// return capitalcase(camelcase(string))
-static PyObject* pascalcase(PyObject* self, PyObject* args) {
-    PyObject* camel_result_py = camelcase(self, args);
-    if (!camel_result_py) { return NULL; }
+// Point *string at data that no other thread or process can change while it
+// is measured and converted. Only exact bytes are immutable; a bytearray,
+// mmap or other exporter could change between the measure and the kernel and
+// make the kernel overrun an output sized by the measure, so it is copied.
+// Returns 1, or 0 with MemoryError set.
+static int buffer_snapshot(const CaseSpec* spec, PyObject* data, const Py_buffer* view, ScratchBuffer* copy,
+                           const char** string) {
+    *string = (const char*)view->buf;
+    if (PyBytes_CheckExact(data)) { return 1; }
+    if (!scratch_reserve(copy, view->len + 1, spec->name)) { return 0; }
+    memcpy(copy->data, view->buf, view->len);
+    *string = copy->data;
+    return 1;
+}
 
-    char* camel_result_c = get_string_from_pyobject(camel_result_py);
-    Py_DECREF(camel_result_py); // Decref intermediate Python object
-    if (!camel_result_c) { return NULL; }
+// Convert a bytes-like object into new bytes, or into `out` when it is not
+// NULL, returning the number of bytes written as an int.
+static PyObject* convert_buffer(const CaseSpec* spec, PyObject* data, PyObject* out) {
+    Py_buffer view;
+    if (PyObject_GetBuffer(data, &view, PyBUF_SIMPLE) < 0) { return NULL; }
+    ScratchBuffer copy = {NULL, 0};
+    const char* string;
+    if (!buffer_snapshot(spec, data, &view, &copy, &string)) {
+        PyBuffer_Release(&view);
+        return NULL;
+    }
+    Py_ssize_t len = view.len;
+    Py_ssize_t result_len = spec->measure(string, len);
+    PyObject* py_result = NULL;
+    int allocations = copy.data != NULL;
 
-    Py_ssize_t len = strlen(camel_result_c);
-    if (len > 0) {
-        camel_result_c[0] = toupper((unsigned char)camel_result_c[0]);
+    if (!out) {
+        if (PyBytes_CheckExact(data) && spec->is_normalized(string, len)) {
+            Py_INCREF(data);
+            py_result = data;
+        } else if ((py_result = PyBytes_FromStringAndSize(NULL, result_len)) != NULL) {
+            // bytes objects keep a trailing NUL, which is the kernel's spare byte
+            char* result_data = PyBytes_AS_STRING(py_result);
+            result_data[spec->kernel(string, len, result_data)] = '\0';
+            allocations++;
+        }
+        if (py_result && stats_enabled) { stats_convert(spec->stats, 1, len, result_len, allocations); }
+        scratch_free(&copy);
+        PyBuffer_Release(&view);
+        return py_result;
     }
 
-    PyObject* final_result = PyUnicode_FromString(camel_result_c);
-    free(camel_result_c); // Free the C string copy
-    return final_result; // PyUnicode_FromString sets error on failure
+    Py_buffer out_view;
+    if (PyObject_GetBuffer(out, &out_view, PyBUF_WRITABLE) < 0) {
+        scratch_free(&copy);
+        PyBuffer_Release(&view);
+        return NULL;
+    }
+    if (out_view.len < result_len) {
+        PyErr_Format(PyExc_ValueError, "%s output buffer too small: %zd bytes needed, %zd given",
+                     spec->name, result_len, out_view.len);
+    } else if (out_view.len > result_len && (copy.data || !buffers_overlap(&view, &out_view))) {
+        spec->kernel(string, len, (char*)out_view.buf);
+        py_result = PyLong_FromSsize_t(result_len);
+    } else {
+        // No spare byte after the result, or the buffers overlap
+        ScratchBuffer scratch = {NULL, 0};
+        if (scratch_reserve(&scratch, result_len + 1, spec->name)) {
+            spec->kernel(string, len, scratch.data);
+            memcpy(out_view.buf, scratch.data, result_len);
+            py_result = PyLong_FromSsize_t(result_len);
+            allocations++;
+        }
+        scratch_free(&scratch);
+    }
+    if (py_result && stats_enabled) { stats_convert(spec->stats, 1, len, result_len, allocations); }
+    scratch_free(&copy);
+    PyBuffer_Release(&out_view);
+    PyBuffer_Release(&view);
+    return py_result;
 }
 
-// Equivalent to Python's constcase(string)
-// return uppercase(snakecase(string))
-static PyObject* constcase(PyObject* self, PyObject* args) {
-    PyObject* snake_result_py = snakecase(self, args);
-    if (!snake_result_py) { return NULL; }
-
-    // Convert snake_result to uppercase
-    PyObject* upper_result = PyObject_CallMethod(snake_result_py, "upper", NULL);
-    Py_DECREF(snake_result_py); // Decref intermediate object
+// Argument parsing for name(data, out=None), shared by every case function.
+// A lone str argument takes the shortest path.
+static PyObject* convert_one_entry(const CaseSpec* spec, CaseCache* cache, PyObject* const* args, Py_ssize_t nargs,
+                                   PyObject* kwnames) {
+    if (nargs == 1 && !kwnames && PyUnicode_Check(args[0])) {
+        return convert_one(spec, cache, args[0]);
+    }
+    Py_ssize_t nkwargs = kwnames ? PyTuple_GET_SIZE(kwnames) : 0;
+    if (nargs < 1 || nargs + nkwargs > 2) {
+        PyErr_Format(PyExc_TypeError, "%s() takes a string and an optional out argument", spec->name);
+        return NULL;
+    }
+    PyObject* out = nargs > 1 ? args[1] : NULL;
+    for (Py_ssize_t i = 0; i < nkwargs; ++i) {
+        PyObject* kwname = PyTuple_GET_ITEM(kwnames, i);
+        if (out || !PyUnicode_Check(kwname) || PyUnicode_CompareWithASCIIString(kwname, "out") != 0) {
+            PyErr_Format(PyExc_TypeError, "%s() got an unexpected keyword argument '%S'", spec->name, kwname);
+            return NULL;
+        }
+        out = args[nargs + i];
+    }
+    if (out == Py_None) { out = NULL; }
 
-    return upper_result; // Returns NULL if .upper() fails
+    if (!PyUnicode_Check(args[0]) && PyObject_CheckBuffer(args[0])) {
+        return convert_buffer(spec, args[0], out);
+    }
+    if (out) {
+        PyErr_Format(PyExc_TypeError, "%s() only accepts out with a bytes-like object", spec->name);
+        return NULL;
+    }
+    return convert_one(spec, cache, args[0]);
 }
 
-// Equivalent to Python's pathcase(string)
-// string = snakecase(string)
-// return re.sub(r"_", "/", string)
-static PyObject* pathcase(PyObject* self, PyObject* args) {
-    PyObject* snake_result_py = snakecase(self, args);
-    if (!snake_result_py) { return NULL; }
+// Convert a writable bytes-like object in place. Only used with kernels that
+// write each byte at or before the position they read it from and never
+// touch the spare byte, and only when the length does not change.
+// Kernels that always keep the length run on the buffer itself. The others
+// run on a copy, which is written back only if its length still matches:
+// the buffer could change between the measure and the kernel. Copies of
+// identifier-sized buffers stay on the stack.
+#define INPLACE_STACK_BYTES 256
 
-    char* snake_result_c = get_string_from_pyobject(snake_result_py);
-    Py_DECREF(snake_result_py);
-    if (!snake_result_c) { return NULL; }
-
-    Py_ssize_t len = strlen(snake_result_c);
-    char* result_str = (char*)malloc(len + 1);
-    if (!result_str) {
-        free(snake_result_c);
-        PyErr_SetString(PyExc_MemoryError, "Failed to allocate memory for pathcase");
+static PyObject* convert_inplace(const CaseSpec* spec, PyObject* data) {
+    Py_buffer view;
+    if (PyObject_GetBuffer(data, &view, PyBUF_WRITABLE) < 0) { return NULL; }
+    char* string = (char*)view.buf;
+    char stack[INPLACE_STACK_BYTES];
+    ScratchBuffer copy = {NULL, 0};
+    if (spec->measure != same_length_measure) {
+        if (view.len < INPLACE_STACK_BYTES) {
+            string = stack;
+        } else if (scratch_reserve(&copy, view.len + 1, spec->name)) {
+            string = copy.data;
+        } else {
+            PyBuffer_Release(&view);
+            return NULL;
+        }
+        memcpy(string, view.buf, view.len);
+    }
+    if (spec->measure(string, view.len) != view.len) {
+        PyErr_Format(PyExc_ValueError, "%s would change the length of the buffer", spec->name);
+        scratch_free(&copy);
+        PyBuffer_Release(&view);
         return NULL;
     }
+    spec->kernel(string, view.len, string);
+    if (string != view.buf) { memcpy(view.buf, string, view.len); }
+    if (stats_enabled) { stats_convert(spec->stats, 1, view.len, view.len, copy.data != NULL); }
+    scratch_free(&copy);
+    PyBuffer_Release(&view);
+    Py_RETURN_NONE;
+}
 
-    for (Py_ssize_t i = 0; i < len; ++i) {
-        result_str[i] = (snake_result_c[i] == '_') ? '/' : snake_result_c[i];
+// --- Python Entry Points ---
+
+#define DEFINE_CASE_FUNCTIONS(name)                                                    \
+    static PyObject* name(PyObject* self, PyObject* const* args,                      \
+                          Py_ssize_t nargs, PyObject* kwnames) {                       \
+        int64_t start = stats_begin();                                                 \
+        CaseCache* cache = &get_module_state(self)->caches[name##_spec.index];        \
+        PyObject* py_result = convert_one_entry(&name##_spec, cache, args, nargs,      \
+                                                kwnames);                              \
+        stats_end(&name##_stats, start);                                               \
+        return py_result;                                                              \
+    }                                                                                  \
+    static PyObject* name##_many(PyObject* self, PyObject* const* args,               \
+                                 Py_ssize_t nargs, PyObject* kwnames) {                \
+        int64_t start = stats_begin();                                                 \
+        PyObject* py_result = convert_many_entry(&name##_spec, get_module_state(self), \
+                                                 args, nargs, kwnames);                \
+        stats_end(&name##_stats, start);                                               \
+        return py_result;                                                              \
+    }
+
+DEFINE_CASE_FUNCTIONS(lowercase)
+DEFINE_CASE_FUNCTIONS(uppercase)
+DEFINE_CASE_FUNCTIONS(snakecase)
+DEFINE_CASE_FUNCTIONS(camelcase)
+DEFINE_CASE_FUNCTIONS(capitalcase)
+DEFINE_CASE_FUNCTIONS(pascalcase)
+DEFINE_CASE_FUNCTIONS(constcase)
+DEFINE_CASE_FUNCTIONS(pathcase)
+DEFINE_CASE_FUNCTIONS(backslashcase)
+DEFINE_CASE_FUNCTIONS(spinalcase)
+DEFINE_CASE_FUNCTIONS(dotcase)
+DEFINE_CASE_FUNCTIONS(titlecase)
+DEFINE_CASE_FUNCTIONS(trimcase)
+DEFINE_CASE_FUNCTIONS(alphanumcase)
+DEFINE_CASE_FUNCTIONS(sentencecase)
+
+#define DEFINE_INPLACE_FUNCTION(name)                                    \
+    static PyObject* name##_inplace(PyObject* self, PyObject* data) {   \
+        int64_t start = stats_begin();                                   \
+        PyObject* py_result = convert_inplace(&name##_spec, data);      \
+        stats_end(&name##_stats, start);                                 \
+        return py_result;                                                \
     }
-    result_str[len] = '\0';
 
-    free(snake_result_c);
-    PyObject* final_result = PyUnicode_FromString(result_str);
-    free(result_str);
-    return final_result; // PyUnicode_FromString sets error on failure
+// Length-preserving whenever the input has no uppercase letter after index 0
+DEFINE_INPLACE_FUNCTION(lowercase)
+DEFINE_INPLACE_FUNCTION(uppercase)
+DEFINE_INPLACE_FUNCTION(snakecase)
+DEFINE_INPLACE_FUNCTION(constcase)
+DEFINE_INPLACE_FUNCTION(pathcase)
+DEFINE_INPLACE_FUNCTION(backslashcase)
+DEFINE_INPLACE_FUNCTION(spinalcase)
+DEFINE_INPLACE_FUNCTION(dotcase)
+
+// --- Cache Control ---
+
+// The spec for a case function name, given in full ("snakecase") or without
+// its "case" suffix ("snake"), or NULL with ValueError set
+static const CaseSpec* find_case(const char* name) {
+    size_t len = strlen(name);
+    for (int i = 0; i < CASE_COUNT; ++i) {
+        const char* full = case_specs[i]->name;
+        if (strcmp(full, name) == 0
+            || (strncmp(full, name, len) == 0 && strcmp(full + len, "case") == 0)) {
+            return case_specs[i];
+        }
+    }
+    PyErr_Format(PyExc_ValueError, "Unknown case function '%s'", name);
+    return NULL;
 }
 
-// Equivalent to Python's backslashcase(string)
-// str1 = re.sub(r"_", r"\\", snakecase(string))
-static PyObject* backslashcase(PyObject* self, PyObject* args) {
-    PyObject* snake_result_py = snakecase(self, args);
-    if (!snake_result_py) { return NULL; }
+// Fill the module's {name: index into case_specs} for full and short names,
+// so per-call lookups by str object are one dict probe
+static int build_case_index(ModuleState* state) {
+    state->case_index = PyDict_New();
+    if (!state->case_index) { return -1; }
+    for (int i = 0; i < CASE_COUNT; ++i) {
+        const char* name = case_specs[i]->name;
+        PyObject* index = PyLong_FromLong(i);
+        PyObject* short_name = PyUnicode_FromStringAndSize(name, (Py_ssize_t)strlen(name) - 4);
+        int failed = !index || !short_name || PyDict_SetItemString(state->case_index, name, index) < 0
+                     || PyDict_SetItem(state->case_index, short_name, index) < 0;
+        Py_XDECREF(index);
+        Py_XDECREF(short_name);
+        if (failed) { return -1; }
+    }
+    return 0;
+}
 
-    char* snake_result_c = get_string_from_pyobject(snake_result_py);
-    Py_DECREF(snake_result_py);
-    if (!snake_result_c) { return NULL; }
+// find_case for a name object, or NULL with ValueError set
+static const CaseSpec* find_case_object(ModuleState* state, PyObject* name) {
+    PyObject* index = PyUnicode_Check(name) ? PyDict_GetItemWithError(state->case_index, name) : NULL;
+    if (!index) {
+        if (!PyErr_Occurred()) { PyErr_Format(PyExc_ValueError, "Unknown case function %R", name); }
+        return NULL;
+    }
+    return case_specs[PyLong_AS_LONG(index)];
+}
 
-    Py_ssize_t len = strlen(snake_result_c);
-    // Need potentially more space if replacing '_' with '\\'
-    char* result_str = (char*)malloc(len * 2 + 1); // Worst case: all '_'
-    if (!result_str) {
-        free(snake_result_c);
-        PyErr_SetString(PyExc_MemoryError, "Failed to allocate memory for backslashcase");
+// cache_configure(maxsize, intern=False, case=None)
+static PyObject* cache_configure(PyObject* self, PyObject* args, PyObject* kwargs) {
+    static char* kwlist[] = {"maxsize", "intern", "case", NULL};
+    Py_ssize_t maxsize;
+    int intern = 0;
+    const char* case_name = NULL;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "n|pz:cache_configure", kwlist,
+                                     &maxsize, &intern, &case_name)) {
+        return NULL;
+    }
+    if (maxsize < 0) {
+        PyErr_SetString(PyExc_ValueError, "maxsize must not be negative");
         return NULL;
     }
 
-    Py_ssize_t result_idx = 0;
-    for (Py_ssize_t i = 0; i < len; ++i) {
-        if (snake_result_c[i] == '_') {
-            result_str[result_idx++] = '\\';
-            // result_str[result_idx++] = '\\'; // C requires escaping the backslash literal
-        } else {
-            result_str[result_idx++] = snake_result_c[i];
+    const CaseSpec* only = NULL;
+    if (case_name && !(only = find_case(case_name))) { return NULL; }
+    ModuleState* state = get_module_state(self);
+    for (int i = 0; i < CASE_COUNT; ++i) {
+        if (only && case_specs[i] != only) { continue; }
+        if (cache_resize(&state->caches[i], maxsize, intern) < 0) { return NULL; }
+    }
+    Py_RETURN_NONE;
+}
+
+// cache_info() -> {name: (hits, misses, maxsize, currsize)} for every case
+static PyObject* cache_info(PyObject* self, PyObject* unused) {
+    PyObject* info = PyDict_New();
+    if (!info) { return NULL; }
+    ModuleState* state = get_module_state(self);
+    for (int i = 0; i < CASE_COUNT; ++i) {
+        CaseCache* cache = &state->caches[i];
+        CACHE_LOCK(cache);
+        Py_ssize_t hits = cache->hits, misses = cache->misses, maxsize = cache->nsets * CACHE_WAYS;
+        Py_ssize_t size = cache->size;
+        CACHE_UNLOCK(cache);
+        PyObject* entry = Py_BuildValue("(nnnn)", hits, misses, maxsize, size);
+        if (!entry || PyDict_SetItemString(info, case_specs[i]->name, entry) < 0) {
+            Py_XDECREF(entry);
+            Py_DECREF(info);
+            return NULL;
         }
+        Py_DECREF(entry);
     }
-    result_str[result_idx] = '\0';
+    return info;
+}
 
-    free(snake_result_c);
-    PyObject* final_result = PyUnicode_FromString(result_str);
-    free(result_str);
-    return final_result; // PyUnicode_FromString sets error on failure
+// cache_clear() empties every cache, keeping its size and interning setting
+static PyObject* cache_clear(PyObject* self, PyObject* unused) {
+    ModuleState* state = get_module_state(self);
+    for (int i = 0; i < CASE_COUNT; ++i) {
+        CACHE_LOCK(&state->caches[i]);
+        cache_clear_entries(&state->caches[i]);
+        CACHE_UNLOCK(&state->caches[i]);
+    }
+    Py_RETURN_NONE;
 }
 
-// Equivalent to Python's spinalcase(string)
-// return re.sub(r"_", "-", snakecase(string))
-static PyObject* spinalcase(PyObject* self, PyObject* args) {
-    PyObject* snake_result_py = snakecase(self, args);
-    if (!snake_result_py) { return NULL; }
+// --- Statistics Control ---
 
-    char* snake_result_c = get_string_from_pyobject(snake_result_py);
-    Py_DECREF(snake_result_py);
-    if (!snake_result_c) { return NULL; }
+static const char* const latency_bucket_names[STATS_LATENCY_BUCKETS] = {
+    "<1us", "<10us", "<100us", "<1ms", "<10ms", "<100ms", ">=100ms",
+};
 
-    Py_ssize_t len = strlen(snake_result_c);
-    char* result_str = (char*)malloc(len + 1);
-    if (!result_str) {
-        free(snake_result_c);
-        PyErr_SetString(PyExc_MemoryError, "Failed to allocate memory for spinalcase");
+// enable_stats(enabled=True) -> whether recording was on before
+static PyObject* enable_stats(PyObject* self, PyObject* args, PyObject* kwargs) {
+    static char* kwlist[] = {"enabled", NULL};
+    int enabled = 1;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|p:enable_stats", kwlist, &enabled)) {
         return NULL;
     }
+    int previous = stats_enabled;
+    stats_enabled = enabled;
+    return PyBool_FromLong(previous);
+}
+
+static PyObject* case_stats_dict(CaseStats* stats) {
+    PyObject* latency = PyDict_New();
+    if (!latency) { return NULL; }
+    for (int i = 0; i < STATS_LATENCY_BUCKETS; ++i) {
+        PyObject* count = PyLong_FromLongLong(stats_load(&stats->latency[i]));
+        if (!count || PyDict_SetItemString(latency, latency_bucket_names[i], count) < 0) {
+            Py_XDECREF(count);
+            Py_DECREF(latency);
+            return NULL;
+        }
+        Py_DECREF(count);
+    }
+    return Py_BuildValue("{sLsLsLsLsLsLsLsN}",
+                         "calls", (long long)stats_load(&stats->calls),
+                         "strings", (long long)stats_load(&stats->strings),
+                         "input_bytes", (long long)stats_load(&stats->input_bytes),
+                         "output_bytes", (long long)stats_load(&stats->output_bytes),
+                         "allocations", (long long)stats_load(&stats->allocations),
+                         "cache_hits", (long long)stats_load(&stats->cache_hits),
+                         "time_ns", (long long)stats_load(&stats->time_ns),
+                         "latency", latency);
+}
 
-    for (Py_ssize_t i = 0; i < len; ++i) {
-        result_str[i] = (snake_result_c[i] == '_') ? '-' : snake_result_c[i];
+// stats() -> {name: {counter: value, ..., "latency": {bucket: calls}}} for every case
+static PyObject* stats(PyObject* self, PyObject* unused) {
+    PyObject* result = PyDict_New();
+    if (!result) { return NULL; }
+    for (int i = 0; i < CASE_COUNT; ++i) {
+        PyObject* entry = case_stats_dict(case_specs[i]->stats);
+        if (!entry || PyDict_SetItemString(result, case_specs[i]->name, entry) < 0) {
+            Py_XDECREF(entry);
+            Py_DECREF(result);
+            return NULL;
+        }
+        Py_DECREF(entry);
     }
-    result_str[len] = '\0';
+    return result;
+}
 
-    free(snake_result_c);
-    PyObject* final_result = PyUnicode_FromString(result_str);
-    free(result_str);
-    return final_result; // PyUnicode_FromString sets error on failure
+// reset_stats() zeroes every counter, leaving recording on or off
+static PyObject* reset_stats(PyObject* self, PyObject* unused) {
+    for (int i = 0; i < CASE_COUNT; ++i) {
+        CaseStats* stats = case_specs[i]->stats;
+        stats_store(&stats->calls, 0);
+        stats_store(&stats->strings, 0);
+        stats_store(&stats->input_bytes, 0);
+        stats_store(&stats->output_bytes, 0);
+        stats_store(&stats->allocations, 0);
+        stats_store(&stats->cache_hits, 0);
+        stats_store(&stats->time_ns, 0);
+        for (int bucket = 0; bucket < STATS_LATENCY_BUCKETS; ++bucket) {
+            stats_store(&stats->latency[bucket], 0);
+        }
+    }
+    Py_RETURN_NONE;
 }
 
-// Equivalent to Python's dotcase(string)
-// return re.sub(r"_", ".", snakecase(string))
-static PyObject* dotcase(PyObject* self, PyObject* args) {
-    PyObject* snake_result_py = snakecase(self, args);
-    if (!snake_result_py) { return NULL; }
+// --- Case Styles ---
+//
+// detect_case(s) names the style a string is already in (style_rules in
+// stringcase_core.h), and ensure_case(s, case) converts only strings that
+// are not in the style of `case`. Both decide from a single scan of the
+// string's character classes, vectorized for ASCII, so input that is
+// already in the target style costs one pass and no allocation.
 
-    char* snake_result_c = get_string_from_pyobject(snake_result_py);
-    Py_DECREF(snake_result_py);
-    if (!snake_result_c) { return NULL; }
+typedef unsigned int (*style_classifier)(const void* data, fsc_ssize_t len);
 
-    Py_ssize_t len = strlen(snake_result_c);
-    char* result_str = (char*)malloc(len + 1);
-    if (!result_str) {
-        free(snake_result_c);
-        PyErr_SetString(PyExc_MemoryError, "Failed to allocate memory for dotcase");
-        return NULL;
-    }
+static const style_classifier unicode_style_classes[3] = UNICODE_KERNELS(style_classes);
 
-    for (Py_ssize_t i = 0; i < len; ++i) {
-        result_str[i] = (snake_result_c[i] == '_') ? '.' : snake_result_c[i];
+// STYLE_ of each case function, by CaseSpec.index; -1 for those without one
+static const int case_styles[CASE_COUNT] = {
+    -1,            // lowercase
+    -1,            // uppercase
+    STYLE_SNAKE,
+    STYLE_CAMEL,
+    -1,            // capitalcase
+    STYLE_PASCAL,
+    STYLE_CONST,
+    STYLE_PATH,
+    -1,            // backslashcase
+    STYLE_SPINAL,
+    STYLE_DOT,
+    STYLE_TITLE,
+    -1,            // trimcase
+    -1,            // alphanumcase
+    -1,            // sentencecase
+};
+
+static int build_style_names(ModuleState* state) {
+    for (int i = 0; i < STYLE_COUNT; ++i) {
+        if (!(state->style_names[i] = PyUnicode_InternFromString(style_rules[i].name))) { return -1; }
     }
-    result_str[len] = '\0';
+    return 0;
+}
 
-    free(snake_result_c);
-    PyObject* final_result = PyUnicode_FromString(result_str);
-    free(result_str);
-    return final_result; // PyUnicode_FromString sets error on failure
+// Character classes of a str, or of a bytes-like object read as ASCII, and
+// the size of its data for the statistics. Returns 0, or -1 with an
+// exception set.
+static int object_style_classes(PyObject* obj, unsigned int* classes, Py_ssize_t* size) {
+    if (PyUnicode_Check(obj)) {
+        if (PyUnicode_READY(obj) < 0) { return -1; }
+        Py_ssize_t len = PyUnicode_GET_LENGTH(obj);
+        *classes = PyUnicode_IS_ASCII(obj) ? style_classes((const char*)PyUnicode_1BYTE_DATA(obj), len)
+                                           : unicode_style_classes[PyUnicode_KIND(obj) >> 1](PyUnicode_DATA(obj), len);
+        *size = len * PyUnicode_KIND(obj);
+        return 0;
+    }
+    Py_buffer view;
+    if (!PyObject_CheckBuffer(obj) || PyObject_GetBuffer(obj, &view, PyBUF_SIMPLE) < 0) {
+        if (!PyErr_Occurred()) { PyErr_SetString(PyExc_TypeError, "Expected a string object"); }
+        return -1;
+    }
+    *classes = style_classes((const char*)view.buf, view.len);
+    *size = view.len;
+    PyBuffer_Release(&view);
+    return 0;
 }
 
-// Equivalent to Python's titlecase(string)
-// return ' '.join([capitalcase(word) for word in snakecase(string).split("_")])
-static PyObject* titlecase(PyObject* self, PyObject* args) {
-    PyObject* snake_result_py = snakecase(self, args);
-    if (!snake_result_py) { return NULL; }
+static PyObject* detect_one(ModuleState* state, PyObject* obj) {
+    unsigned int classes;
+    Py_ssize_t size;
+    if (object_style_classes(obj, &classes, &size) < 0) { return NULL; }
+    PyObject* name = state->style_names[style_detect(classes)];
+    Py_INCREF(name);
+    return name;
+}
 
-    char* snake_result_c = get_string_from_pyobject(snake_result_py);
-    Py_DECREF(snake_result_py);
-    if (!snake_result_c) { return NULL; }
+// detect_case(s)
+static PyObject* detect_case(PyObject* self, PyObject* obj) {
+    return detect_one(get_module_state(self), obj);
+}
 
-    Py_ssize_t len = strlen(snake_result_c);
-    // Result length can be same as snake_case result
-    char* result_str = (char*)malloc(len + 1);
-    if (!result_str) {
-        free(snake_result_c);
-        PyErr_SetString(PyExc_MemoryError, "Failed to allocate memory for titlecase");
-        return NULL;
+// detect_case_many(items)
+static PyObject* detect_case_many(PyObject* self, PyObject* items) {
+    ModuleState* state = get_module_state(self);
+    PyObject* result_list = NULL;
+    if (PyList_CheckExact(items) || PyTuple_CheckExact(items)) {
+        // As in convert_many: only another thread could change the list
+        Py_BEGIN_CRITICAL_SECTION(items);
+        Py_ssize_t count = PySequence_Fast_GET_SIZE(items);
+        result_list = PyList_New(count);
+        for (Py_ssize_t i = 0; result_list && i < count; ++i) {
+            PyObject* name = detect_one(state, PySequence_Fast_GET_ITEM(items, i));
+            if (!name) {
+                Py_CLEAR(result_list);
+                break;
+            }
+            PyList_SET_ITEM(result_list, i, name);
+        }
+        Py_END_CRITICAL_SECTION();
+        return result_list;
     }
 
-    Py_ssize_t result_idx = 0;
-    int capitalize_next = 1; // Capitalize first letter of first word
+    PyObject* iterator = PyObject_GetIter(items);
+    if (!iterator) { return NULL; }
+    result_list = PyList_New(0);
+    PyObject* item;
+    while (result_list && (item = PyIter_Next(iterator))) {
+        PyObject* name = detect_one(state, item);
+        Py_DECREF(item);
+        if (!name || PyList_Append(result_list, name) < 0) { Py_CLEAR(result_list); }
+        Py_XDECREF(name);
+    }
+    Py_DECREF(iterator);
+    if (PyErr_Occurred()) { Py_CLEAR(result_list); }
+    return result_list;
+}
 
-    for (Py_ssize_t i = 0; i < len; ++i) {
-        char current_char = snake_result_c[i];
-        if (current_char == '_') {
-            result_str[result_idx++] = ' '; // Replace underscore with space
-            capitalize_next = 1; // Capitalize next letter
+// ensure_case(s, case)
+static PyObject* ensure_case(PyObject* self, PyObject* const* args, Py_ssize_t nargs) {
+    if (nargs != 2) {
+        PyErr_SetString(PyExc_TypeError, "ensure_case() takes a string and a case name");
+        return NULL;
+    }
+    ModuleState* state = get_module_state(self);
+    const CaseSpec* spec = find_case_object(state, args[1]);
+    if (!spec) { return NULL; }
+    int64_t start = stats_begin();
+    PyObject* obj = args[0];
+    PyObject* py_result = NULL;
+    int style = case_styles[spec->index];
+    unsigned int classes;
+    Py_ssize_t size;
+    if (style < 0) {
+        // The case function itself, which returns ASCII input it would not change
+        py_result = convert_one_entry(spec, &state->caches[spec->index], args, 1, NULL);
+    } else if (object_style_classes(obj, &classes, &size) == 0) {
+        if (!style_matches(classes, style)) {
+            py_result = convert_one_entry(spec, &state->caches[spec->index], args, 1, NULL);
+        } else if (PyUnicode_CheckExact(obj) || PyBytes_CheckExact(obj)) {
+            Py_INCREF(obj);
+            py_result = obj;
         } else {
-            if (capitalize_next) {
-                result_str[result_idx++] = toupper((unsigned char)current_char);
-                capitalize_next = 0;
-            } else {
-                // Title case usually lowercases subsequent letters within a word
-                result_str[result_idx++] = tolower((unsigned char)current_char);
-            }
+            // The types the case function returns: str for str subclasses, bytes for buffers
+            py_result = PyUnicode_Check(obj) ? PyUnicode_FromObject(obj) : PyBytes_FromObject(obj);
+        }
+        if (py_result && stats_enabled && style_matches(classes, style)) {
+            stats_convert(spec->stats, 1, size, size, py_result != obj);
         }
     }
-    result_str[result_idx] = '\0';
-
-    free(snake_result_c);
-    PyObject* final_result = PyUnicode_FromString(result_str);
-    free(result_str);
-    return final_result; // PyUnicode_FromString sets error on failure
+    stats_end(spec->stats, start);
+    return py_result;
 }
 
-// Equivalent to Python's trimcase(string)
-// return str(string).strip()
-static PyObject* trimcase(PyObject* self, PyObject* args) {
-    const char* string;
-    if (!PyArg_ParseTuple(args, "s", &string)) { return NULL; }
 
-    Py_ssize_t len = strlen(string);
-    Py_ssize_t start = 0;
-    while (start < len && isspace((unsigned char)string[start])) {
-        start++;
+// --- Nested Key Conversion ---
+
+// Copy of `obj` with the str keys of every dict converted, descending into
+// dicts, lists and tuples for `depth` levels (-1 for no limit). Dicts,
+// including subclasses, are rebuilt as plain dicts; exact list and tuple
+// objects are rebuilt; everything else is shared with the input. Returns a
+// new reference, or NULL with an exception set.
+static PyObject* transform_value(const CaseSpec* spec, CaseCache* cache, PyObject* obj, Py_ssize_t depth,
+                                 ScratchBuffer* scratch);
+
+// Store `key` converted and `value` transformed in `result`.
+static int transform_item(const CaseSpec* spec, CaseCache* cache, PyObject* result, PyObject* key,
+                          PyObject* value, Py_ssize_t depth, ScratchBuffer* scratch) {
+    PyObject* new_key = key;
+    if (PyUnicode_Check(key)) {
+        new_key = convert_cached(spec, cache, key, scratch);
+    } else {
+        Py_INCREF(new_key);
+    }
+    PyObject* new_value = new_key ? transform_value(spec, cache, value, depth, scratch) : NULL;
+    int status = new_value ? PyDict_SetItem(result, new_key, new_value) : -1;
+    Py_XDECREF(new_key);
+    Py_XDECREF(new_value);
+    return status;
+}
+
+// A dict subclass goes through its items(), which keeps the order and
+// contents an OrderedDict or an overriding subclass presents.
+static PyObject* transform_dict_subclass(const CaseSpec* spec, CaseCache* cache, PyObject* obj,
+                                         Py_ssize_t depth, ScratchBuffer* scratch) {
+    PyObject* items = PyMapping_Items(obj);
+    if (!items) { return NULL; }
+    PyObject* result = PyDict_New();
+    for (Py_ssize_t i = 0; result && i < PyList_GET_SIZE(items); ++i) {
+        PyObject* item = PyList_GET_ITEM(items, i);
+        if (!PyTuple_Check(item) || PyTuple_GET_SIZE(item) != 2) {
+            PyErr_SetString(PyExc_TypeError, "items() must return (key, value) pairs");
+            Py_CLEAR(result);
+        } else if (transform_item(spec, cache, result, PyTuple_GET_ITEM(item, 0), PyTuple_GET_ITEM(item, 1),
+                                  depth, scratch) < 0) {
+            Py_CLEAR(result);
+        }
     }
+    Py_DECREF(items);
+    return result;
+}
 
-    // If the entire string is whitespace
-    if (start == len) {
-        return PyUnicode_FromString("");
+static PyObject* transform_value(const CaseSpec* spec, CaseCache* cache, PyObject* obj, Py_ssize_t depth,
+                                 ScratchBuffer* scratch) {
+    int is_dict = PyDict_Check(obj), is_list = PyList_CheckExact(obj);
+    if (depth == 0 || !(is_dict || is_list || PyTuple_CheckExact(obj))) {
+        Py_INCREF(obj);
+        return obj;
     }
+    if (Py_EnterRecursiveCall(" in transform_keys")) { return NULL; }
+    Py_ssize_t child_depth = depth > 0 ? depth - 1 : -1;
+    PyObject* result = NULL;
 
-    Py_ssize_t end = len - 1;
-    while (end > start && isspace((unsigned char)string[end])) {
-        end--;
+    if (is_dict && !PyDict_CheckExact(obj)) {
+        result = transform_dict_subclass(spec, cache, obj, child_depth, scratch);
+    } else if (is_dict) {
+        // Hashing a non-str key can run Python code that mutates the input
+        Py_ssize_t size = PyDict_GET_SIZE(obj), pos = 0;
+        PyObject *key, *value;
+        result = PyDict_New();
+        Py_BEGIN_CRITICAL_SECTION(obj);
+        while (result && PyDict_Next(obj, &pos, &key, &value)) {
+            Py_INCREF(key);
+            Py_INCREF(value);
+            if (transform_item(spec, cache, result, key, value, child_depth, scratch) < 0) {
+                Py_CLEAR(result);
+            } else if (PyDict_GET_SIZE(obj) != size) {
+                PyErr_SetString(PyExc_RuntimeError, "dictionary changed size during iteration");
+                Py_CLEAR(result);
+            }
+            Py_DECREF(key);
+            Py_DECREF(value);
+        }
+        Py_END_CRITICAL_SECTION();
+    } else {
+        Py_BEGIN_CRITICAL_SECTION(obj);
+        Py_ssize_t size = is_list ? PyList_GET_SIZE(obj) : PyTuple_GET_SIZE(obj);
+        result = is_list ? PyList_New(size) : PyTuple_New(size);
+        for (Py_ssize_t i = 0; result && i < size; ++i) {
+            if (is_list && PyList_GET_SIZE(obj) != size) {
+                PyErr_SetString(PyExc_RuntimeError, "list changed size during iteration");
+                Py_CLEAR(result);
+                break;
+            }
+            PyObject* item = is_list ? PyList_GET_ITEM(obj, i) : PyTuple_GET_ITEM(obj, i);
+            Py_INCREF(item);
+            PyObject* new_item = transform_value(spec, cache, item, child_depth, scratch);
+            Py_DECREF(item);
+            if (!new_item) {
+                Py_CLEAR(result);
+            } else if (is_list) {
+                PyList_SET_ITEM(result, i, new_item);
+            } else {
+                PyTuple_SET_ITEM(result, i, new_item);
+            }
+        }
+        Py_END_CRITICAL_SECTION();
     }
+    Py_LeaveRecursiveCall();
+    return result;
+}
 
-    Py_ssize_t trimmed_len = end - start + 1;
-    char* result_str = (char*)malloc(trimmed_len + 1);
-    if (!result_str) {
-        PyErr_SetString(PyExc_MemoryError, "Failed to allocate memory for trimcase");
+// transform_keys(obj, case, *, depth=None)
+static PyObject* transform_keys(PyObject* self, PyObject* args, PyObject* kwargs) {
+    static char* kwlist[] = {"obj", "case", "depth", NULL};
+    PyObject* obj;
+    const char* case_name;
+    PyObject* py_depth = Py_None;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "Os|$O:transform_keys", kwlist,
+                                     &obj, &case_name, &py_depth)) {
         return NULL;
     }
+    const CaseSpec* spec = find_case(case_name);
+    if (!spec) { return NULL; }
 
-    memcpy(result_str, string + start, trimmed_len);
-    result_str[trimmed_len] = '\0';
+    Py_ssize_t depth = -1;
+    if (py_depth != Py_None) {
+        depth = PyNumber_AsSsize_t(py_depth, PyExc_OverflowError);
+        if (depth == -1 && PyErr_Occurred()) { return NULL; }
+        if (depth < 0) {
+            PyErr_SetString(PyExc_ValueError, "depth must not be negative");
+            return NULL;
+        }
+    }
 
-    PyObject* py_result = PyUnicode_FromString(result_str);
-    free(result_str);
-    return py_result; // PyUnicode_FromString sets error on failure
+    ScratchBuffer scratch = {NULL, 0};
+    CaseCache* cache = &get_module_state(self)->caches[spec->index];
+    PyObject* result = transform_value(spec, cache, obj, depth, &scratch);
+    scratch_free(&scratch);
+    return result;
 }
 
-// Equivalent to Python's alphanumcase(string)
-// return re.sub("\W+", "", string)
-static PyObject* alphanumcase(PyObject* self, PyObject* args) {
-    const char* string;
-    if (!PyArg_ParseTuple(args, "s", &string)) { return NULL; }
 
-    Py_ssize_t input_len = strlen(string);
-    // Result length <= input length
-    char* result_str = (char*)malloc(input_len + 1);
-    if (!result_str) {
-        PyErr_SetString(PyExc_MemoryError, "Failed to allocate memory for alphanumcase");
-        return NULL;
+// --- Multi-case Conversion ---
+//
+// words(s) exposes the split the case functions share (word_spans in
+// stringcase_core.h), and convert(s, cases) produces several cases of one
+// string from a single split. Non-ASCII input is split with the Unicode
+// classes for words(); convert() converts it, and anything longer than
+// WORDS_STACK_LEN, with each case's own kernel, since past that length the
+// vector kernels beat rebuilding the output word by word.
+
+// Spans for strings up to this length live on the stack
+#define WORDS_STACK_LEN 128
+
+#define WORDS_JOIN 1   // words_join: the snakecase family
+#define WORDS_TITLE 2  // words_title
+#define WORDS_CAMEL 3  // words_camel
+
+typedef struct {
+    const CaseSpec* spec;
+    int form;
+    char joiner;
+    int upper;  // constcase for WORDS_JOIN, pascalcase for WORDS_CAMEL
+} WordForm;
+
+static const WordForm word_forms[] = {
+    {&snakecase_spec, WORDS_JOIN, '_', 0},
+    {&constcase_spec, WORDS_JOIN, '_', 1},
+    {&pathcase_spec, WORDS_JOIN, '/', 0},
+    {&backslashcase_spec, WORDS_JOIN, '\\', 0},
+    {&spinalcase_spec, WORDS_JOIN, '-', 0},
+    {&dotcase_spec, WORDS_JOIN, '.', 0},
+    {&titlecase_spec, WORDS_TITLE, ' ', 0},
+    {&camelcase_spec, WORDS_CAMEL, 0, 0},
+    {&pascalcase_spec, WORDS_CAMEL, 0, 1},
+};
+
+static const WordForm* find_word_form(const CaseSpec* spec) {
+    for (size_t i = 0; i < sizeof(word_forms) / sizeof(word_forms[0]); ++i) {
+        if (word_forms[i].spec == spec) { return &word_forms[i]; }
     }
+    return NULL;
+}
 
-    Py_ssize_t result_idx = 0;
-    for (Py_ssize_t i = 0; i < input_len; i++) {
-        if (isalnum((unsigned char)string[i])) {
-            result_str[result_idx++] = string[i];
+// word_spans for any ready str
+static Py_ssize_t str_word_spans(PyObject* py_str, fsc_ssize_t* spans) {
+    Py_ssize_t len = PyUnicode_GET_LENGTH(py_str);
+    if (PyUnicode_IS_ASCII(py_str)) {
+        return word_spans((const char*)PyUnicode_1BYTE_DATA(py_str), len, spans);
+    }
+    int kind = PyUnicode_KIND(py_str);
+    const void* data = PyUnicode_DATA(py_str);
+    Py_ssize_t count = 0;
+    Py_ssize_t start = 0;
+    for (Py_ssize_t i = 0; i < len; ++i) {
+        Py_UCS4 current_char = PyUnicode_READ(kind, data, i);
+        if (uc_is_separator(current_char) || (i > 0 && uc_isupper(current_char))) {
+            spans[2 * count] = start;
+            spans[2 * count++ + 1] = i;
+            start = uc_is_separator(current_char) ? i + 1 : i;
         }
     }
-    result_str[result_idx] = '\0';
+    spans[2 * count] = start;
+    spans[2 * count++ + 1] = len;
+    return count;
+}
 
-    PyObject* py_result = PyUnicode_FromString(result_str);
-    free(result_str);
-    return py_result; // PyUnicode_FromString sets error on failure
+// Room for the spans of py_str: `stack` when it is big enough, else a new
+// block the caller frees with PyMem_Free. NULL with MemoryError set on failure.
+static fsc_ssize_t* alloc_word_spans(PyObject* py_str, fsc_ssize_t* stack) {
+    Py_ssize_t len = PyUnicode_GET_LENGTH(py_str);
+    if (len <= WORDS_STACK_LEN) { return stack; }
+    fsc_ssize_t* spans = PyMem_New(fsc_ssize_t, 2 * (len + 1));
+    if (!spans) { PyErr_NoMemory(); }
+    return spans;
 }
 
-// Equivalent to Python's sentencecase(string) - Simplified C implementation
-// Python:
-// joiner = ' '
-// string = re.sub(r"[\-_\.\s]", joiner, str(string))
-// return capitalcase(trimcase(re.sub(r"[A-Z]", lambda matched: joiner + lowercase(matched.group(0)), string)))
-// C Implementation (approximated):
-// 1. Replace separators with space.
-// 2. Insert space before uppercase letters (except first char of string).
-// 3. Trim result.
-// 4. Capitalize first letter of trimmed result.
-static PyObject* sentencecase(PyObject* self, PyObject* args) {
-    const char* string;
-    if (!PyArg_ParseTuple(args, "s", &string)) { return NULL; }
+// words(s, *, offsets=False)
+static PyObject* words(PyObject* self, PyObject* args, PyObject* kwargs) {
+    static char* kwlist[] = {"s", "offsets", NULL};
+    PyObject* py_str;
+    int offsets = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "U|$p:words", kwlist, &py_str, &offsets)) {
+        return NULL;
+    }
+    if (PyUnicode_READY(py_str) < 0) { return NULL; }
+
+    fsc_ssize_t stack[2 * (WORDS_STACK_LEN + 1)];
+    fsc_ssize_t* spans = alloc_word_spans(py_str, stack);
+    if (!spans) { return NULL; }
+    Py_ssize_t count = str_word_spans(py_str, spans);
+
+    PyObject* result = PyList_New(0);
+    for (Py_ssize_t k = 0; result && k < count; ++k) {
+        Py_ssize_t start = spans[2 * k], end = spans[2 * k + 1];
+        if (start == end) { continue; } // Left by runs of separators
+        PyObject* word = offsets ? Py_BuildValue("(nn)", start, end) : PyUnicode_Substring(py_str, start, end);
+        if (!word || PyList_Append(result, word) < 0) { Py_CLEAR(result); }
+        Py_XDECREF(word);
+    }
+    if (spans != stack) { PyMem_Free(spans); }
+    return result;
+}
 
-    Py_ssize_t input_len = strlen(string);
-    if (input_len == 0) { return PyUnicode_FromString(""); }
+// One case of an ASCII string from its word spans
+static PyObject* convert_words(const WordForm* form, const char* string, fsc_ssize_t len,
+                               const fsc_ssize_t* spans, fsc_ssize_t count, fsc_ssize_t word_chars) {
+    fsc_ssize_t result_len = form->form == WORDS_CAMEL ? alnum_measure(string, len)
+                             : count ? word_chars + count - 1 : 0;
+    PyObject* py_result = PyUnicode_New(result_len, 127);
+    if (!py_result) { return NULL; }
+    char* out = (char*)PyUnicode_1BYTE_DATA(py_result);
+    if (form->form == WORDS_JOIN) {
+        words_join(string, spans, count, form->joiner, form->upper, out);
+    } else if (form->form == WORDS_TITLE) {
+        words_title(string, spans, count, out);
+    } else {
+        words_camel(string, spans, count, form->upper, out);
+    }
+    out[result_len] = '\0';
+    if (stats_enabled) { stats_convert(form->spec->stats, 1, len, result_len, 1); }
+    return py_result;
+}
 
-    // Allocate generously for intermediate steps (spaces can be added)
-    char* buffer1 = (char*)malloc(input_len * 2 + 1); // For separator replacement + spaces before caps
-    char* buffer2 = (char*)malloc(input_len * 2 + 1); // For trimming
-    if (!buffer1 || !buffer2) {
-        free(buffer1); free(buffer2);
-        PyErr_SetString(PyExc_MemoryError, "Failed to allocate memory for sentencecase");
+// convert(s, cases) -> tuple with s in each of the named cases
+static PyObject* convert(PyObject* self, PyObject* const* args, Py_ssize_t nargs, PyObject* kwnames) {
+    static const char* const params[] = {"s", "cases"};
+    PyObject* values[2] = {nargs > 0 ? args[0] : NULL, nargs > 1 ? args[1] : NULL};
+    Py_ssize_t nkwargs = kwnames ? PyTuple_GET_SIZE(kwnames) : 0;
+    if (nargs + nkwargs > 2) {
+        PyErr_SetString(PyExc_TypeError, "convert() takes a string and a sequence of case names");
+        return NULL;
+    }
+    for (Py_ssize_t i = 0; i < nkwargs; ++i) {
+        PyObject* kwname = PyTuple_GET_ITEM(kwnames, i);
+        int param = 0;
+        while (param < 2 && !(PyUnicode_Check(kwname) && PyUnicode_CompareWithASCIIString(kwname, params[param]) == 0)) {
+            param++;
+        }
+        if (param == 2 || values[param]) {
+            PyErr_Format(PyExc_TypeError, "convert() got an unexpected keyword argument '%S'", kwname);
+            return NULL;
+        }
+        values[param] = args[nargs + i];
+    }
+    PyObject* py_str = values[0];
+    PyObject* cases = values[1];
+    if (!py_str || !cases) {
+        PyErr_SetString(PyExc_TypeError, "convert() takes a string and a sequence of case names");
+        return NULL;
+    }
+    if (!PyUnicode_Check(py_str)) {
+        PyErr_SetString(PyExc_TypeError, "Expected a string object");
+        return NULL;
+    }
+    if (PyUnicode_READY(py_str) < 0) { return NULL; }
+    if (PyUnicode_Check(cases)) {
+        PyErr_SetString(PyExc_TypeError, "convert() cases must be a sequence of case names, not a str");
         return NULL;
     }
+    PyObject* case_seq = PySequence_Fast(cases, "convert() cases must be a sequence of case names");
+    if (!case_seq) { return NULL; }
+    int split = PyUnicode_IS_ASCII(py_str) && PyUnicode_GET_LENGTH(py_str) <= WORDS_STACK_LEN;
+    const char* string = (const char*)PyUnicode_1BYTE_DATA(py_str);
+    Py_ssize_t len = PyUnicode_GET_LENGTH(py_str);
+    fsc_ssize_t stack[2 * (WORDS_STACK_LEN + 1)];
+    int have_spans = 0;  // Split on first use
+    fsc_ssize_t count = 0, word_chars = 0;
+    ScratchBuffer scratch = {NULL, 0};
+    ModuleState* state = get_module_state(self);
+    PyObject* result;
 
-    // Step 1 & 2: Replace separators and insert space before caps
-    Py_ssize_t idx1 = 0;
-    for (Py_ssize_t i = 0; i < input_len; ++i) {
-        char current_char = string[i];
-        if (current_char == '-' || current_char == '_' || current_char == '.' || current_char == ' ') {
-            // Add space only if the last char wasn't already a space
-            if (idx1 > 0 && buffer1[idx1 - 1] != ' ') {
-                buffer1[idx1++] = ' ';
-            }
-        } else if (isupper(current_char)) {
-            // Add space before uppercase if not the first char and previous wasn't space
-            if (idx1 > 0 && buffer1[idx1 - 1] != ' ') {
-                 buffer1[idx1++] = ' ';
+    // case_seq is the caller's list when one is given
+    Py_BEGIN_CRITICAL_SECTION(case_seq);
+    Py_ssize_t ncases = PySequence_Fast_GET_SIZE(case_seq);
+    result = PyTuple_New(ncases);
+    for (Py_ssize_t i = 0; result && i < ncases; ++i) {
+        // Hashing a str subclass can run Python code that mutates the list
+        if (PySequence_Fast_GET_SIZE(case_seq) != ncases) {
+            PyErr_SetString(PyExc_RuntimeError, "cases changed size during conversion");
+            Py_CLEAR(result);
+            break;
+        }
+        PyObject* name = PySequence_Fast_GET_ITEM(case_seq, i);
+        Py_INCREF(name);
+        const CaseSpec* spec = find_case_object(state, name);
+        Py_DECREF(name);
+        if (!spec) {
+            Py_CLEAR(result);
+            break;
+        }
+
+        const WordForm* form = split ? find_word_form(spec) : NULL;
+        if (form && PyUnicode_CheckExact(py_str) && spec->is_normalized(string, len)) {
+            form = NULL;  // convert_string returns s itself
+        }
+        PyObject* converted;
+        if (form) {
+            if (!have_spans) {
+                count = word_spans(string, len, stack);
+                word_chars = words_length(stack, count);
+                have_spans = 1;
             }
-            buffer1[idx1++] = tolower((unsigned char)current_char); // Add lowercase version
+            converted = convert_words(form, string, len, stack, count, word_chars);
         } else {
-             buffer1[idx1++] = tolower((unsigned char)current_char); // Add other chars as lowercase
+            converted = convert_string(spec, py_str, &scratch);
+        }
+        if (!converted) {
+            Py_CLEAR(result);
+            break;
         }
+        PyTuple_SET_ITEM(result, i, converted);
     }
-    buffer1[idx1] = '\0';
+    Py_END_CRITICAL_SECTION();
+    scratch_free(&scratch);
+    Py_DECREF(case_seq);
+    return result;
+}
 
-    // Step 3: Trim buffer1 into buffer2
-    Py_ssize_t len1 = idx1;
-    Py_ssize_t start = 0;
-    while (start < len1 && isspace((unsigned char)buffer1[start])) { start++; }
 
-    if (start == len1) { // All whitespace
-        free(buffer1); free(buffer2);
-        return PyUnicode_FromString("");
-    }
+// --- Converter Type ---
+//
+// Converter(input_separators=..., joiner=..., word_case=..., ...) compiles a
+// custom case style once: the separators become a class table and the
+// options become fields read by a single-pass word state machine
+// (converter_kernel.h), so calling it does no parsing.
 
-    Py_ssize_t end = len1 - 1;
-    while (end > start && isspace((unsigned char)buffer1[end])) { end--; }
+// Character classes used by the state machine
+#define CV_OTHER 0     // Digits, punctuation and anything uncased
+#define CV_SEPARATOR 1
+#define CV_UPPER 2
+#define CV_LOWER 3
 
-    Py_ssize_t trimmed_len = end - start + 1;
-    memcpy(buffer2, buffer1 + start, trimmed_len);
-    buffer2[trimmed_len] = '\0';
+// How the letters of a word are cased
+#define WORD_LOWER 0
+#define WORD_UPPER 1
+#define WORD_TITLE 2    // First letter upper, the rest lower
+#define WORD_CAPITAL 3  // First letter upper, the rest unchanged
+#define WORD_PRESERVE 4
 
-    // Step 4: Capitalize first letter of buffer2
-    if (trimmed_len > 0) {
-        buffer2[0] = toupper((unsigned char)buffer2[0]);
-    }
+static const char* const word_case_names[] = {"lower", "upper", "title", "capital", "preserve"};
 
-    // Create final Python object
-    PyObject* py_result = PyUnicode_FromString(buffer2);
+typedef struct {
+    PyObject_HEAD
+    vectorcallfunc vectorcall;
+    unsigned char classes[128];   // CV_* class of every ASCII character
+    Py_UCS4* separators;          // Non-ASCII input separators
+    Py_ssize_t separator_count;
+    Py_UCS4* joiner;
+    Py_ssize_t joiner_len;
+    int joiner_ascii;
+    int word_case;
+    int first_word_case;
+    int acronyms;
+    PyObject* input_separators_str;  // As given, for repr
+    PyObject* joiner_str;
+} ConverterObject;
+
+static inline int cv_class(const ConverterObject* conv, Py_UCS4 cp) {
+    if (cp < 0x80) { return conv->classes[cp]; }
+    for (Py_ssize_t i = 0; i < conv->separator_count; ++i) {
+        if (conv->separators[i] == cp) { return CV_SEPARATOR; }
+    }
+    return uc_isupper(cp) ? CV_UPPER : uc_islower(cp) ? CV_LOWER : CV_OTHER;
+}
 
-    free(buffer1);
-    free(buffer2);
-    return py_result; // PyUnicode_FromString sets error on failure
+static inline Py_UCS4 cv_recase(int word_case, Py_ssize_t word_pos, Py_UCS4 cp) {
+    switch (word_case) {
+    case WORD_LOWER: return uc_tolower(cp);
+    case WORD_UPPER: return uc_toupper(cp);
+    case WORD_TITLE: return word_pos == 0 ? uc_toupper(cp) : uc_tolower(cp);
+    case WORD_CAPITAL: return word_pos == 0 ? uc_toupper(cp) : cp;
+    default: return cp;
+    }
 }
 
+#define CV_IN Py_UCS1
+#define CV_OUT char
+#define CV_SUFFIX ascii
+#include "converter_kernel.h"
+#undef CV_IN
+#undef CV_OUT
+#undef CV_SUFFIX
 
-// --- Module Definition ---
+#define CV_IN Py_UCS1
+#define CV_OUT Py_UCS4
+#define CV_SUFFIX ucs1
+#include "converter_kernel.h"
+#undef CV_IN
+#undef CV_OUT
+#undef CV_SUFFIX
 
-static PyMethodDef StringCaseMethods[] = {
-    {"camelcase", camelcase, METH_VARARGS, "Convert string into camel case."},
-    {"capitalcase", capitalcase, METH_VARARGS, "Convert string into capital case."},
-    {"constcase", constcase, METH_VARARGS, "Convert string into const case."},
-    {"lowercase", lowercase, METH_VARARGS, "Convert string into lower case."},
-    {"pascalcase", pascalcase, METH_VARARGS, "Convert string into pascal case."},
-    {"pathcase", pathcase, METH_VARARGS, "Convert string into path case."},
-    {"backslashcase", backslashcase, METH_VARARGS, "Convert string into backslash case."},
-    {"sentencecase", sentencecase, METH_VARARGS, "Convert string into sentence case."},
-    {"snakecase", snakecase, METH_VARARGS, "Convert string into snake case."},
-    {"spinalcase", spinalcase, METH_VARARGS, "Convert string into spinal case."},
-    {"dotcase", dotcase, METH_VARARGS, "Convert string into dot case."},
-    {"titlecase", titlecase, METH_VARARGS, "Convert string into title case."},
-    {"trimcase", trimcase, METH_VARARGS, "Convert string into trim case."},
-    {"uppercase", uppercase, METH_VARARGS, "Convert string into upper case."},
-    {"alphanumcase", alphanumcase, METH_VARARGS, "Convert string into alphanumeric case."},
-    {NULL, NULL, 0, NULL} // Sentinel
+#define CV_IN Py_UCS2
+#define CV_OUT Py_UCS4
+#define CV_SUFFIX ucs2
+#include "converter_kernel.h"
+#undef CV_IN
+#undef CV_OUT
+#undef CV_SUFFIX
+
+#define CV_IN Py_UCS4
+#define CV_OUT Py_UCS4
+#define CV_SUFFIX ucs4
+#include "converter_kernel.h"
+#undef CV_IN
+#undef CV_OUT
+#undef CV_SUFFIX
+
+// Convert one str with a Converter. Returns a new reference, or NULL with an
+// exception set.
+static PyObject* converter_apply(const ConverterObject* conv, PyObject* py_str, ScratchBuffer* scratch) {
+    if (!PyUnicode_Check(py_str)) {
+        PyErr_SetString(PyExc_TypeError, "Expected a string object");
+        return NULL;
+    }
+    if (PyUnicode_READY(py_str) < 0) { return NULL; }
+
+    Py_ssize_t len = PyUnicode_GET_LENGTH(py_str);
+    // At most one joiner before every character, and an ASCII character
+    // never expands
+    int is_ascii = PyUnicode_IS_ASCII(py_str);
+    int upper = conv->word_case == WORD_UPPER || conv->first_word_case == WORD_UPPER;
+    Py_ssize_t max_out = (is_ascii || !upper ? 1 : UC_UPPER_MAX) + conv->joiner_len;
+    if (len > PY_SSIZE_T_MAX / (Py_ssize_t)sizeof(Py_UCS4) / max_out) { return PyErr_NoMemory(); }
+    Py_ssize_t capacity = len * max_out;
+
+    if (is_ascii && conv->joiner_ascii) {
+        // Typical identifiers fit on the stack, saving the scratch allocation
+        char local[256];
+        char* out = local;
+        if (capacity > (Py_ssize_t)sizeof(local)) {
+            if (!scratch_reserve(scratch, capacity, "Converter")) { return NULL; }
+            out = scratch->data;
+        }
+        Py_ssize_t result_len = cv_convert_ascii(conv, PyUnicode_1BYTE_DATA(py_str), len, out);
+        PyObject* py_result = PyUnicode_New(result_len, 127);
+        if (py_result) {
+            memcpy(PyUnicode_1BYTE_DATA(py_result), out, result_len);
+        }
+        return py_result;
+    }
+
+    if (!scratch_reserve(scratch, (capacity + 1) * (Py_ssize_t)sizeof(Py_UCS4), "Converter")) { return NULL; }
+    Py_UCS4* out = (Py_UCS4*)scratch->data;
+    Py_ssize_t result_len;
+    switch (PyUnicode_KIND(py_str)) {
+    case PyUnicode_1BYTE_KIND: result_len = cv_convert_ucs1(conv, PyUnicode_1BYTE_DATA(py_str), len, out); break;
+    case PyUnicode_2BYTE_KIND: result_len = cv_convert_ucs2(conv, PyUnicode_2BYTE_DATA(py_str), len, out); break;
+    default: result_len = cv_convert_ucs4(conv, PyUnicode_4BYTE_DATA(py_str), len, out); break;
+    }
+    return PyUnicode_FromKindAndData(PyUnicode_4BYTE_KIND, out, result_len);
+}
+
+static PyObject* converter_vectorcall(PyObject* self, PyObject* const* args, size_t nargsf, PyObject* kwnames) {
+    Py_ssize_t nargs = PyVectorcall_NARGS(nargsf);
+    if (nargs != 1 || (kwnames && PyTuple_GET_SIZE(kwnames))) {
+        PyErr_SetString(PyExc_TypeError, "Converter() takes exactly one string argument");
+        return NULL;
+    }
+    ScratchBuffer scratch = {NULL, 0};
+    PyObject* py_result = converter_apply((ConverterObject*)self, args[0], &scratch);
+    scratch_free(&scratch);
+    return py_result;
+}
+
+// Converter.many(items): like the *_many functions, one scratch buffer for all
+static PyObject* converter_many(PyObject* self, PyObject* items) {
+    const ConverterObject* conv = (const ConverterObject*)self;
+    PyObject* iterator = PyObject_GetIter(items);
+    if (!iterator) { return NULL; }
+    PyObject* result_list = PyList_New(0);
+    ScratchBuffer scratch = {NULL, 0};
+
+    PyObject* item;
+    while (result_list && (item = PyIter_Next(iterator)) != NULL) {
+        PyObject* converted = converter_apply(conv, item, &scratch);
+        Py_DECREF(item);
+        if (!converted || PyList_Append(result_list, converted) < 0) {
+            Py_CLEAR(result_list);
+        }
+        Py_XDECREF(converted);
+    }
+    if (result_list && PyErr_Occurred()) { Py_CLEAR(result_list); } // Raised by the iterator
+
+    Py_DECREF(iterator);
+    scratch_free(&scratch);
+    return result_list;
+}
+
+// The WORD_* value for a word case name, or -1 with ValueError set
+static int parse_word_case(const char* name, const char* argument) {
+    for (int i = 0; i < (int)(sizeof(word_case_names) / sizeof(word_case_names[0])); ++i) {
+        if (strcmp(word_case_names[i], name) == 0) { return i; }
+    }
+    PyErr_Format(PyExc_ValueError, "%s must be one of 'lower', 'upper', 'title', 'capital' or 'preserve', not '%s'",
+                 argument, name);
+    return -1;
+}
+
+static PyObject* converter_new(PyTypeObject* type, PyObject* args, PyObject* kwargs) {
+    static char* kwlist[] = {"input_separators", "joiner", "word_case", "first_word_case", "acronyms", NULL};
+    PyObject* input_separators = NULL;
+    PyObject* joiner = NULL;
+    const char* word_case_name = "lower";
+    const char* first_word_case_name = NULL;
+    int acronyms = 1;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|UUszp:Converter", kwlist, &input_separators, &joiner,
+                                     &word_case_name, &first_word_case_name, &acronyms)) {
+        return NULL;
+    }
+    int word_case = parse_word_case(word_case_name, "word_case");
+    if (word_case < 0) { return NULL; }
+    int first_word_case = first_word_case_name ? parse_word_case(first_word_case_name, "first_word_case") : word_case;
+    if (first_word_case < 0) { return NULL; }
+
+    ConverterObject* conv = (ConverterObject*)type->tp_alloc(type, 0);
+    if (!conv) { return NULL; }
+    conv->vectorcall = converter_vectorcall;
+    conv->word_case = word_case;
+    conv->first_word_case = first_word_case;
+    conv->acronyms = acronyms;
+    conv->input_separators_str = input_separators ? input_separators : PyUnicode_FromString("-_. ");
+    conv->joiner_str = joiner ? joiner : PyUnicode_FromString("_");
+    if (input_separators) { Py_INCREF(input_separators); }
+    if (joiner) { Py_INCREF(joiner); }
+    if (!conv->input_separators_str || !conv->joiner_str
+        || PyUnicode_READY(conv->input_separators_str) < 0 || PyUnicode_READY(conv->joiner_str) < 0) {
+        goto error;
+    }
+
+    conv->joiner_len = PyUnicode_GET_LENGTH(conv->joiner_str);
+    conv->joiner_ascii = PyUnicode_IS_ASCII(conv->joiner_str);
+    if (!(conv->joiner = PyUnicode_AsUCS4Copy(conv->joiner_str))) { goto error; }
+
+    // Separators are added to the class table; non-ASCII ones are kept aside
+    for (int c = 0; c < 0x80; ++c) {
+        conv->classes[c] = ascii_isupper(c) ? CV_UPPER : ascii_islower(c) ? CV_LOWER : CV_OTHER;
+    }
+    Py_ssize_t separator_count = PyUnicode_GET_LENGTH(conv->input_separators_str);
+    conv->separators = PyMem_New(Py_UCS4, separator_count ? separator_count : 1);
+    if (!conv->separators) {
+        PyErr_NoMemory();
+        goto error;
+    }
+    for (Py_ssize_t i = 0; i < separator_count; ++i) {
+        Py_UCS4 cp = PyUnicode_READ_CHAR(conv->input_separators_str, i);
+        if (cp < 0x80) {
+            conv->classes[cp] = CV_SEPARATOR;
+        } else {
+            conv->separators[conv->separator_count++] = cp;
+        }
+    }
+    return (PyObject*)conv;
+
+error:
+    Py_DECREF(conv);
+    return NULL;
+}
+
+static void converter_dealloc(PyObject* self) {
+    ConverterObject* conv = (ConverterObject*)self;
+    PyTypeObject* type = Py_TYPE(self);
+    PyMem_Free(conv->separators);
+    PyMem_Free(conv->joiner);
+    Py_XDECREF(conv->input_separators_str);
+    Py_XDECREF(conv->joiner_str);
+    type->tp_free(self);
+    Py_DECREF(type);
+}
+
+static PyObject* converter_repr(PyObject* self) {
+    const ConverterObject* conv = (const ConverterObject*)self;
+    return PyUnicode_FromFormat("Converter(input_separators=%R, joiner=%R, word_case='%s', first_word_case='%s', acronyms=%s)",
+                                conv->input_separators_str, conv->joiner_str, word_case_names[conv->word_case],
+                                word_case_names[conv->first_word_case], conv->acronyms ? "True" : "False");
+}
+
+static PyMethodDef converter_methods[] = {
+    {"many", converter_many, METH_O, "Convert every string in an iterable."},
+    {NULL, NULL, 0, NULL} // Sentinel
+};
+
+// Heap types declare their vectorcall slot as a member
+static PyMemberDef converter_members[] = {
+    {"__vectorcalloffset__", T_PYSSIZET, offsetof(ConverterObject, vectorcall), READONLY, NULL},
+    {NULL, 0, 0, 0, NULL} // Sentinel
+};
+
+static PyType_Slot converter_slots[] = {
+    {Py_tp_doc, "Converter(input_separators='-_. ', joiner='_', word_case='lower', first_word_case=None, acronyms=True)\n"
+                "A custom case style compiled once; call it with a string, or use .many(items)."},
+    {Py_tp_call, PyVectorcall_Call},
+    {Py_tp_new, converter_new},
+    {Py_tp_dealloc, converter_dealloc},
+    {Py_tp_repr, converter_repr},
+    {Py_tp_methods, converter_methods},
+    {Py_tp_members, converter_members},
+    {0, NULL} // Sentinel
+};
+
+static PyType_Spec converter_spec = {
+    .name = "fast_stringcase.Converter",
+    .basicsize = sizeof(ConverterObject),
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_VECTORCALL,
+    .slots = converter_slots,
+};
+
+
+// --- Case-normalized Keys ---
+//
+// CaseNormalizedDict, case_equal() and canonical_hash() treat keys as
+// equal when they spell the same words: "userId", "user_id", "USER-ID"
+// and "User Id" are one key. Words are runs of letters and digits, split
+// at any other character, before an uppercase letter that follows a
+// non-uppercase one and before the last capital of a run followed by a
+// lowercase letter ("HTTPServer" is "http", "server"), as with
+// Converter(acronyms=True). Letters compare by their simple lowercase
+// mapping. Keys are scanned in place, so a lookup allocates nothing.
+
+#define KEY_BREAK 0x110000  // Hashed between words; above every code point
+#define KEY_END 0x110001
+
+typedef struct {
+    const Py_UCS1* ascii;  // The characters of an ASCII str, else NULL
+    int kind;
+    const void* data;
+    Py_ssize_t len;
+} KeyText;
+
+static inline void key_text_init(KeyText* text, PyObject* py_str) {
+    text->ascii = PyUnicode_IS_ASCII(py_str) ? PyUnicode_1BYTE_DATA(py_str) : NULL;
+    text->kind = PyUnicode_KIND(py_str);
+    text->data = PyUnicode_DATA(py_str);
+    text->len = PyUnicode_GET_LENGTH(py_str);
+}
+
+// Move *pos to the next letter or digit at or after it and return that
+// character lower-cased, or KEY_END. *boundary is set when it starts a word
+// (meaningless for the first one).
+static inline Py_UCS4 key_step(const KeyText* text, Py_ssize_t* pos, int* boundary) {
+    Py_ssize_t i = *pos, len = text->len;
+    Py_UCS4 current_char;
+    *boundary = 0;
+    if (text->ascii) {
+        const Py_UCS1* s = text->ascii;
+        while (i < len && !ascii_isalnum(s[i])) { i++; *boundary = 1; }
+        if (i == len) { return KEY_END; }
+        current_char = s[i];
+        if (!*boundary && i > 0 && ascii_isupper(current_char)) {
+            // The previous character is a letter or digit, or boundary would be set
+            *boundary = !ascii_isupper(s[i - 1]) || (i + 1 < len && ascii_islower(s[i + 1]));
+        }
+        current_char = ascii_tolower(current_char);
+    } else {
+        int kind = text->kind;
+        const void* data = text->data;
+        while (i < len && !uc_isalnum(PyUnicode_READ(kind, data, i))) { i++; *boundary = 1; }
+        if (i == len) { return KEY_END; }
+        current_char = PyUnicode_READ(kind, data, i);
+        if (!*boundary && i > 0 && uc_isupper(current_char)) {
+            *boundary = !uc_isupper(PyUnicode_READ(kind, data, i - 1))
+                        || (i + 1 < len && uc_islower(PyUnicode_READ(kind, data, i + 1)));
+        }
+        current_char = uc_tolower(current_char);
+    }
+    *pos = i;
+    return current_char;
+}
+
+// FNV-1a over the letters, with KEY_BREAK between words; never -1, which
+// is reserved for errors
+static Py_hash_t key_hash(PyObject* py_str) {
+    KeyText text;
+    key_text_init(&text, py_str);
+    uint64_t hash = 14695981039346656037ull;
+    int boundary;
+    Py_ssize_t pos = 0;
+    Py_UCS4 current_char;
+    for (int started = 0; (current_char = key_step(&text, &pos, &boundary)) != KEY_END; started = 1, ++pos) {
+        if (boundary && started) { hash = (hash ^ KEY_BREAK) * 1099511628211ull; }
+        hash = (hash ^ current_char) * 1099511628211ull;
+    }
+    Py_hash_t result = (Py_hash_t)(hash ^ (hash >> 32));
+    return result == -1 ? -2 : result;
+}
+
+// Both keys are walked in step: equal when every letter matches and words
+// break at the same letters.
+static int key_equal(PyObject* a, PyObject* b) {
+    if (a == b) { return 1; }
+    Py_ssize_t len = PyUnicode_GET_LENGTH(a);
+    if (PyUnicode_KIND(a) == PyUnicode_KIND(b) && len == PyUnicode_GET_LENGTH(b)
+        && memcmp(PyUnicode_DATA(a), PyUnicode_DATA(b), (size_t)len * PyUnicode_KIND(a)) == 0) {
+        return 1;  // Same spelling
+    }
+    KeyText text_a, text_b;
+    key_text_init(&text_a, a);
+    key_text_init(&text_b, b);
+    Py_ssize_t pos_a = 0, pos_b = 0;
+    for (int started = 0;; started = 1, ++pos_a, ++pos_b) {
+        int boundary_a, boundary_b;
+        Py_UCS4 char_a = key_step(&text_a, &pos_a, &boundary_a);
+        Py_UCS4 char_b = key_step(&text_b, &pos_b, &boundary_b);
+        if (char_a != char_b) { return 0; }
+        if (char_a == KEY_END) { return 1; }
+        if (started && boundary_a != boundary_b) { return 0; }
+    }
+}
+
+// case_equal(a, b)
+static PyObject* case_equal(PyObject* self, PyObject* const* args, Py_ssize_t nargs) {
+    if (nargs != 2) {
+        PyErr_SetString(PyExc_TypeError, "case_equal() takes exactly two strings");
+        return NULL;
+    }
+    if (!PyUnicode_Check(args[0]) || !PyUnicode_Check(args[1])) {
+        PyErr_SetString(PyExc_TypeError, "Expected a string object");
+        return NULL;
+    }
+    if (PyUnicode_READY(args[0]) < 0 || PyUnicode_READY(args[1]) < 0) { return NULL; }
+    return PyBool_FromLong(key_equal(args[0], args[1]));
+}
+
+// canonical_hash(s)
+static PyObject* canonical_hash(PyObject* self, PyObject* py_str) {
+    if (!PyUnicode_Check(py_str)) {
+        PyErr_SetString(PyExc_TypeError, "Expected a string object");
+        return NULL;
+    }
+    if (PyUnicode_READY(py_str) < 0) { return NULL; }
+    return PyLong_FromSsize_t(key_hash(py_str));
+}
+
+// The table keeps entries in insertion order, like dict: `slots` is an
+// open-addressing index into `entries`, probed with CPython's perturbation
+// scheme, and deleted entries stay as holes until the next resize.
+
+#define SLOT_EMPTY (-1)
+#define SLOT_DELETED (-2)
+
+typedef struct {
+    Py_hash_t hash;
+    PyObject* key;    // As first inserted; NULL once deleted
+    PyObject* value;
+} KeyEntry;
+
+typedef struct {
+    PyObject_HEAD
+    Py_ssize_t used;         // Live entries
+    Py_ssize_t entry_count;  // Entries filled so far, holes included
+    Py_ssize_t usable;       // Room in entries, 2/3 of the slots
+    KeyEntry* entries;
+    Py_ssize_t* slots;
+    size_t mask;             // Number of slots - 1
+} CaseNormalizedDictObject;
+
+// Every entry point runs in a critical section on the dict, so on a
+// free-threaded build no thread sees a table another is resizing.
+
+// Slot holding key's entry, or -1 if it is not present. key must be a ready str.
+static Py_ssize_t cnd_find(const CaseNormalizedDictObject* dict, PyObject* key, Py_hash_t hash) {
+    if (!dict->slots) { return -1; }
+    size_t perturb = (size_t)hash;
+    size_t i = (size_t)hash & dict->mask;
+    for (;;) {
+        Py_ssize_t index = dict->slots[i];
+        if (index == SLOT_EMPTY) { return -1; }
+        if (index >= 0) {
+            const KeyEntry* entry = &dict->entries[index];
+            if (entry->hash == hash && key_equal(entry->key, key)) { return (Py_ssize_t)i; }
+        }
+        perturb >>= 5;
+        i = (i * 5 + perturb + 1) & dict->mask;
+    }
+}
+
+// Rebuild the table with room for at least `minused` entries, dropping holes
+static int cnd_resize(CaseNormalizedDictObject* dict, Py_ssize_t minused) {
+    size_t size = 8;
+    while ((Py_ssize_t)(size * 2 / 3) <= minused) { size <<= 1; }
+    Py_ssize_t usable = (Py_ssize_t)(size * 2 / 3);
+    Py_ssize_t* slots = PyMem_New(Py_ssize_t, size);
+    KeyEntry* entries = PyMem_New(KeyEntry, usable);
+    if (!slots || !entries) {
+        PyMem_Free(slots);
+        PyMem_Free(entries);
+        PyErr_NoMemory();
+        return -1;
+    }
+    for (size_t i = 0; i < size; ++i) { slots[i] = SLOT_EMPTY; }
+    Py_ssize_t count = 0;
+    for (Py_ssize_t k = 0; k < dict->entry_count; ++k) {
+        if (!dict->entries[k].key) { continue; }
+        entries[count] = dict->entries[k];
+        size_t perturb = (size_t)entries[count].hash;
+        size_t i = perturb & (size - 1);
+        while (slots[i] != SLOT_EMPTY) {
+            perturb >>= 5;
+            i = (i * 5 + perturb + 1) & (size - 1);
+        }
+        slots[i] = count++;
+    }
+    PyMem_Free(dict->slots);
+    PyMem_Free(dict->entries);
+    dict->slots = slots;
+    dict->entries = entries;
+    dict->mask = size - 1;
+    dict->usable = usable;
+    dict->entry_count = count;
+    return 0;
+}
+
+static int cnd_check_key(PyObject* key) {
+    if (!PyUnicode_Check(key)) {
+        PyErr_Format(PyExc_TypeError, "CaseNormalizedDict keys must be str, not %.200s", Py_TYPE(key)->tp_name);
+        return -1;
+    }
+    return PyUnicode_READY(key);
+}
+
+// Slot of a lookup key, or -1 if absent; non-str keys are never present.
+// -2 with an exception set on failure.
+static Py_ssize_t cnd_lookup(const CaseNormalizedDictObject* dict, PyObject* key) {
+    if (!PyUnicode_Check(key)) { return -1; }
+    if (PyUnicode_READY(key) < 0) { return -2; }
+    return cnd_find(dict, key, key_hash(key));
+}
+
+static int cnd_set(CaseNormalizedDictObject* dict, PyObject* key, PyObject* value) {
+    if (cnd_check_key(key) < 0) { return -1; }
+    Py_hash_t hash = key_hash(key);
+    Py_ssize_t slot = cnd_find(dict, key, hash);
+    Py_INCREF(value);
+    if (slot >= 0) {
+        // Keep the key as first inserted, like dict
+        KeyEntry* entry = &dict->entries[dict->slots[slot]];
+        PyObject* old_value = entry->value;
+        entry->value = value;
+        Py_DECREF(old_value);
+        return 0;
+    }
+    if (dict->entry_count == dict->usable && cnd_resize(dict, dict->used * 2 + 1) < 0) {
+        Py_DECREF(value);
+        return -1;
+    }
+    size_t perturb = (size_t)hash;
+    size_t i = (size_t)hash & dict->mask;
+    while (dict->slots[i] >= 0) {
+        perturb >>= 5;
+        i = (i * 5 + perturb + 1) & dict->mask;
+    }
+    KeyEntry* entry = &dict->entries[dict->entry_count];
+    entry->hash = hash;
+    entry->key = key;
+    entry->value = value;
+    Py_INCREF(key);
+    dict->slots[i] = dict->entry_count++;
+    dict->used++;
+    return 0;
+}
+
+// Remove the entry in `slot` and return its value (a new reference); the
+// key is released here.
+static PyObject* cnd_take(CaseNormalizedDictObject* dict, Py_ssize_t slot) {
+    KeyEntry* entry = &dict->entries[dict->slots[slot]];
+    PyObject* key = entry->key;
+    PyObject* value = entry->value;
+    entry->key = entry->value = NULL;
+    dict->slots[slot] = SLOT_DELETED;
+    dict->used--;
+    Py_DECREF(key);
+    return value;
+}
+
+static void cnd_clear_entries(CaseNormalizedDictObject* dict) {
+    KeyEntry* entries = dict->entries;
+    Py_ssize_t count = dict->entry_count;
+    PyMem_Free(dict->slots);
+    dict->entries = NULL;
+    dict->slots = NULL;
+    dict->used = dict->entry_count = dict->usable = 0;
+    dict->mask = 0;
+    // Released last: a value's finalizer may use the dict again
+    for (Py_ssize_t k = 0; k < count; ++k) {
+        Py_XDECREF(entries[k].key);
+        Py_XDECREF(entries[k].value);
+    }
+    PyMem_Free(entries);
+}
+
+// Add every item of a mapping (anything with keys()) or iterable of pairs
+static int cnd_update_from(CaseNormalizedDictObject* dict, PyObject* other) {
+    if (PyDict_CheckExact(other)) {
+        Py_ssize_t pos = 0;
+        PyObject *key, *value;
+        int status = 0;
+        Py_BEGIN_CRITICAL_SECTION(other);
+        while (status == 0 && PyDict_Next(other, &pos, &key, &value)) {
+            Py_INCREF(key);
+            Py_INCREF(value);
+            status = cnd_set(dict, key, value);
+            Py_DECREF(key);
+            Py_DECREF(value);
+        }
+        Py_END_CRITICAL_SECTION();
+        return status;
+    }
+    if (PyObject_HasAttrString(other, "keys")) {
+        PyObject* keys = PyMapping_Keys(other);
+        if (!keys) { return -1; }
+        for (Py_ssize_t i = 0; i < PyList_GET_SIZE(keys); ++i) {
+            PyObject* key = PyList_GET_ITEM(keys, i);
+            PyObject* value = PyObject_GetItem(other, key);
+            int status = value ? cnd_set(dict, key, value) : -1;
+            Py_XDECREF(value);
+            if (status < 0) {
+                Py_DECREF(keys);
+                return -1;
+            }
+        }
+        Py_DECREF(keys);
+        return 0;
+    }
+    PyObject* iterator = PyObject_GetIter(other);
+    if (!iterator) { return -1; }
+    PyObject* item;
+    while ((item = PyIter_Next(iterator)) != NULL) {
+        PyObject* pair = PySequence_Fast(item, "CaseNormalizedDict update items must be (key, value) pairs");
+        Py_DECREF(item);
+        if (pair && PySequence_Fast_GET_SIZE(pair) != 2) {
+            PyErr_SetString(PyExc_ValueError, "CaseNormalizedDict update items must be (key, value) pairs");
+            Py_CLEAR(pair);
+        }
+        int status = pair ? cnd_set(dict, PySequence_Fast_GET_ITEM(pair, 0), PySequence_Fast_GET_ITEM(pair, 1)) : -1;
+        Py_XDECREF(pair);
+        if (status < 0) {
+            Py_DECREF(iterator);
+            return -1;
+        }
+    }
+    Py_DECREF(iterator);
+    return PyErr_Occurred() ? -1 : 0;
+}
+
+static int cnd_update_args(CaseNormalizedDictObject* dict, PyObject* args, PyObject* kwargs, const char* name) {
+    PyObject* other = NULL;
+    if (!PyArg_UnpackTuple(args, name, 0, 1, &other)) { return -1; }
+    if (other && cnd_update_from(dict, other) < 0) { return -1; }
+    return kwargs ? cnd_update_from(dict, kwargs) : 0;
+}
+
+static PyObject* cnd_new(PyTypeObject* type, PyObject* args, PyObject* kwargs) {
+    // Fields start zeroed: an empty table allocates nothing
+    return type->tp_alloc(type, 0);
+}
+
+static int cnd_init(PyObject* self, PyObject* args, PyObject* kwargs) {
+    int status;
+    Py_BEGIN_CRITICAL_SECTION(self);
+    status = cnd_update_args((CaseNormalizedDictObject*)self, args, kwargs, "CaseNormalizedDict");
+    Py_END_CRITICAL_SECTION();
+    return status;
+}
+
+static int cnd_traverse(PyObject* self, visitproc visit, void* arg) {
+    const CaseNormalizedDictObject* dict = (const CaseNormalizedDictObject*)self;
+    Py_VISIT(Py_TYPE(self));
+    for (Py_ssize_t k = 0; k < dict->entry_count; ++k) {
+        Py_VISIT(dict->entries[k].key);
+        Py_VISIT(dict->entries[k].value);
+    }
+    return 0;
+}
+
+static int cnd_clear(PyObject* self) {
+    cnd_clear_entries((CaseNormalizedDictObject*)self);
+    return 0;
+}
+
+static void cnd_dealloc(PyObject* self) {
+    PyTypeObject* type = Py_TYPE(self);
+    PyObject_GC_UnTrack(self);
+    cnd_clear_entries((CaseNormalizedDictObject*)self);
+    type->tp_free(self);
+    Py_DECREF(type);
+}
+
+static Py_ssize_t cnd_length(PyObject* self) {
+    Py_ssize_t used;
+    Py_BEGIN_CRITICAL_SECTION(self);
+    used = ((CaseNormalizedDictObject*)self)->used;
+    Py_END_CRITICAL_SECTION();
+    return used;
+}
+
+static PyObject* cnd_subscript(PyObject* self, PyObject* key) {
+    const CaseNormalizedDictObject* dict = (const CaseNormalizedDictObject*)self;
+    PyObject* value = NULL;
+    Py_BEGIN_CRITICAL_SECTION(self);
+    Py_ssize_t slot = cnd_lookup(dict, key);
+    if (slot >= 0) {
+        value = dict->entries[dict->slots[slot]].value;
+        Py_INCREF(value);
+    } else if (slot == -1) {
+        PyErr_SetObject(PyExc_KeyError, key);
+    }
+    Py_END_CRITICAL_SECTION();
+    return value;
+}
+
+static int cnd_ass_subscript(PyObject* self, PyObject* key, PyObject* value) {
+    CaseNormalizedDictObject* dict = (CaseNormalizedDictObject*)self;
+    PyObject* old_value = NULL;
+    int status = -1;
+    Py_BEGIN_CRITICAL_SECTION(self);
+    if (value) {
+        status = cnd_set(dict, key, value);
+    } else {
+        Py_ssize_t slot = cnd_lookup(dict, key);
+        if (slot >= 0) {
+            old_value = cnd_take(dict, slot);
+            status = 0;
+        } else if (slot == -1) {
+            PyErr_SetObject(PyExc_KeyError, key);
+        }
+    }
+    Py_END_CRITICAL_SECTION();
+    Py_XDECREF(old_value);
+    return status;
+}
+
+static int cnd_contains(PyObject* self, PyObject* key) {
+    Py_ssize_t slot;
+    Py_BEGIN_CRITICAL_SECTION(self);
+    slot = cnd_lookup((const CaseNormalizedDictObject*)self, key);
+    Py_END_CRITICAL_SECTION();
+    return slot == -2 ? -1 : slot >= 0;
+}
+
+#define CND_KEYS 0
+#define CND_VALUES 1
+#define CND_ITEMS 2
+
+// List of keys, values or (key, value) tuples in insertion order
+static PyObject* cnd_list(PyObject* self, int what) {
+    const CaseNormalizedDictObject* dict = (const CaseNormalizedDictObject*)self;
+    PyObject* result;
+    Py_BEGIN_CRITICAL_SECTION(self);
+    result = PyList_New(dict->used);
+    Py_ssize_t n = 0;
+    for (Py_ssize_t k = 0; result && k < dict->entry_count; ++k) {
+        const KeyEntry* entry = &dict->entries[k];
+        if (!entry->key) { continue; }
+        PyObject* item = what == CND_KEYS ? entry->key : what == CND_VALUES ? entry->value : NULL;
+        if (item) {
+            Py_INCREF(item);
+        } else if (!(item = PyTuple_Pack(2, entry->key, entry->value))) {
+            Py_CLEAR(result);
+            break;
+        }
+        PyList_SET_ITEM(result, n++, item);
+    }
+    Py_END_CRITICAL_SECTION();
+    return result;
+}
+
+// The module's CaseNormalizedDict type, which self may be a subclass of
+static PyTypeObject* cnd_base_type(PyObject* self) {
+    PyTypeObject* type = Py_TYPE(self);
+    while (type->tp_dealloc != cnd_dealloc) { type = type->tp_base; }
+    return type;
+}
+
+// An attribute of collections.abc, such as "KeysView". Returns a new reference.
+static PyObject* cnd_abc(PyObject* self, const char* name) {
+    PyObject* module = PyType_GetModule(cnd_base_type(self));
+    return module ? PyObject_GetAttrString(get_module_state(module)->collections_abc, name) : NULL;
+}
+
+// A collections.abc view, which reads the dict live through its mapping
+// methods: `in` on keys() matches any spelling, like `in` on the dict
+static PyObject* cnd_view(PyObject* self, const char* name) {
+    PyObject* view_type = cnd_abc(self, name);
+    if (!view_type) { return NULL; }
+    PyObject* view = PyObject_CallOneArg(view_type, self);
+    Py_DECREF(view_type);
+    return view;
+}
+
+static PyObject* cnd_keys(PyObject* self, PyObject* unused) {
+    return cnd_view(self, "KeysView");
+}
+
+static PyObject* cnd_values(PyObject* self, PyObject* unused) {
+    return cnd_view(self, "ValuesView");
+}
+
+static PyObject* cnd_items(PyObject* self, PyObject* unused) {
+    return cnd_view(self, "ItemsView");
+}
+
+// Iterates over a snapshot of the keys, so the dict may change meanwhile
+static PyObject* cnd_iter(PyObject* self) {
+    PyObject* keys = cnd_list(self, CND_KEYS);
+    if (!keys) { return NULL; }
+    PyObject* iterator = PyObject_GetIter(keys);
+    Py_DECREF(keys);
+    return iterator;
+}
+
+// get(key, default=None)
+static PyObject* cnd_get(PyObject* self, PyObject* const* args, Py_ssize_t nargs) {
+    if (nargs < 1 || nargs > 2) {
+        PyErr_SetString(PyExc_TypeError, "get() takes a key and an optional default");
+        return NULL;
+    }
+    const CaseNormalizedDictObject* dict = (const CaseNormalizedDictObject*)self;
+    PyObject* value = NULL;
+    Py_BEGIN_CRITICAL_SECTION(self);
+    Py_ssize_t slot = cnd_lookup(dict, args[0]);
+    if (slot != -2) {
+        value = slot >= 0 ? dict->entries[dict->slots[slot]].value : nargs == 2 ? args[1] : Py_None;
+        Py_INCREF(value);
+    }
+    Py_END_CRITICAL_SECTION();
+    return value;
+}
+
+// pop(key[, default])
+static PyObject* cnd_pop(PyObject* self, PyObject* const* args, Py_ssize_t nargs) {
+    if (nargs < 1 || nargs > 2) {
+        PyErr_SetString(PyExc_TypeError, "pop() takes a key and an optional default");
+        return NULL;
+    }
+    CaseNormalizedDictObject* dict = (CaseNormalizedDictObject*)self;
+    PyObject* value = NULL;
+    Py_BEGIN_CRITICAL_SECTION(self);
+    Py_ssize_t slot = cnd_lookup(dict, args[0]);
+    if (slot >= 0) {
+        value = cnd_take(dict, slot);
+    } else if (slot == -1 && nargs == 2) {
+        value = args[1];
+        Py_INCREF(value);
+    } else if (slot == -1) {
+        PyErr_SetObject(PyExc_KeyError, args[0]);
+    }
+    Py_END_CRITICAL_SECTION();
+    return value;
+}
+
+// setdefault(key, default=None)
+static PyObject* cnd_setdefault(PyObject* self, PyObject* const* args, Py_ssize_t nargs) {
+    if (nargs < 1 || nargs > 2) {
+        PyErr_SetString(PyExc_TypeError, "setdefault() takes a key and an optional default");
+        return NULL;
+    }
+    CaseNormalizedDictObject* dict = (CaseNormalizedDictObject*)self;
+    if (cnd_check_key(args[0]) < 0) { return NULL; }
+    PyObject* value;
+    Py_BEGIN_CRITICAL_SECTION(self);
+    Py_ssize_t slot = cnd_find(dict, args[0], key_hash(args[0]));
+    value = slot >= 0 ? dict->entries[dict->slots[slot]].value : nargs == 2 ? args[1] : Py_None;
+    if (slot < 0 && cnd_set(dict, args[0], value) < 0) {
+        value = NULL;
+    } else {
+        Py_INCREF(value);
+    }
+    Py_END_CRITICAL_SECTION();
+    return value;
+}
+
+static PyObject* cnd_update(PyObject* self, PyObject* args, PyObject* kwargs) {
+    int status;
+    Py_BEGIN_CRITICAL_SECTION(self);
+    status = cnd_update_args((CaseNormalizedDictObject*)self, args, kwargs, "update");
+    Py_END_CRITICAL_SECTION();
+    if (status < 0) { return NULL; }
+    Py_RETURN_NONE;
+}
+
+// popitem() -> the last inserted (key, value) pair, removed
+static PyObject* cnd_popitem(PyObject* self, PyObject* unused) {
+    CaseNormalizedDictObject* dict = (CaseNormalizedDictObject*)self;
+    PyObject *key = NULL, *value = NULL;
+    Py_BEGIN_CRITICAL_SECTION(self);
+    Py_ssize_t k = dict->entry_count - 1;
+    while (k >= 0 && !dict->entries[k].key) { k--; }
+    if (k >= 0) {
+        key = dict->entries[k].key;
+        Py_INCREF(key);
+        value = cnd_take(dict, cnd_find(dict, key, dict->entries[k].hash));
+    }
+    Py_END_CRITICAL_SECTION();
+    if (!key) {
+        PyErr_SetString(PyExc_KeyError, "popitem(): dictionary is empty");
+        return NULL;
+    }
+    PyObject* item = PyTuple_Pack(2, key, value);
+    Py_DECREF(key);
+    Py_DECREF(value);
+    return item;
+}
+
+static PyObject* cnd_clear_method(PyObject* self, PyObject* unused) {
+    Py_BEGIN_CRITICAL_SECTION(self);
+    cnd_clear_entries((CaseNormalizedDictObject*)self);
+    Py_END_CRITICAL_SECTION();
+    Py_RETURN_NONE;
+}
+
+static PyObject* cnd_copy(PyObject* self, PyObject* unused) {
+    const CaseNormalizedDictObject* dict = (const CaseNormalizedDictObject*)self;
+    PyTypeObject* type = cnd_base_type(self);
+    CaseNormalizedDictObject* copy = (CaseNormalizedDictObject*)type->tp_alloc(type, 0);
+    if (!copy) { return NULL; }
+    // The copy is not shared yet, so only self needs locking
+    Py_BEGIN_CRITICAL_SECTION(self);
+    for (Py_ssize_t k = 0; copy && k < dict->entry_count; ++k) {
+        const KeyEntry* entry = &dict->entries[k];
+        if (entry->key && cnd_set(copy, entry->key, entry->value) < 0) { Py_CLEAR(copy); }
+    }
+    Py_END_CRITICAL_SECTION();
+    return (PyObject*)copy;
+}
+
+static PyObject* cnd_repr(PyObject* self) {
+    PyObject* items = cnd_list(self, CND_ITEMS);
+    if (!items) { return NULL; }
+    // The keys are distinct strs, so a plain dict shows them faithfully
+    PyObject* plain = PyDict_New();
+    for (Py_ssize_t i = 0; plain && i < PyList_GET_SIZE(items); ++i) {
+        PyObject* item = PyList_GET_ITEM(items, i);
+        if (PyDict_SetItem(plain, PyTuple_GET_ITEM(item, 0), PyTuple_GET_ITEM(item, 1)) < 0) { Py_CLEAR(plain); }
+    }
+    Py_DECREF(items);
+    if (!plain) { return NULL; }
+    PyObject* result = PyUnicode_FromFormat("CaseNormalizedDict(%R)", plain);
+    Py_DECREF(plain);
+    return result;
+}
+
+// Whether self and another mapping hold the same items, with keys matched
+// in any spelling: equal lengths, no two keys of other that are the same
+// key here, and equal values. Returns 1, 0, or -1 with an exception set.
+static int cnd_equal(PyObject* self, PyObject* other) {
+    Py_ssize_t other_len = PyObject_Size(other);
+    if (other_len < 0 || cnd_length(self) != other_len) { return other_len < 0 ? -1 : 0; }
+    PyTypeObject* type = cnd_base_type(self);
+    CaseNormalizedDictObject* normalized = (CaseNormalizedDictObject*)type->tp_alloc(type, 0);
+    if (!normalized) { return -1; }
+    int equal = 1;
+    if (cnd_update_from(normalized, other) < 0) {
+        // A key that is not a str is never in self
+        equal = PyErr_ExceptionMatches(PyExc_TypeError) ? 0 : -1;
+        if (equal == 0) { PyErr_Clear(); }
+    }
+    if (equal == 1 && normalized->used != other_len) { equal = 0; }
+    const CaseNormalizedDictObject* dict = (const CaseNormalizedDictObject*)self;
+    for (Py_ssize_t k = 0; equal == 1 && k < normalized->entry_count; ++k) {
+        const KeyEntry* entry = &normalized->entries[k];
+        PyObject* value = NULL;
+        Py_BEGIN_CRITICAL_SECTION(self);
+        Py_ssize_t slot = cnd_find(dict, entry->key, entry->hash);
+        if (slot >= 0) {
+            value = dict->entries[dict->slots[slot]].value;
+            Py_INCREF(value);
+        }
+        Py_END_CRITICAL_SECTION();
+        // Values are compared unlocked, since __eq__ may change self
+        equal = value ? PyObject_RichCompareBool(value, entry->value, Py_EQ) : 0;
+        Py_XDECREF(value);
+    }
+    Py_DECREF(normalized);
+    return equal;
+}
+
+// == and != with any Mapping, matching keys in any spelling
+static PyObject* cnd_richcompare(PyObject* self, PyObject* other, int op) {
+    if (op != Py_EQ && op != Py_NE) { Py_RETURN_NOTIMPLEMENTED; }
+    int is_mapping = PyDict_Check(other) || PyObject_TypeCheck(other, cnd_base_type(self));
+    if (!is_mapping) {
+        PyObject* mapping = cnd_abc(self, "Mapping");
+        is_mapping = mapping ? PyObject_IsInstance(other, mapping) : -1;
+        Py_XDECREF(mapping);
+        if (is_mapping < 0) { return NULL; }
+    }
+    if (!is_mapping) { Py_RETURN_NOTIMPLEMENTED; }
+    int equal = cnd_equal(self, other);
+    if (equal < 0) { return NULL; }
+    return PyBool_FromLong(equal == (op == Py_EQ));
+}
+
+static PyMethodDef cnd_methods[] = {
+    {"get", (PyCFunction)(void(*)(void))cnd_get, METH_FASTCALL,
+     "get(key, default=None)\nThe value for any spelling of key, or default."},
+    {"pop", (PyCFunction)(void(*)(void))cnd_pop, METH_FASTCALL,
+     "pop(key[, default])\nRemove key and return its value, or default if given."},
+    {"setdefault", (PyCFunction)(void(*)(void))cnd_setdefault, METH_FASTCALL,
+     "setdefault(key, default=None)\nThe value for key, first inserting default if it is missing."},
+    {"update", (PyCFunction)(void(*)(void))cnd_update, METH_VARARGS | METH_KEYWORDS,
+     "update([other], **kwargs)\nAdd the items of a mapping or iterable of pairs, then kwargs."},
+    {"keys", cnd_keys, METH_NOARGS, "View of the keys as first inserted."},
+    {"values", cnd_values, METH_NOARGS, "View of the values."},
+    {"items", cnd_items, METH_NOARGS, "View of the (key, value) pairs."},
+    {"popitem", cnd_popitem, METH_NOARGS, "Remove and return the last inserted (key, value) pair."},
+    {"clear", cnd_clear_method, METH_NOARGS, "Remove every item."},
+    {"copy", cnd_copy, METH_NOARGS, "Shallow copy."},
+    {NULL, NULL, 0, NULL} // Sentinel
+};
+
+static PyType_Slot cnd_slots[] = {
+    {Py_tp_doc, "CaseNormalizedDict([mapping_or_pairs], **kwargs)\n"
+                "A dict whose str keys match whatever case they are spelled in:\n"
+                "'userId', 'user_id', 'USER-ID' and 'User Id' are the same key."},
+    {Py_tp_new, cnd_new},
+    {Py_tp_init, cnd_init},
+    {Py_tp_dealloc, cnd_dealloc},
+    {Py_tp_traverse, cnd_traverse},
+    {Py_tp_clear, cnd_clear},
+    {Py_tp_repr, cnd_repr},
+    {Py_tp_richcompare, cnd_richcompare},
+    {Py_tp_iter, cnd_iter},
+    {Py_mp_length, cnd_length},
+    {Py_mp_subscript, cnd_subscript},
+    {Py_mp_ass_subscript, cnd_ass_subscript},
+    {Py_sq_contains, cnd_contains},
+    {Py_tp_methods, cnd_methods},
+    {0, NULL} // Sentinel
+};
+
+static PyType_Spec cnd_spec = {
+    .name = "fast_stringcase.CaseNormalizedDict",
+    .basicsize = sizeof(CaseNormalizedDictObject),
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE | Py_TPFLAGS_HAVE_GC,
+    .slots = cnd_slots,
+};
+
+
+// --- Streams ---
+//
+// StreamConverter(case, delimiter=b"\n") converts delimiter-separated
+// records that arrive in chunks of any size. Every complete record in a
+// chunk is converted straight from the caller's buffer, in one pass, into a
+// working buffer that is reused from chunk to chunk; only the unfinished
+// record at the end of a chunk is copied, and it is completed by the next
+// feed(). Memory use is bounded by the chunk size and the longest record,
+// however long the stream. Records are UTF-8 text: ASCII records go
+// through the ASCII kernels, and the rest through the Unicode ones.
+
+// Chunks of at least this many bytes are converted with the GIL released
+#define STREAM_NOGIL_BYTES (1 << 16)
+
+#define UTF8_INVALID (-1)    // convert_utf8: not valid UTF-8
+#define UTF8_NO_MEMORY (-2)  // convert_utf8: code_points could not grow
+
+// Convert one UTF-8 record with spec into `out`, which needs UTF8_MAX_OUT
+// bytes per input byte plus one, or two per byte plus one for ASCII.
+// Non-ASCII records are decoded into `code_points`, grown as needed. Needs
+// no Python state. Returns the bytes written or a UTF8_ code.
+static Py_ssize_t convert_utf8(const CaseSpec* spec, const char* record, Py_ssize_t len, char* out,
+                               ScratchBuffer* code_points) {
+    if (utf8_is_ascii(record, len)) { return spec->kernel(record, len, out); }
+    if (len > PY_SSIZE_T_MAX / (1 + UK_MAX_OUT) / (Py_ssize_t)sizeof(uint32_t)
+        || !scratch_grow(code_points, (1 + UK_MAX_OUT) * len * (Py_ssize_t)sizeof(uint32_t))) {
+        return UTF8_NO_MEMORY;
+    }
+    Py_ssize_t written = utf8_convert(spec->unicode_kernels[2], record, len, (uint32_t*)code_points->data, out);
+    return written < 0 ? UTF8_INVALID : written;
+}
+
+// Raise the error for a negative convert_utf8 result
+static void utf8_error(Py_ssize_t code, const char* func_name) {
+    if (code == UTF8_INVALID) {
+        PyErr_Format(PyExc_ValueError, "%s got a record that is not valid UTF-8", func_name);
+    } else {
+        PyErr_Format(PyExc_MemoryError, "Failed to allocate memory for %s", func_name);
+    }
+}
+
+typedef struct {
+    PyObject_HEAD
+    const CaseSpec* spec;
+    PyObject* delimiter;     // Non-empty bytes
+    ScratchBuffer carry;     // Start of a record still missing its delimiter
+    Py_ssize_t carry_len;
+    ScratchBuffer out;       // Converted records of the current chunk
+    ScratchBuffer code_points; // Decoded non-ASCII records
+    int busy;                // A feed() is converting with the GIL released
+} StreamConverterObject;
+
+// Offset of the first delimiter in string[start:len], or -1
+static Py_ssize_t stream_find(const char* string, Py_ssize_t start, Py_ssize_t len,
+                              const char* delimiter, Py_ssize_t delimiter_len) {
+    while (len - start >= delimiter_len) {
+        const char* found = (const char*)memchr(string + start, delimiter[0], (size_t)(len - start - delimiter_len + 1));
+        if (!found) { return -1; }
+        start = found - string;
+        if (memcmp(found + 1, delimiter + 1, (size_t)delimiter_len - 1) == 0) { return start; }
+        start++;
+    }
+    return -1;
+}
+
+// Converts the records of string[start:len] that end in a delimiter, after
+// `first` (the completed carried record), into `out`, which needs room for
+// convert_utf8's bound on the whole input. `ascii` is 1 when all of the
+// input is known to be ASCII. Returns bytes written and sets *tail to the
+// start of the unfinished record, or returns a UTF8_ code. Needs no Python
+// state.
+static Py_ssize_t stream_convert(const CaseSpec* spec, const char* delimiter, Py_ssize_t delimiter_len,
+                                 const char* first, Py_ssize_t first_len,
+                                 const char* string, Py_ssize_t start, Py_ssize_t len, int ascii,
+                                 char* out, ScratchBuffer* code_points, Py_ssize_t* tail, Py_ssize_t* records) {
+    // The kernel's spare byte lands where the delimiter is copied next
+    Py_ssize_t written = ascii ? spec->kernel(first, first_len, out)
+                               : convert_utf8(spec, first, first_len, out, code_points);
+    if (written < 0) { return written; }
+    memcpy(out + written, delimiter, delimiter_len);
+    written += delimiter_len;
+    *records = 1;
+    Py_ssize_t end;
+    while ((end = stream_find(string, start, len, delimiter, delimiter_len)) >= 0) {
+        Py_ssize_t record_len = ascii ? spec->kernel(string + start, end - start, out + written)
+                                      : convert_utf8(spec, string + start, end - start, out + written, code_points);
+        if (record_len < 0) { return record_len; }
+        written += record_len;
+        memcpy(out + written, delimiter, delimiter_len);
+        written += delimiter_len;
+        ++*records;
+        start = end + delimiter_len;
+    }
+    *tail = start;
+    return written;
+}
+
+static int stream_carry(StreamConverterObject* stream, const char* data, Py_ssize_t len) {
+    if (!scratch_reserve(&stream->carry, stream->carry_len + len + 1, "StreamConverter")) { return 0; }
+    memcpy(stream->carry.data + stream->carry_len, data, len);
+    stream->carry_len += len;
+    return 1;
+}
+
+// feed() with the stream locked
+static PyObject* stream_feed_locked(PyObject* self, PyObject* chunk) {
+    StreamConverterObject* stream = (StreamConverterObject*)self;
+    const CaseSpec* spec = stream->spec;
+    int64_t stats_start = stats_begin();
+    if (stream->busy) {
+        PyErr_SetString(PyExc_RuntimeError, "StreamConverter.feed() is already running in another thread");
+        return NULL;
+    }
+    Py_buffer view;
+    if (PyObject_GetBuffer(chunk, &view, PyBUF_SIMPLE) < 0) { return NULL; }
+    const char* string = (const char*)view.buf;
+    Py_ssize_t len = view.len;
+    const char* delimiter = PyBytes_AS_STRING(stream->delimiter);
+    Py_ssize_t delimiter_len = PyBytes_GET_SIZE(stream->delimiter);
+    PyObject* py_result = NULL;
+    Py_ssize_t tail, records, result_len;
+    // Restored if a record fails to convert, so the stream is unchanged
+    Py_ssize_t carry_len = stream->carry_len;
+
+    // Complete the carried record, whose delimiter may begin in the carry
+    Py_ssize_t start = -1;
+    for (Py_ssize_t k = delimiter_len - 1; k > 0 && start < 0; --k) {
+        if (stream->carry_len >= k && len >= delimiter_len - k
+            && memcmp(stream->carry.data + stream->carry_len - k, delimiter, k) == 0
+            && memcmp(string, delimiter + k, delimiter_len - k) == 0) {
+            stream->carry_len -= k;
+            start = delimiter_len - k;
+        }
+    }
+    if (start < 0) {
+        Py_ssize_t end = stream_find(string, 0, len, delimiter, delimiter_len);
+        if (!stream_carry(stream, string, end < 0 ? len : end)) { goto done; }
+        if (end < 0) {
+            py_result = PyBytes_FromStringAndSize(NULL, 0);
+            goto done;
+        }
+        start = end + delimiter_len;
+    }
+
+    // No kernel writes more than two bytes per ASCII byte
+    int ascii = utf8_is_ascii(stream->carry.data, stream->carry_len) && utf8_is_ascii(string, len);
+    Py_ssize_t max_out = ascii ? 2 : UTF8_MAX_OUT;
+    if (stream->carry_len > (PY_SSIZE_T_MAX - 1) / max_out - len
+        || !scratch_reserve(&stream->out, max_out * (stream->carry_len + len) + 1, "StreamConverter")) {
+        stream->carry_len = carry_len;
+        goto done;
+    }
+    int release_gil = len >= STREAM_NOGIL_BYTES;
+    stream->busy = 1;
+    PyThreadState* thread_state = release_gil ? PyEval_SaveThread() : NULL;
+    result_len = stream_convert(spec, delimiter, delimiter_len, stream->carry.data, stream->carry_len,
+                                string, start, len, ascii, stream->out.data, &stream->code_points, &tail, &records);
+    if (thread_state) { PyEval_RestoreThread(thread_state); }
+    if (result_len < 0) {
+        utf8_error(result_len, "StreamConverter");
+        stream->carry_len = carry_len;
+    } else if ((py_result = PyBytes_FromStringAndSize(stream->out.data, result_len)) != NULL) {
+        if (stats_enabled) {
+            stats_convert(spec->stats, records, stream->carry_len + delimiter_len + tail - start, result_len, 1);
+        }
+        stream->carry_len = 0;
+        if (!stream_carry(stream, string + tail, len - tail)) { Py_CLEAR(py_result); }
+    }
+    stream->busy = 0;
+
+done:
+    PyBuffer_Release(&view);
+    stats_end(spec->stats, stats_start);
+    return py_result;
+}
+
+// feed(chunk) -> bytes of every record the chunk completes. The stream stays
+// locked until the GIL is released for a large chunk; from then on `busy`
+// turns other callers away.
+static PyObject* stream_feed(PyObject* self, PyObject* chunk) {
+    PyObject* py_result;
+    Py_BEGIN_CRITICAL_SECTION(self);
+    py_result = stream_feed_locked(self, chunk);
+    Py_END_CRITICAL_SECTION();
+    return py_result;
+}
+
+// flush() with the stream locked
+static PyObject* stream_flush_locked(PyObject* self) {
+    StreamConverterObject* stream = (StreamConverterObject*)self;
+    const CaseSpec* spec = stream->spec;
+    if (stream->busy) {
+        PyErr_SetString(PyExc_RuntimeError, "StreamConverter.feed() is already running in another thread");
+        return NULL;
+    }
+    int64_t stats_start = stats_begin();
+    const char* string = stream->carry.data;
+    Py_ssize_t len = stream->carry_len;
+    PyObject* py_result = NULL;
+    if (utf8_is_ascii(string, len)) {
+        Py_ssize_t result_len = len ? spec->measure(string, len) : 0;
+        py_result = PyBytes_FromStringAndSize(NULL, result_len);
+        if (py_result && len) {
+            char* result_data = PyBytes_AS_STRING(py_result);
+            result_data[spec->kernel(string, len, result_data)] = '\0';
+        }
+    } else if (len <= (PY_SSIZE_T_MAX - 1) / UTF8_MAX_OUT
+               && scratch_reserve(&stream->out, UTF8_MAX_OUT * len + 1, "StreamConverter")) {
+        Py_ssize_t result_len = convert_utf8(spec, string, len, stream->out.data, &stream->code_points);
+        if (result_len < 0) {
+            utf8_error(result_len, "StreamConverter");
+        } else {
+            py_result = PyBytes_FromStringAndSize(stream->out.data, result_len);
+        }
+    } else if (!PyErr_Occurred()) {
+        PyErr_NoMemory();
+    }
+    if (py_result && len && stats_enabled) { stats_convert(spec->stats, 1, len, PyBytes_GET_SIZE(py_result), 1); }
+    if (py_result) { stream->carry_len = 0; }
+    stats_end(spec->stats, stats_start);
+    return py_result;
+}
+
+// flush() -> bytes of the last record, which has no delimiter after it
+static PyObject* stream_flush(PyObject* self, PyObject* unused) {
+    PyObject* py_result;
+    Py_BEGIN_CRITICAL_SECTION(self);
+    py_result = stream_flush_locked(self);
+    Py_END_CRITICAL_SECTION();
+    return py_result;
+}
+
+static PyObject* stream_new(PyTypeObject* type, PyObject* args, PyObject* kwargs) {
+    static char* kwlist[] = {"case", "delimiter", NULL};
+    const char* case_name;
+    PyObject* delimiter = NULL;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s|S:StreamConverter", kwlist, &case_name, &delimiter)) {
+        return NULL;
+    }
+    const CaseSpec* spec = find_case(case_name);
+    if (!spec) { return NULL; }
+    if (delimiter && PyBytes_GET_SIZE(delimiter) == 0) {
+        PyErr_SetString(PyExc_ValueError, "StreamConverter delimiter must not be empty");
+        return NULL;
+    }
+    StreamConverterObject* stream = (StreamConverterObject*)type->tp_alloc(type, 0);
+    if (!stream) { return NULL; }
+    stream->spec = spec;
+    if (delimiter) { Py_INCREF(delimiter); }
+    stream->delimiter = delimiter ? delimiter : PyBytes_FromStringAndSize("\n", 1);
+    if (!stream->delimiter) {
+        Py_DECREF(stream);
+        return NULL;
+    }
+    return (PyObject*)stream;
+}
+
+static void stream_dealloc(PyObject* self) {
+    StreamConverterObject* stream = (StreamConverterObject*)self;
+    scratch_free(&stream->carry);
+    scratch_free(&stream->out);
+    scratch_free(&stream->code_points);
+    Py_XDECREF(stream->delimiter);
+    PyTypeObject* type = Py_TYPE(self);
+    type->tp_free(self);
+    Py_DECREF(type);
+}
+
+static PyObject* stream_repr(PyObject* self) {
+    const StreamConverterObject* stream = (const StreamConverterObject*)self;
+    return PyUnicode_FromFormat("StreamConverter('%s', delimiter=%R)", stream->spec->name, stream->delimiter);
+}
+
+static PyObject* stream_get_pending(PyObject* self, void* closure) {
+    return PyLong_FromSsize_t(((StreamConverterObject*)self)->carry_len);
+}
+
+static PyMethodDef stream_methods[] = {
+    {"feed", stream_feed, METH_O,
+     "feed(chunk)\nConvert the records a bytes-like chunk completes, returning them with their delimiters."},
+    {"flush", stream_flush, METH_NOARGS,
+     "Convert and return the last record, which no delimiter ended, and start over."},
+    {NULL, NULL, 0, NULL} // Sentinel
+};
+
+static PyGetSetDef stream_getset[] = {
+    {"pending", stream_get_pending, NULL, "Bytes of the unfinished record held for the next feed().", NULL},
+    {NULL, NULL, NULL, NULL, NULL} // Sentinel
+};
+
+static PyType_Slot stream_slots[] = {
+    {Py_tp_doc, "StreamConverter(case, delimiter=b'\\n')\n"
+                "Convert a stream of delimiter-separated records fed in chunks of any size."},
+    {Py_tp_new, stream_new},
+    {Py_tp_dealloc, stream_dealloc},
+    {Py_tp_repr, stream_repr},
+    {Py_tp_methods, stream_methods},
+    {Py_tp_getset, stream_getset},
+    {0, NULL} // Sentinel
+};
+
+static PyType_Spec stream_spec = {
+    .name = "fast_stringcase.StreamConverter",
+    .basicsize = sizeof(StreamConverterObject),
+    .flags = Py_TPFLAGS_DEFAULT,
+    .slots = stream_slots,
+};
+
+
+// --- Files ---
+//
+// convert_file(src, dst, case) converts a delimiter-separated file, or one
+// field of every record, without bringing it into Python. The input is
+// memory-mapped and cut into chunks that end on a delimiter. Rounds of
+// chunks are converted on native threads with the GIL released, each into
+// its own buffer, and the calling thread writes one round's buffers to the
+// output, in order, while the next round converts. Records are UTF-8 text,
+// converted as StreamConverter converts them.
+
+// Input bytes per chunk; a record longer than this makes a longer chunk
+#define FILE_CHUNK_BYTES (1 << 20)
+// Chunks per round and converting thread, and at most per round
+#define FILE_ROUND_CHUNKS_PER_THREAD 2
+#define FILE_ROUND_MAX_CHUNKS 64
+
+typedef struct {
+    const char* start;    // Whole records; the last ends in a delimiter unless it ends the file
+    Py_ssize_t len;
+    char* out;            // Converted records, reused from round to round
+    Py_ssize_t out_size;
+    Py_ssize_t out_len;
+    Py_ssize_t records;
+    ScratchBuffer code_points; // For convert_utf8, reused like out
+    const char* invalid;  // Record that is not valid UTF-8, or NULL
+} FileChunk;
+
+typedef struct {
+    const CaseSpec* spec;
+    char delimiter;
+    char field_delimiter;
+    Py_ssize_t field;     // 1-based field to convert, or 0 for whole records
+    FileChunk* chunks;    // Of the round being converted
+    volatile int failed;  // A buffer could not be allocated
+} FileJob;
+
+// Convert one record, without its delimiter, into out and return the bytes
+// written, or a UTF8_ code. The \r of a CRLF line ending is kept, as is a
+// record with fewer fields than job->field. `ascii` is 1 when the whole
+// chunk is ASCII.
+static Py_ssize_t file_convert_record(const FileJob* job, const char* record, Py_ssize_t len, int ascii,
+                                      ScratchBuffer* code_points, char* out) {
+    Py_ssize_t end = len;
+    if (job->delimiter == '\n' && end > 0 && record[end - 1] == '\r') { end--; }
+    Py_ssize_t field_start = 0;
+    Py_ssize_t field_end = end;
+    if (job->field) {
+        for (Py_ssize_t i = 1; i < job->field; ++i) {
+            const char* next = (const char*)memchr(record + field_start, job->field_delimiter, (size_t)(end - field_start));
+            if (!next) {
+                memcpy(out, record, len);
+                return len;
+            }
+            field_start = next + 1 - record;
+        }
+        const char* next = (const char*)memchr(record + field_start, job->field_delimiter, (size_t)(end - field_start));
+        if (next) { field_end = next - record; }
+    }
+    memcpy(out, record, field_start);
+    // The kernel's spare byte is overwritten by the rest of the record or
+    // the delimiter, or is the spare byte of the chunk's buffer
+    const char* field = record + field_start;
+    Py_ssize_t field_len = ascii ? job->spec->kernel(field, field_end - field_start, out + field_start)
+                                 : convert_utf8(job->spec, field, field_end - field_start, out + field_start, code_points);
+    if (field_len < 0) { return field_len; }
+    Py_ssize_t written = field_start + field_len;
+    memcpy(out + written, record + field_end, len - field_end);
+    return written + len - field_end;
+}
+
+// parallel_task converting chunks [first, last) of the round
+static void file_convert_chunks(void* arg, Py_ssize_t first, Py_ssize_t last) {
+    FileJob* job = (FileJob*)arg;
+    for (Py_ssize_t c = first; c < last; ++c) {
+        FileChunk* chunk = &job->chunks[c];
+        chunk->out_len = chunk->records = 0;
+        chunk->invalid = NULL;
+        // No kernel writes more than two bytes per ASCII byte, plus its spare byte
+        int ascii = utf8_is_ascii(chunk->start, chunk->len);
+        Py_ssize_t max_out = ascii ? 2 : UTF8_MAX_OUT;
+        if (chunk->len > (PY_SSIZE_T_MAX - 1) / max_out) {
+            job->failed = 1;
+            continue;
+        }
+        if (chunk->out_size < max_out * chunk->len + 1) {
+            char* out = (char*)realloc(chunk->out, max_out * chunk->len + 1);
+            if (!out) {
+                job->failed = 1;
+                continue;
+            }
+            chunk->out = out;
+            chunk->out_size = max_out * chunk->len + 1;
+        }
+
+        const char* p = chunk->start;
+        const char* end = p + chunk->len;
+        Py_ssize_t written = 0;
+        while (p < end) {
+            const char* stop = (const char*)memchr(p, job->delimiter, (size_t)(end - p));
+            Py_ssize_t record_len = file_convert_record(job, p, (stop ? stop : end) - p, ascii, &chunk->code_points,
+                                                        chunk->out + written);
+            if (record_len < 0) {
+                if (record_len == UTF8_INVALID) { chunk->invalid = p; } else { job->failed = 1; }
+                break;
+            }
+            written += record_len;
+            chunk->records++;
+            if (!stop) { break; }
+            chunk->out[written++] = job->delimiter;
+            p = stop + 1;
+        }
+        chunk->out_len = written;
+        if (stats_enabled) { stats_convert(job->spec->stats, chunk->records, chunk->len, written, 0); }
+    }
+}
+
+// Cut up to max chunks of whole records from [*next, end), moving *next
+// past them. Only the bytes around each chunk boundary are read.
+static Py_ssize_t file_cut(const char** next, const char* end, char delimiter, FileChunk* chunks, Py_ssize_t max) {
+    Py_ssize_t count = 0;
+    while (count < max && *next < end) {
+        const char* start = *next;
+        const char* stop = end;
+        if (end - start > FILE_CHUNK_BYTES) {
+            const char* found = (const char*)memchr(start + FILE_CHUNK_BYTES - 1, delimiter,
+                                                    (size_t)(end - start - FILE_CHUNK_BYTES + 1));
+            if (found) { stop = found + 1; }
+        }
+        chunks[count].start = start;
+        chunks[count].len = stop - start;
+        count++;
+        *next = stop;
+    }
+    return count;
+}
+
+// convert_file(src, dst, case, *, field=None, delimiter=b"\n", field_delimiter=b",", threads=None)
+static PyObject* convert_file(PyObject* self, PyObject* args, PyObject* kwargs) {
+    static char* kwlist[] = {"src", "dst", "case", "field", "delimiter", "field_delimiter", "threads", NULL};
+    PyObject* src = NULL;
+    PyObject* dst = NULL;
+    const char* case_name;
+    PyObject* py_field = Py_None;
+    PyObject* py_threads = Py_None;
+    FileJob job = {NULL, '\n', ',', 0, NULL, 0};
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&O&s|$OccO:convert_file", kwlist,
+                                     MAPPED_PATH_CONVERTER, &src, MAPPED_PATH_CONVERTER, &dst, &case_name,
+                                     &py_field, &job.delimiter, &job.field_delimiter, &py_threads)) {
+        return NULL;
+    }
+    PyObject* result = NULL;
+    long threads = 1;
+    if (!(job.spec = find_case(case_name))) { goto done; }
+    if (py_field != Py_None) {
+        job.field = PyLong_AsSsize_t(py_field);
+        if (job.field == -1 && PyErr_Occurred()) { goto done; }
+        if (job.field < 1) {
+            PyErr_SetString(PyExc_ValueError, "field must be at least 1");
+            goto done;
+        }
+    }
+    if (py_threads != Py_None) {
+        threads = PyLong_AsLong(py_threads);
+        if (threads == -1 && PyErr_Occurred()) { goto done; }
+        if (threads < 1) {
+            PyErr_SetString(PyExc_ValueError, "threads must be at least 1");
+            goto done;
+        }
+        if (threads > PARALLEL_MAX_THREADS - 1) { threads = PARALLEL_MAX_THREADS - 1; }
+    }
+    if (job.field && job.field_delimiter == job.delimiter) {
+        PyErr_SetString(PyExc_ValueError, "field_delimiter must differ from delimiter");
+        goto done;
+    }
+
+    MappedFile input;
+    OutputFile output;
+    if (mapped_open(&input, src) < 0) { goto done; }
+    if (output_open(&output, dst, &input) < 0) {
+        mapped_close(&input);
+        goto done;
+    }
+    Py_ssize_t round_chunks = FILE_ROUND_CHUNKS_PER_THREAD * threads;
+    if (round_chunks > FILE_ROUND_MAX_CHUNKS) { round_chunks = FILE_ROUND_MAX_CHUNKS; }
+    // Two rounds: one converting while the other is written
+    FileChunk* chunks = (FileChunk*)PyMem_Calloc(2 * round_chunks, sizeof(FileChunk));
+    if (!chunks) {
+        PyErr_NoMemory();
+        output_close(&output);
+        mapped_close(&input);
+        goto done;
+    }
+
+    int64_t stats_start = stats_begin();
+    Py_ssize_t records = 0;
+    const FileChunk* invalid = NULL;  // Holds the first record that is not UTF-8
+    ParallelPool* pool = &get_module_state(self)->pool;
+    Py_BEGIN_ALLOW_THREADS
+    const char* next = input.data;
+    const char* end = input.data + input.size;
+    FileChunk* writing = chunks + round_chunks;
+    Py_ssize_t writing_count = 0;
+    for (;;) {
+        job.chunks = chunks == writing ? chunks + round_chunks : chunks;
+        Py_ssize_t count = job.failed || invalid || output.error
+                           ? 0 : file_cut(&next, end, job.delimiter, job.chunks, round_chunks);
+        // `threads` helpers convert while this thread writes, then it joins them
+        ParallelGroup group;
+        if (count) { parallel_start(pool, &group, count, 1, (int)threads + 1, file_convert_chunks, &job); }
+        for (Py_ssize_t i = 0; i < writing_count && !output.error; ++i) {
+            output_write(&output, writing[i].out, writing[i].out_len);
+            records += writing[i].records;
+        }
+        if (!count) { break; }
+        parallel_join(&group);
+        writing = job.chunks;
+        // Only the chunks before an invalid record are written
+        for (writing_count = 0; writing_count < count && !job.chunks[writing_count].invalid; ++writing_count) {}
+        if (writing_count < count) { invalid = &job.chunks[writing_count]; }
+    }
+    Py_END_ALLOW_THREADS
+    stats_end(job.spec->stats, stats_start);
+    // 1-based, counting the records written before it
+    Py_ssize_t invalid_record = invalid ? records + invalid->records + 1 : 0;
+
+    for (Py_ssize_t i = 0; i < 2 * round_chunks; ++i) {
+        free(chunks[i].out);
+        scratch_free(&chunks[i].code_points);
+    }
+    PyMem_Free(chunks);
+    mapped_close(&input);
+    if (output_close(&output) < 0) {
+        output_error(&output, dst);
+    } else if (job.failed) {
+        PyErr_NoMemory();
+    } else if (invalid_record) {
+        PyErr_Format(PyExc_ValueError, "convert_file() got invalid UTF-8 in record %zd", invalid_record);
+    } else {
+        result = PyLong_FromSsize_t(records);
+    }
+
+done:
+    Py_XDECREF(src);
+    Py_XDECREF(dst);
+    return result;
+}
+
+
+// --- Arrow Arrays ---
+//
+// convert_arrow(array, case) converts an Arrow string or large_string array
+// received through the Arrow PyCapsule interface (__arrow_c_array__). The
+// kernels run row by row over the array's UTF-8 data buffer with the GIL
+// released, so no Python object is created per row. The result is an
+// ArrowStringArray, which pyarrow, polars and other consumers import the
+// same way.
+
+// Buffers of a converted array, shared by its ArrowStringArray and every
+// ArrowArray exported from it, and freed when the last of them lets go.
+// Consumers may release an export on any thread without the GIL, so the
+// count is atomic and the buffers come from malloc.
+typedef struct {
+    volatile int64_t refcount;
+    int64_t length;
+    int64_t null_count;
+    const char* format;      // "u" (int32 offsets) or "U" (int64 offsets)
+    const void* buffers[3];  // Validity bitmap (or NULL), offsets, data
+} ArrowColumn;
+
+static void arrow_column_retain(ArrowColumn* column) {
+#if defined(_MSC_VER)
+    InterlockedIncrement64((volatile LONG64*)&column->refcount);
+#else
+    __atomic_fetch_add(&column->refcount, 1, __ATOMIC_RELAXED);
+#endif
+}
+
+static void arrow_column_release(ArrowColumn* column) {
+#if defined(_MSC_VER)
+    if (InterlockedDecrement64((volatile LONG64*)&column->refcount) != 0) { return; }
+#else
+    if (__atomic_sub_fetch(&column->refcount, 1, __ATOMIC_ACQ_REL) != 0) { return; }
+#endif
+    for (int i = 0; i < 3; ++i) {
+        free((void*)column->buffers[i]);
+    }
+    free(column);
+}
+
+static void arrow_schema_release(struct ArrowSchema* schema) {
+    schema->release = NULL;
+}
+
+static void arrow_array_release(struct ArrowArray* array) {
+    arrow_column_release((ArrowColumn*)array->private_data);
+    array->release = NULL;
+}
+
+// Capsules own their struct and release it unless a consumer moved it out
+static void arrow_schema_capsule_free(PyObject* capsule) {
+    struct ArrowSchema* schema = (struct ArrowSchema*)PyCapsule_GetPointer(capsule, "arrow_schema");
+    if (schema && schema->release) { schema->release(schema); }
+    PyMem_Free(schema);
+}
+
+static void arrow_array_capsule_free(PyObject* capsule) {
+    struct ArrowArray* array = (struct ArrowArray*)PyCapsule_GetPointer(capsule, "arrow_array");
+    if (array && array->release) { array->release(array); }
+    PyMem_Free(array);
+}
+
+#define ARROW_OK 0
+#define ARROW_NO_MEMORY 1
+#define ARROW_INVALID_UTF8 2
+#define ARROW_TOO_LARGE 3   // Result does not fit int32 offsets
+
+// Grow a malloc'd buffer to at least `needed` bytes without touching
+// Python state, for use with the GIL released. Returns 0 on failure.
+static int arrow_reserve(void** data, int64_t* capacity, int64_t needed) {
+    if (needed <= *capacity) { return 1; }
+    int64_t new_capacity = *capacity * 2 > needed ? *capacity * 2 : needed;
+    if ((uint64_t)new_capacity > SIZE_MAX) { return 0; }
+    void* new_data = realloc(*data, (size_t)new_capacity);
+    if (!new_data) { return 0; }
+    *data = new_data;
+    *capacity = new_capacity;
+    return 1;
+}
+
+// Convert every valid row of `input` into the buffers of `column`. Runs
+// without the GIL. On failure returns an ARROW_ code, with the offending
+// row in *failed_row for ARROW_INVALID_UTF8; sizes[0] and sizes[1] receive
+// the input and output data sizes.
+static int arrow_convert_rows(const CaseSpec* spec, const struct ArrowArray* input, ArrowColumn* column,
+                              int64_t* failed_row, int64_t* sizes) {
+    int large = column->format[0] == 'U';
+    int64_t length = input->length;
+    int64_t offset = input->offset;
+    const uint8_t* validity = input->null_count != 0 ? (const uint8_t*)input->buffers[0] : NULL;
+    const int32_t* offsets32 = (const int32_t*)input->buffers[1];
+    const int64_t* offsets64 = (const int64_t*)input->buffers[1];
+    const char* data = (const char*)input->buffers[2];
+    sizes[0] = sizes[1] = 0;
+
+    void* out_offsets = malloc((size_t)(length + 1) * (large ? sizeof(int64_t) : sizeof(int32_t)));
+    if (!out_offsets) { return ARROW_NO_MEMORY; }
+    column->buffers[1] = out_offsets;
+    if (validity) {
+        uint8_t* out_validity = (uint8_t*)calloc((size_t)(length + 7) / 8 + 1, 1);
+        if (!out_validity) { return ARROW_NO_MEMORY; }
+        for (int64_t i = 0; i < length; ++i) {
+            int64_t row = offset + i;
+            out_validity[i >> 3] |= (uint8_t)(((validity[row >> 3] >> (row & 7)) & 1) << (i & 7));
+        }
+        column->buffers[0] = out_validity;
+    }
+
+    int64_t first = length == 0 ? 0 : large ? offsets64[offset] : offsets32[offset];
+    int64_t last = length == 0 ? 0 : large ? offsets64[offset + length] : offsets32[offset + length];
+    sizes[0] = last - first;
+    // Most cases keep the size; the buffer grows for the rest. The kernels'
+    // spare byte always fits.
+    void* out = NULL;
+    int64_t capacity = 0;
+    if (!arrow_reserve(&out, &capacity, last - first + 1)) { return ARROW_NO_MEMORY; }
+    column->buffers[2] = out;
+    void* code_points = NULL;
+    int64_t code_points_capacity = 0;
+    int64_t out_size = 0;
+    int status = ARROW_OK;
+
+    if (large) { ((int64_t*)out_offsets)[0] = 0; } else { ((int32_t*)out_offsets)[0] = 0; }
+    for (int64_t i = 0; i < length; ++i) {
+        int64_t row = offset + i;
+        if (!validity || ((validity[row >> 3] >> (row & 7)) & 1)) {
+            int64_t start = large ? offsets64[row] : offsets32[row];
+            const char* string = data + start;
+            fsc_ssize_t len = (fsc_ssize_t)((large ? offsets64[row + 1] : offsets32[row + 1]) - start);
+            fsc_ssize_t written;
+            if (utf8_is_ascii(string, len)) {
+                // No ASCII kernel writes more than two bytes per input byte,
+                // so reserving that bound saves a measure pass per row
+                if (!arrow_reserve(&out, &capacity, out_size + 2 * (int64_t)len + 1)) {
+                    status = ARROW_NO_MEMORY;
+                    break;
+                }
+                written = spec->kernel(string, len, (char*)out + out_size);
+            } else {
+                // Decoded input, then up to UK_MAX_OUT code points out per code point in
+                if (!arrow_reserve(&code_points, &code_points_capacity,
+                                   (1 + UK_MAX_OUT) * (int64_t)len * (int64_t)sizeof(uint32_t))
+                    || !arrow_reserve(&out, &capacity, out_size + UTF8_MAX_OUT * (int64_t)len)) {
+                    status = ARROW_NO_MEMORY;
+                    break;
+                }
+                written = utf8_convert(spec->unicode_kernels[2], string, len, (uint32_t*)code_points,
+                                       (char*)out + out_size);
+                if (written < 0) {
+                    *failed_row = i;
+                    status = ARROW_INVALID_UTF8;
+                    break;
+                }
+            }
+            out_size += written;
+        }
+        if (large) {
+            ((int64_t*)out_offsets)[i + 1] = out_size;
+        } else if (out_size > INT32_MAX) {
+            status = ARROW_TOO_LARGE;
+            break;
+        } else {
+            ((int32_t*)out_offsets)[i + 1] = (int32_t)out_size;
+        }
+    }
+    column->buffers[2] = out;
+    free(code_points);
+    sizes[1] = out_size;
+    return status;
+}
+
+typedef struct {
+    PyObject_HEAD
+    ArrowColumn* column;
+} ArrowStringArrayObject;
+
+// convert_arrow(array, case)
+static PyObject* convert_arrow(PyObject* self, PyObject* args, PyObject* kwargs) {
+    static char* kwlist[] = {"array", "case", NULL};
+    PyObject* array;
+    const char* case_name;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "Os:convert_arrow", kwlist, &array, &case_name)) {
+        return NULL;
+    }
+    const CaseSpec* spec = find_case(case_name);
+    if (!spec) { return NULL; }
+
+    PyObject* export_method = PyObject_GetAttrString(array, "__arrow_c_array__");
+    if (!export_method) {
+        if (PyErr_ExceptionMatches(PyExc_AttributeError)) {
+            PyErr_Format(PyExc_TypeError, "convert_arrow() needs an Arrow array implementing __arrow_c_array__, not %.200s",
+                         Py_TYPE(array)->tp_name);
+        }
+        return NULL;
+    }
+    PyObject* capsules = PyObject_CallNoArgs(export_method);
+    Py_DECREF(export_method);
+    if (!capsules) { return NULL; }
+    if (!PyTuple_Check(capsules) || PyTuple_GET_SIZE(capsules) != 2) {
+        PyErr_SetString(PyExc_TypeError, "__arrow_c_array__ must return a (schema, array) tuple of capsules");
+        Py_DECREF(capsules);
+        return NULL;
+    }
+    const struct ArrowSchema* schema =
+        (const struct ArrowSchema*)PyCapsule_GetPointer(PyTuple_GET_ITEM(capsules, 0), "arrow_schema");
+    const struct ArrowArray* input = schema
+        ? (const struct ArrowArray*)PyCapsule_GetPointer(PyTuple_GET_ITEM(capsules, 1), "arrow_array") : NULL;
+    if (!input) {
+        Py_DECREF(capsules);
+        return NULL;
+    }
+    if (!schema->release || !input->release) {
+        PyErr_SetString(PyExc_ValueError, "convert_arrow() got an Arrow array that was already released");
+        Py_DECREF(capsules);
+        return NULL;
+    }
+    if (strcmp(schema->format, "u") != 0 && strcmp(schema->format, "U") != 0) {
+        PyErr_Format(PyExc_TypeError, "convert_arrow() needs a string or large_string array, not format '%s'",
+                     schema->format);
+        Py_DECREF(capsules);
+        return NULL;
+    }
+    if (input->n_buffers != 3 || input->length < 0 || input->offset < 0) {
+        PyErr_SetString(PyExc_ValueError, "convert_arrow() got a malformed Arrow string array");
+        Py_DECREF(capsules);
+        return NULL;
+    }
+
+    ArrowColumn* column = (ArrowColumn*)calloc(1, sizeof(ArrowColumn));
+    if (!column) {
+        Py_DECREF(capsules);
+        return PyErr_NoMemory();
+    }
+    column->refcount = 1;
+    column->length = input->length;
+    column->null_count = input->null_count;
+    column->format = schema->format[0] == 'U' ? "U" : "u";
+
+    int64_t failed_row = 0;
+    int64_t sizes[2];
+    int status;
+    Py_BEGIN_ALLOW_THREADS
+    status = arrow_convert_rows(spec, input, column, &failed_row, sizes);
+    Py_END_ALLOW_THREADS
+    Py_DECREF(capsules);  // Releases the input
+
+    if (status != ARROW_OK) {
+        arrow_column_release(column);
+        if (status == ARROW_INVALID_UTF8) {
+            PyErr_Format(PyExc_ValueError, "convert_arrow() got invalid UTF-8 in row %lld", (long long)failed_row);
+        } else if (status == ARROW_TOO_LARGE) {
+            PyErr_SetString(PyExc_OverflowError, "convert_arrow() result exceeds 2 GiB; use a large_string array");
+        } else {
+            PyErr_NoMemory();
+        }
+        return NULL;
+    }
+    if (stats_enabled) { stats_convert(spec->stats, column->length, sizes[0], sizes[1], 2 + (column->buffers[0] != NULL)); }
+
+    ArrowStringArrayObject* result = PyObject_New(ArrowStringArrayObject,
+                                                  get_module_state(self)->arrow_string_array_type);
+    if (!result) {
+        arrow_column_release(column);
+        return NULL;
+    }
+    result->column = column;
+    return (PyObject*)result;
+}
+
+// __arrow_c_array__(requested_schema=None) -> (schema capsule, array capsule)
+// Consumers may ignore a schema request they cannot honour, and so may we:
+// the array is always exported in its own format.
+static PyObject* arrow_string_array_export(PyObject* self, PyObject* args, PyObject* kwargs) {
+    static char* kwlist[] = {"requested_schema", NULL};
+    PyObject* requested_schema = Py_None;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O:__arrow_c_array__", kwlist, &requested_schema)) {
+        return NULL;
+    }
+    ArrowColumn* column = ((ArrowStringArrayObject*)self)->column;
+
+    struct ArrowSchema* schema = (struct ArrowSchema*)PyMem_Malloc(sizeof(struct ArrowSchema));
+    if (!schema) { return PyErr_NoMemory(); }
+    schema->format = column->format;
+    schema->name = "";
+    schema->metadata = NULL;
+    schema->flags = ARROW_FLAG_NULLABLE;
+    schema->n_children = 0;
+    schema->children = NULL;
+    schema->dictionary = NULL;
+    schema->release = arrow_schema_release;
+    schema->private_data = NULL;
+    PyObject* schema_capsule = PyCapsule_New(schema, "arrow_schema", arrow_schema_capsule_free);
+    if (!schema_capsule) {
+        PyMem_Free(schema);
+        return NULL;
+    }
+
+    struct ArrowArray* array = (struct ArrowArray*)PyMem_Malloc(sizeof(struct ArrowArray));
+    if (!array) {
+        Py_DECREF(schema_capsule);
+        return PyErr_NoMemory();
+    }
+    arrow_column_retain(column);
+    array->length = column->length;
+    array->null_count = column->null_count;
+    array->offset = 0;
+    array->n_buffers = 3;
+    array->n_children = 0;
+    array->buffers = column->buffers;
+    array->children = NULL;
+    array->dictionary = NULL;
+    array->release = arrow_array_release;
+    array->private_data = column;
+    PyObject* array_capsule = PyCapsule_New(array, "arrow_array", arrow_array_capsule_free);
+    if (!array_capsule) {
+        array->release(array);
+        PyMem_Free(array);
+        Py_DECREF(schema_capsule);
+        return NULL;
+    }
+
+    PyObject* result = PyTuple_New(2);
+    if (!result) {
+        Py_DECREF(schema_capsule);
+        Py_DECREF(array_capsule);
+        return NULL;
+    }
+    PyTuple_SET_ITEM(result, 0, schema_capsule);
+    PyTuple_SET_ITEM(result, 1, array_capsule);
+    return result;
+}
+
+static void arrow_string_array_dealloc(PyObject* self) {
+    PyTypeObject* type = Py_TYPE(self);
+    arrow_column_release(((ArrowStringArrayObject*)self)->column);
+    type->tp_free(self);
+    Py_DECREF(type);
+}
+
+static Py_ssize_t arrow_string_array_length(PyObject* self) {
+    return (Py_ssize_t)((ArrowStringArrayObject*)self)->column->length;
+}
+
+static PyObject* arrow_string_array_repr(PyObject* self) {
+    const ArrowColumn* column = ((ArrowStringArrayObject*)self)->column;
+    return PyUnicode_FromFormat("<ArrowStringArray %s, %lld rows>", column->format[0] == 'U' ? "large_string" : "string",
+                                (long long)column->length);
+}
+
+static PyMethodDef arrow_string_array_methods[] = {
+    {"__arrow_c_array__", (PyCFunction)(void(*)(void))arrow_string_array_export, METH_VARARGS | METH_KEYWORDS,
+     "Export the array through the Arrow PyCapsule interface."},
+    {NULL, NULL, 0, NULL} // Sentinel
+};
+
+// Instances only come from convert_arrow()
+#ifdef Py_TPFLAGS_DISALLOW_INSTANTIATION
+#define ARROW_STRING_ARRAY_FLAGS (Py_TPFLAGS_DEFAULT | Py_TPFLAGS_DISALLOW_INSTANTIATION)
+#else
+#define ARROW_STRING_ARRAY_FLAGS Py_TPFLAGS_DEFAULT  // tp_new is cleared at import
+#endif
+
+static PyType_Slot arrow_string_array_slots[] = {
+    {Py_tp_doc, "Arrow string array returned by convert_arrow(); pass it to pyarrow.array(),\n"
+                "polars.Series() or any other consumer of __arrow_c_array__."},
+    {Py_tp_dealloc, arrow_string_array_dealloc},
+    {Py_tp_repr, arrow_string_array_repr},
+    {Py_sq_length, arrow_string_array_length},
+    {Py_tp_methods, arrow_string_array_methods},
+    {0, NULL} // Sentinel
+};
+
+static PyType_Spec arrow_string_array_spec = {
+    .name = "fast_stringcase.ArrowStringArray",
+    .basicsize = sizeof(ArrowStringArrayObject),
+    .flags = ARROW_STRING_ARRAY_FLAGS,
+    .slots = arrow_string_array_slots,
+};
+
+
+// --- JSON Decoding ---
+//
+// loads(data, key_case="snake") parses JSON text and converts every object
+// key with a case kernel as it is read, so each key is built once, already
+// converted, in a single walk. Keys of plain ASCII (no escapes) are
+// converted straight from the input bytes. Each distinct raw key is
+// converted once per call: repeats are found by their raw bytes in a memo
+// table and share the first result. Values are decoded as by json.loads,
+// NaN and Infinity included, and malformed input raises
+// json.JSONDecodeError with json's messages and positions.
+
+// Distinct keys remembered per call; later new keys are converted each time
+#define JSON_MEMO_MAX 65536
+
+typedef struct {
+    const char* raw;   // Key bytes between the quotes, in the input
+    Py_ssize_t len;
+    uint64_t hash;
+    PyObject* key;     // Converted key, or NULL for an empty slot
+} JsonMemoEntry;
+
+typedef struct {
+    const char* start;     // Input, as UTF-8
+    const char* end;
+    const char* pos;
+    const CaseSpec* spec;  // NULL to keep keys as they are
+    PyObject* doc;         // The str given, for error messages; NULL for bytes
+    ScratchBuffer scratch;
+    JsonMemoEntry* memo;
+    size_t memo_mask;      // Slots - 1
+    Py_ssize_t memo_used;
+} JsonParser;
+
+// Raise json.JSONDecodeError(msg, doc, pos) for the byte at `at`
+static void json_error(JsonParser* parser, const char* msg, const char* at) {
+    PyObject* decoder = PyImport_ImportModule("json.decoder");
+    PyObject* error_type = decoder ? PyObject_GetAttrString(decoder, "JSONDecodeError") : NULL;
+    Py_XDECREF(decoder);
+    if (!error_type) { return; }
+    PyObject* doc = parser->doc;
+    if (doc) {
+        Py_INCREF(doc);
+    } else {
+        doc = PyUnicode_DecodeUTF8(parser->start, parser->end - parser->start, "replace");
+    }
+    // Character position: every byte but UTF-8 continuation bytes starts one
+    Py_ssize_t pos = 0;
+    for (const char* c = parser->start; c < at; ++c) {
+        pos += ((unsigned char)*c & 0xC0) != 0x80;
+    }
+    PyObject* error = doc ? PyObject_CallFunction(error_type, "sOn", msg, doc, pos) : NULL;
+    if (error) {
+        PyErr_SetObject(error_type, error);
+        Py_DECREF(error);
+    }
+    Py_XDECREF(doc);
+    Py_DECREF(error_type);
+}
+
+static inline const char* json_skip_space(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) { p++; }
+    return p;
+}
+
+// Length of the run of ASCII string characters from p that need no
+// attention: no quote, backslash, control character or non-ASCII byte.
+// Eight bytes are tested at a time.
+static inline Py_ssize_t json_plain_run(const char* p, const char* end) {
+    const uint64_t ones = 0x0101010101010101ull, highs = 0x8080808080808080ull;
+    const char* s = p;
+    while (end - s >= 8) {
+        uint64_t word, quote, backslash;
+        memcpy(&word, s, 8);
+        quote = word ^ (ones * '"');
+        backslash = word ^ (ones * '\\');
+        if ((((word - ones * 0x20) & ~word) | ((quote - ones) & ~quote) | ((backslash - ones) & ~backslash) | word)
+            & highs) {
+            break;
+        }
+        s += 8;
+    }
+    while (s < end) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\' || c < 0x20 || c >= 0x80) { break; }
+        s++;
+    }
+    return s - p;
+}
+
+static int json_hex4(const char* p, Py_UCS4* out) {
+    Py_UCS4 value = 0;
+    for (int i = 0; i < 4; ++i) {
+        unsigned char c = (unsigned char)p[i];
+        int digit = ascii_isdigit(c) ? c - '0' : (unsigned char)((c | 0x20) - 'a') < 6 ? (c | 0x20) - 'a' + 10 : -1;
+        if (digit < 0) { return 0; }
+        value = value * 16 + digit;
+    }
+    *out = value;
+    return 1;
+}
+
+// str for the string body raw[0:len], which holds escapes or non-ASCII text
+static PyObject* json_decode_string(JsonParser* parser, const char* raw, Py_ssize_t len, int escaped) {
+    if (!escaped) { return PyUnicode_DecodeUTF8(raw, len, "surrogatepass"); }
+    // Never more code points than bytes
+    if (len > PY_SSIZE_T_MAX / (Py_ssize_t)sizeof(Py_UCS4)) { return PyErr_NoMemory(); }
+    if (!scratch_reserve(&parser->scratch, (len ? len : 1) * (Py_ssize_t)sizeof(Py_UCS4), "loads")) { return NULL; }
+    Py_UCS4* out = (Py_UCS4*)parser->scratch.data;
+    Py_ssize_t count = 0;
+    const char* p = raw;
+    const char* end = raw + len;
+    while (p < end) {
+        const char* run = p;
+        while (p < end && *p != '\\') { p++; }
+        if (p > run) {
+            fsc_ssize_t decoded = utf8_decode(run, p - run, (uint32_t*)(out + count));
+            if (decoded < 0) {
+                // Let CPython raise, or decode lone surrogates from a str
+                PyObject* part = PyUnicode_DecodeUTF8(run, p - run, "surrogatepass");
+                if (!part) { return NULL; }
+                decoded = PyUnicode_GET_LENGTH(part);
+                PyUnicode_AsUCS4(part, out + count, decoded, 0);
+                Py_DECREF(part);
+            }
+            count += decoded;
+        }
+        if (p == end) { break; }
+        // Escapes were checked by json_scan_string
+        Py_UCS4 cp;
+        switch (p[1]) {
+        case '"': cp = '"'; break;
+        case '\\': cp = '\\'; break;
+        case '/': cp = '/'; break;
+        case 'b': cp = '\b'; break;
+        case 'f': cp = '\f'; break;
+        case 'n': cp = '\n'; break;
+        case 'r': cp = '\r'; break;
+        case 't': cp = '\t'; break;
+        case 'u':
+            if (end - p < 6 || !json_hex4(p + 2, &cp)) {
+                json_error(parser, "Invalid \\uXXXX escape", p + 1);
+                return NULL;
+            }
+            if (cp >= 0xD800 && cp <= 0xDBFF && end - p >= 12 && p[6] == '\\' && p[7] == 'u') {
+                Py_UCS4 low;
+                if (json_hex4(p + 8, &low) && low >= 0xDC00 && low <= 0xDFFF) {
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    p += 6;
+                }
+            }
+            p += 4;
+            break;
+        default:
+            json_error(parser, "Invalid \\escape", p);
+            return NULL;
+        }
+        out[count++] = cp;
+        p += 2;
+    }
+    return PyUnicode_FromKindAndData(PyUnicode_4BYTE_KIND, out, count);
+}
+
+// Scan the string whose opening quote is at parser->pos, leaving pos after
+// its closing quote. Sets *body, *len and the escaped/non-ASCII flags, or
+// returns 0 with JSONDecodeError set.
+static int json_scan_string(JsonParser* parser, const char** body, Py_ssize_t* len, int* escaped, int* ascii) {
+    const char* quote = parser->pos;
+    const char* p = quote + 1;
+    const char* end = parser->end;
+    *escaped = 0;
+    *ascii = 1;
+    for (;;) {
+        p += json_plain_run(p, end);
+        if (p == end) {
+            json_error(parser, "Unterminated string starting at", quote);
+            return 0;
+        }
+        unsigned char c = (unsigned char)*p;
+        if (c == '"') { break; }
+        if (c == '\\') {
+            // Checked here, in the order json checks them, so a bad escape
+            // is reported before anything later in the string
+            *escaped = 1;
+            if (end - p < 2) {
+                json_error(parser, "Unterminated string starting at", quote);
+                return 0;
+            }
+            Py_UCS4 cp;
+            switch (p[1]) {
+            case '"': case '\\': case '/': case 'b': case 'f': case 'n': case 'r': case 't':
+                p += 2;
+                break;
+            case 'u':
+                // json wants a character after the four digits
+                if (end - p <= 6 || !json_hex4(p + 2, &cp)) {
+                    json_error(parser, "Invalid \\uXXXX escape", p + 1);
+                    return 0;
+                }
+                p += 6;
+                break;
+            default:
+                json_error(parser, "Invalid \\escape", p);
+                return 0;
+            }
+        } else if (c < 0x20) {
+            json_error(parser, "Invalid control character at", p);
+            return 0;
+        } else {
+            *ascii = 0;
+            p++;
+        }
+    }
+    *body = quote + 1;
+    *len = p - *body;
+    parser->pos = p + 1;
+    return 1;
+}
+
+static PyObject* json_string(JsonParser* parser) {
+    const char* body;
+    Py_ssize_t len;
+    int escaped, ascii;
+    if (!json_scan_string(parser, &body, &len, &escaped, &ascii)) { return NULL; }
+    if (escaped || !ascii) { return json_decode_string(parser, body, len, escaped); }
+    PyObject* result = PyUnicode_New(len, 127);
+    if (result) { memcpy(PyUnicode_1BYTE_DATA(result), body, len); }
+    return result;
+}
+
+static inline uint64_t json_key_hash(const char* raw, Py_ssize_t len) {
+    uint64_t hash = 14695981039346656037ull;
+    for (Py_ssize_t i = 0; i < len; ++i) {
+        hash = (hash ^ (unsigned char)raw[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+// The converted key for a raw key that is not in the memo
+static PyObject* json_make_key(JsonParser* parser, const char* raw, Py_ssize_t len, int escaped, int ascii) {
+    const CaseSpec* spec = parser->spec;
+    if (escaped || !ascii) {
+        PyObject* decoded = json_decode_string(parser, raw, len, escaped);
+        if (!decoded || !spec) { return decoded; }
+        PyObject* key = convert_string(spec, decoded, &parser->scratch);
+        Py_DECREF(decoded);
+        return key;
+    }
+    if (!spec || spec->is_normalized(raw, len)) {
+        PyObject* key = PyUnicode_New(len, 127);
+        if (key) { memcpy(PyUnicode_1BYTE_DATA(key), raw, len); }
+        if (key && spec && stats_enabled) { stats_convert(spec->stats, 1, len, len, 1); }
+        return key;
+    }
+    Py_ssize_t result_len = spec->measure(raw, len);
+    PyObject* key = PyUnicode_New(result_len, 127);
+    if (!key) { return NULL; }
+    char* key_data = (char*)PyUnicode_1BYTE_DATA(key);
+    key_data[spec->kernel(raw, len, key_data)] = '\0';
+    if (stats_enabled) { stats_convert(spec->stats, 1, len, result_len, 1); }
+    return key;
+}
+
+// Double the memo table, or create it
+static int json_memo_grow(JsonParser* parser) {
+    size_t slots = parser->memo ? 2 * (parser->memo_mask + 1) : 256;
+    JsonMemoEntry* memo = PyMem_Calloc(slots, sizeof(JsonMemoEntry));
+    if (!memo) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    for (size_t i = 0; parser->memo && i <= parser->memo_mask; ++i) {
+        const JsonMemoEntry* entry = &parser->memo[i];
+        if (!entry->key) { continue; }
+        size_t slot = (size_t)entry->hash & (slots - 1);
+        while (memo[slot].key) { slot = (slot + 1) & (slots - 1); }
+        memo[slot] = *entry;
+    }
+    PyMem_Free(parser->memo);
+    parser->memo = memo;
+    parser->memo_mask = slots - 1;
+    return 0;
+}
+
+static PyObject* json_key(JsonParser* parser) {
+    const char* raw;
+    Py_ssize_t len;
+    int escaped, ascii;
+    if (!json_scan_string(parser, &raw, &len, &escaped, &ascii)) { return NULL; }
+    uint64_t hash = json_key_hash(raw, len);
+    size_t slot = 0;
+    if (parser->memo) {
+        for (slot = (size_t)hash & parser->memo_mask; parser->memo[slot].key; slot = (slot + 1) & parser->memo_mask) {
+            const JsonMemoEntry* entry = &parser->memo[slot];
+            if (entry->hash == hash && entry->len == len && memcmp(entry->raw, raw, len) == 0) {
+                if (parser->spec && stats_enabled) { stats_add(&parser->spec->stats->cache_hits, 1); }
+                Py_INCREF(entry->key);
+                return entry->key;
+            }
+        }
+    }
+
+    PyObject* key = json_make_key(parser, raw, len, escaped, ascii);
+    if (!key || parser->memo_used >= JSON_MEMO_MAX) { return key; }
+    if (!parser->memo || (size_t)(parser->memo_used + 1) * 3 > (parser->memo_mask + 1) * 2) {
+        if (json_memo_grow(parser) < 0) {
+            Py_DECREF(key);
+            return NULL;
+        }
+        for (slot = (size_t)hash & parser->memo_mask; parser->memo[slot].key; slot = (slot + 1) & parser->memo_mask) {}
+    }
+    JsonMemoEntry* entry = &parser->memo[slot];
+    entry->raw = raw;
+    entry->len = len;
+    entry->hash = hash;
+    entry->key = key;
+    Py_INCREF(key);
+    parser->memo_used++;
+    return key;
+}
+
+static PyObject* json_number(JsonParser* parser) {
+    const char* start = parser->pos;
+    const char* p = start;
+    const char* end = parser->end;
+    int is_float = 0;
+    if (*p == '-') { p++; }
+    if (p < end && *p == '0') {
+        p++;
+    } else if (p < end && ascii_isdigit((unsigned char)*p)) {
+        while (p < end && ascii_isdigit((unsigned char)*p)) { p++; }
+    } else {
+        if (end - p >= 8 && memcmp(p, "Infinity", 8) == 0) {
+            parser->pos = p + 8;
+            return PyFloat_FromDouble(-Py_HUGE_VAL);
+        }
+        json_error(parser, "Expecting value", start);
+        return NULL;
+    }
+    if (end - p >= 2 && *p == '.' && ascii_isdigit((unsigned char)p[1])) {
+        is_float = 1;
+        p += 2;
+        while (p < end && ascii_isdigit((unsigned char)*p)) { p++; }
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        const char* exponent = p + 1;
+        if (exponent < end && (*exponent == '+' || *exponent == '-')) { exponent++; }
+        if (exponent < end && ascii_isdigit((unsigned char)*exponent)) {
+            is_float = 1;
+            p = exponent;
+            while (p < end && ascii_isdigit((unsigned char)*p)) { p++; }
+        }
+    }
+    parser->pos = p;
+
+    Py_ssize_t len = p - start;
+    if (!is_float && len <= 18) {
+        // Fits in 64 bits with its sign
+        long long value = 0;
+        for (const char* d = start + (*start == '-'); d < p; ++d) { value = value * 10 + (*d - '0'); }
+        return PyLong_FromLongLong(*start == '-' ? -value : value);
+    }
+    // Both parsers need a NUL-terminated copy
+    if (!scratch_reserve(&parser->scratch, len + 1, "loads")) { return NULL; }
+    memcpy(parser->scratch.data, start, len);
+    parser->scratch.data[len] = '\0';
+    if (!is_float) { return PyLong_FromString(parser->scratch.data, NULL, 10); }
+    double value = PyOS_string_to_double(parser->scratch.data, NULL, NULL);
+    if (value == -1.0 && PyErr_Occurred()) { return NULL; }
+    return PyFloat_FromDouble(value);
+}
+
+static PyObject* json_value(JsonParser* parser);
+
+static PyObject* json_object(JsonParser* parser) {
+    const char* end = parser->end;
+    PyObject* dict = PyDict_New();
+    if (!dict) { return NULL; }
+    parser->pos = json_skip_space(parser->pos + 1, end);
+    if (parser->pos < end && *parser->pos == '}') {
+        parser->pos++;
+        return dict;
+    }
+    for (;;) {
+        if (parser->pos == end || *parser->pos != '"') {
+            json_error(parser, "Expecting property name enclosed in double quotes", parser->pos);
+            break;
+        }
+        PyObject* key = json_key(parser);
+        if (!key) { break; }
+        parser->pos = json_skip_space(parser->pos, end);
+        if (parser->pos == end || *parser->pos != ':') {
+            json_error(parser, "Expecting ':' delimiter", parser->pos);
+            Py_DECREF(key);
+            break;
+        }
+        parser->pos = json_skip_space(parser->pos + 1, end);
+        PyObject* value = json_value(parser);
+        int status = value ? PyDict_SetItem(dict, key, value) : -1;
+        Py_DECREF(key);
+        Py_XDECREF(value);
+        if (status < 0) { break; }
+
+        parser->pos = json_skip_space(parser->pos, end);
+        if (parser->pos < end && *parser->pos == '}') {
+            parser->pos++;
+            return dict;
+        }
+        if (parser->pos == end || *parser->pos != ',') {
+            json_error(parser, "Expecting ',' delimiter", parser->pos);
+            break;
+        }
+        const char* comma = parser->pos;
+        parser->pos = json_skip_space(parser->pos + 1, end);
+#if PY_VERSION_HEX >= 0x030D0000
+        // Reported as json reports it from 3.13
+        if (parser->pos < end && *parser->pos == '}') {
+            json_error(parser, "Illegal trailing comma before end of object", comma);
+            break;
+        }
+#else
+        (void)comma;
+#endif
+    }
+    Py_DECREF(dict);
+    return NULL;
+}
+
+static PyObject* json_array(JsonParser* parser) {
+    const char* end = parser->end;
+    PyObject* list = PyList_New(0);
+    if (!list) { return NULL; }
+    parser->pos = json_skip_space(parser->pos + 1, end);
+    if (parser->pos < end && *parser->pos == ']') {
+        parser->pos++;
+        return list;
+    }
+    for (;;) {
+        PyObject* value = json_value(parser);
+        int status = value ? PyList_Append(list, value) : -1;
+        Py_XDECREF(value);
+        if (status < 0) { break; }
+
+        parser->pos = json_skip_space(parser->pos, end);
+        if (parser->pos < end && *parser->pos == ']') {
+            parser->pos++;
+            return list;
+        }
+        if (parser->pos == end || *parser->pos != ',') {
+            json_error(parser, "Expecting ',' delimiter", parser->pos);
+            break;
+        }
+        const char* comma = parser->pos;
+        parser->pos = json_skip_space(parser->pos + 1, end);
+#if PY_VERSION_HEX >= 0x030D0000
+        // Reported as json reports it from 3.13
+        if (parser->pos < end && *parser->pos == ']') {
+            json_error(parser, "Illegal trailing comma before end of array", comma);
+            break;
+        }
+#else
+        (void)comma;
+#endif
+    }
+    Py_DECREF(list);
+    return NULL;
+}
+
+// Match a literal word at parser->pos, moving past it
+static inline int json_literal(JsonParser* parser, const char* word, Py_ssize_t len) {
+    if (parser->end - parser->pos < len || memcmp(parser->pos, word, len) != 0) { return 0; }
+    parser->pos += len;
+    return 1;
+}
+
+// The value at parser->pos, which follows any whitespace
+static PyObject* json_value(JsonParser* parser) {
+    if (parser->pos == parser->end) {
+        json_error(parser, "Expecting value", parser->pos);
+        return NULL;
+    }
+    PyObject* result;
+    switch (*parser->pos) {
+    case '"':
+        return json_string(parser);
+    case '{':
+    case '[':
+        if (Py_EnterRecursiveCall(" while decoding a JSON document")) { return NULL; }
+        result = *parser->pos == '{' ? json_object(parser) : json_array(parser);
+        Py_LeaveRecursiveCall();
+        return result;
+    case 'n':
+        if (json_literal(parser, "null", 4)) { Py_RETURN_NONE; }
+        break;
+    case 't':
+        if (json_literal(parser, "true", 4)) { Py_RETURN_TRUE; }
+        break;
+    case 'f':
+        if (json_literal(parser, "false", 5)) { Py_RETURN_FALSE; }
+        break;
+    case 'N':
+        if (json_literal(parser, "NaN", 3)) { return PyFloat_FromDouble(Py_NAN); }
+        break;
+    case 'I':
+        if (json_literal(parser, "Infinity", 8)) { return PyFloat_FromDouble(Py_HUGE_VAL); }
+        break;
+    default:
+        if (*parser->pos == '-' || ascii_isdigit((unsigned char)*parser->pos)) { return json_number(parser); }
+        break;
+    }
+    json_error(parser, "Expecting value", parser->pos);
+    return NULL;
+}
+
+// loads(data, key_case="snake")
+static PyObject* loads(PyObject* self, PyObject* args, PyObject* kwargs) {
+    static char* kwlist[] = {"data", "key_case", NULL};
+    PyObject* data;
+    const char* case_name = "snakecase";
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|z:loads", kwlist, &data, &case_name)) {
+        return NULL;
+    }
+    JsonParser parser = {NULL, NULL, NULL, NULL, NULL, {NULL, 0}, NULL, 0, 0};
+    if (case_name && !(parser.spec = find_case(case_name))) { return NULL; }
+
+    PyObject* utf8 = NULL;
+    Py_buffer view = {NULL};
+    if (PyUnicode_Check(data)) {
+        if (PyUnicode_READY(data) < 0) { return NULL; }
+        if (PyUnicode_IS_ASCII(data)) {
+            parser.start = (const char*)PyUnicode_1BYTE_DATA(data);
+            parser.end = parser.start + PyUnicode_GET_LENGTH(data);
+        } else {
+            // Lone surrogates are kept, as json.loads keeps them
+            if (!(utf8 = PyUnicode_AsEncodedString(data, "utf-8", "surrogatepass"))) { return NULL; }
+            parser.start = PyBytes_AS_STRING(utf8);
+            parser.end = parser.start + PyBytes_GET_SIZE(utf8);
+        }
+        parser.doc = data;
+    } else {
+        if (PyObject_GetBuffer(data, &view, PyBUF_SIMPLE) < 0) {
+            PyErr_Format(PyExc_TypeError, "loads() takes str or UTF-8 bytes-like data, not %.200s",
+                         Py_TYPE(data)->tp_name);
+            return NULL;
+        }
+        parser.start = (const char*)view.buf;
+        parser.end = parser.start + view.len;
+        if (!PyBytes_CheckExact(data)) {
+            // A mutable buffer could change under the scan, which trusts
+            // what it has already read, so the parser works on a copy
+            utf8 = PyBytes_FromStringAndSize(parser.start, view.len);
+            PyBuffer_Release(&view);
+            view.buf = NULL;
+            if (!utf8) { return NULL; }
+            parser.start = PyBytes_AS_STRING(utf8);
+            parser.end = parser.start + PyBytes_GET_SIZE(utf8);
+        }
+        // Decoded as utf-8-sig with surrogatepass, as json.loads does
+        if (parser.end - parser.start >= 3 && memcmp(parser.start, "\xEF\xBB\xBF", 3) == 0) { parser.start += 3; }
+    }
+
+    PyObject* result = NULL;
+    parser.pos = json_skip_space(parser.start, parser.end);
+    if (parser.doc && parser.end - parser.start >= 3 && memcmp(parser.start, "\xEF\xBB\xBF", 3) == 0) {
+        json_error(&parser, "Unexpected UTF-8 BOM (decode using utf-8-sig)", parser.start);
+    } else if ((result = json_value(&parser)) != NULL) {
+        parser.pos = json_skip_space(parser.pos, parser.end);
+        if (parser.pos != parser.end) {
+            json_error(&parser, "Extra data", parser.pos);
+            Py_CLEAR(result);
+        }
+    }
+
+    for (size_t i = 0; parser.memo && i <= parser.memo_mask; ++i) {
+        Py_XDECREF(parser.memo[i].key);
+    }
+    PyMem_Free(parser.memo);
+    scratch_free(&parser.scratch);
+    if (view.buf) { PyBuffer_Release(&view); }
+    Py_XDECREF(utf8);
+    return result;
+}
+
+
+// --- C API ---
+//
+// The FastStringcase_CAPI table of fast_stringcase_capi.h, published to other
+// extensions as the fast_stringcase._C_API capsule. It holds no Python
+// objects, so one table serves every interpreter.
+
+// Kernels may write one byte past their result, so output that fits exactly
+// is built here first (or on the heap, past this size)
+#define CAPI_STACK_BYTES 256
+
+static int capi_find_case(const char* name) {
+    const CaseSpec* spec = find_case(name);
+    return spec ? spec->index : -1;
+}
+
+static Py_ssize_t capi_measure(int case_number, const char* input, Py_ssize_t len) {
+    if (case_number < 0 || case_number >= CASE_COUNT || len < 0) { return -1; }
+    return case_specs[case_number]->measure(input, len);
+}
+
+static Py_ssize_t capi_convert_buffer(int case_number, const char* input, Py_ssize_t len, char* output,
+                                      Py_ssize_t capacity) {
+    if (case_number < 0 || case_number >= CASE_COUNT || len < 0) { return -1; }
+    const CaseSpec* spec = case_specs[case_number];
+    Py_ssize_t result_len = spec->measure(input, len);
+    if (result_len > capacity) { return result_len; }
+    if (result_len < capacity) {
+        spec->kernel(input, len, output);
+    } else if (result_len > 0) {
+        char stack[CAPI_STACK_BYTES];
+        char* temp = result_len < CAPI_STACK_BYTES ? stack : (char*)malloc(result_len + 1);
+        if (!temp) { return -1; }
+        spec->kernel(input, len, temp);
+        memcpy(output, temp, result_len);
+        if (temp != stack) { free(temp); }
+    }
+    if (stats_enabled) { stats_convert(spec->stats, 1, len, result_len, 0); }
+    return result_len;
+}
+
+static const CaseSpec* capi_spec(int case_number) {
+    if (case_number < 0 || case_number >= CASE_COUNT) {
+        PyErr_Format(PyExc_ValueError, "Unknown case number %d", case_number);
+        return NULL;
+    }
+    return case_specs[case_number];
+}
+
+static PyObject* capi_convert(int case_number, PyObject* obj) {
+    const CaseSpec* spec = capi_spec(case_number);
+    if (!spec) { return NULL; }
+    if (!PyUnicode_Check(obj) && PyObject_CheckBuffer(obj)) {
+        return convert_buffer(spec, obj, NULL);
+    }
+    return convert_one(spec, NULL, obj);
+}
+
+static PyObject* capi_convert_many(int case_number, PyObject* items) {
+    const CaseSpec* spec = capi_spec(case_number);
+    return spec ? convert_many(spec, NULL, items) : NULL;
+}
+
+static const FastStringcase_CAPI capi = {
+    .version = FAST_STRINGCASE_CAPI_VERSION,
+    .case_count = CASE_COUNT,
+    .find_case = capi_find_case,
+    .measure = capi_measure,
+    .convert_buffer = capi_convert_buffer,
+    .convert = capi_convert,
+    .convert_many = capi_convert_many,
+};
+
+
+// --- Module Definition ---
+
+static PyMethodDef StringCaseMethods[] = {
+    {"camelcase", (PyCFunction)(void(*)(void))camelcase, METH_FASTCALL | METH_KEYWORDS, "Convert string into camel case."},
+    {"capitalcase", (PyCFunction)(void(*)(void))capitalcase, METH_FASTCALL | METH_KEYWORDS, "Convert string into capital case."},
+    {"constcase", (PyCFunction)(void(*)(void))constcase, METH_FASTCALL | METH_KEYWORDS, "Convert string into const case."},
+    {"lowercase", (PyCFunction)(void(*)(void))lowercase, METH_FASTCALL | METH_KEYWORDS, "Convert string into lower case."},
+    {"pascalcase", (PyCFunction)(void(*)(void))pascalcase, METH_FASTCALL | METH_KEYWORDS, "Convert string into pascal case."},
+    {"pathcase", (PyCFunction)(void(*)(void))pathcase, METH_FASTCALL | METH_KEYWORDS, "Convert string into path case."},
+    {"backslashcase", (PyCFunction)(void(*)(void))backslashcase, METH_FASTCALL | METH_KEYWORDS, "Convert string into backslash case."},
+    {"sentencecase", (PyCFunction)(void(*)(void))sentencecase, METH_FASTCALL | METH_KEYWORDS, "Convert string into sentence case."},
+    {"snakecase", (PyCFunction)(void(*)(void))snakecase, METH_FASTCALL | METH_KEYWORDS, "Convert string into snake case."},
+    {"spinalcase", (PyCFunction)(void(*)(void))spinalcase, METH_FASTCALL | METH_KEYWORDS, "Convert string into spinal case."},
+    {"dotcase", (PyCFunction)(void(*)(void))dotcase, METH_FASTCALL | METH_KEYWORDS, "Convert string into dot case."},
+    {"titlecase", (PyCFunction)(void(*)(void))titlecase, METH_FASTCALL | METH_KEYWORDS, "Convert string into title case."},
+    {"trimcase", (PyCFunction)(void(*)(void))trimcase, METH_FASTCALL | METH_KEYWORDS, "Convert string into trim case."},
+    {"uppercase", (PyCFunction)(void(*)(void))uppercase, METH_FASTCALL | METH_KEYWORDS, "Convert string into upper case."},
+    {"alphanumcase", (PyCFunction)(void(*)(void))alphanumcase, METH_FASTCALL | METH_KEYWORDS, "Convert string into alphanumeric case."},
+    {"camelcase_many", (PyCFunction)(void(*)(void))camelcase_many, METH_FASTCALL | METH_KEYWORDS,
+     "Convert every string in an iterable into camel case, optionally on several threads."},
+    {"capitalcase_many", (PyCFunction)(void(*)(void))capitalcase_many, METH_FASTCALL | METH_KEYWORDS,
+     "Convert every string in an iterable into capital case, optionally on several threads."},
+    {"constcase_many", (PyCFunction)(void(*)(void))constcase_many, METH_FASTCALL | METH_KEYWORDS,
+     "Convert every string in an iterable into const case, optionally on several threads."},
+    {"lowercase_many", (PyCFunction)(void(*)(void))lowercase_many, METH_FASTCALL | METH_KEYWORDS,
+     "Convert every string in an iterable into lower case, optionally on several threads."},
+    {"pascalcase_many", (PyCFunction)(void(*)(void))pascalcase_many, METH_FASTCALL | METH_KEYWORDS,
+     "Convert every string in an iterable into pascal case, optionally on several threads."},
+    {"pathcase_many", (PyCFunction)(void(*)(void))pathcase_many, METH_FASTCALL | METH_KEYWORDS,
+     "Convert every string in an iterable into path case, optionally on several threads."},
+    {"backslashcase_many", (PyCFunction)(void(*)(void))backslashcase_many, METH_FASTCALL | METH_KEYWORDS,
+     "Convert every string in an iterable into backslash case, optionally on several threads."},
+    {"sentencecase_many", (PyCFunction)(void(*)(void))sentencecase_many, METH_FASTCALL | METH_KEYWORDS,
+     "Convert every string in an iterable into sentence case, optionally on several threads."},
+    {"snakecase_many", (PyCFunction)(void(*)(void))snakecase_many, METH_FASTCALL | METH_KEYWORDS,
+     "Convert every string in an iterable into snake case, optionally on several threads."},
+    {"spinalcase_many", (PyCFunction)(void(*)(void))spinalcase_many, METH_FASTCALL | METH_KEYWORDS,
+     "Convert every string in an iterable into spinal case, optionally on several threads."},
+    {"dotcase_many", (PyCFunction)(void(*)(void))dotcase_many, METH_FASTCALL | METH_KEYWORDS,
+     "Convert every string in an iterable into dot case, optionally on several threads."},
+    {"titlecase_many", (PyCFunction)(void(*)(void))titlecase_many, METH_FASTCALL | METH_KEYWORDS,
+     "Convert every string in an iterable into title case, optionally on several threads."},
+    {"trimcase_many", (PyCFunction)(void(*)(void))trimcase_many, METH_FASTCALL | METH_KEYWORDS,
+     "Convert every string in an iterable into trim case, optionally on several threads."},
+    {"uppercase_many", (PyCFunction)(void(*)(void))uppercase_many, METH_FASTCALL | METH_KEYWORDS,
+     "Convert every string in an iterable into upper case, optionally on several threads."},
+    {"alphanumcase_many", (PyCFunction)(void(*)(void))alphanumcase_many, METH_FASTCALL | METH_KEYWORDS,
+     "Convert every string in an iterable into alphanumeric case, optionally on several threads."},
+    {"lowercase_inplace", lowercase_inplace, METH_O, "Convert a writable bytes-like object into lower case in place."},
+    {"uppercase_inplace", uppercase_inplace, METH_O, "Convert a writable bytes-like object into upper case in place."},
+    {"snakecase_inplace", snakecase_inplace, METH_O, "Convert a writable bytes-like object into snake case in place."},
+    {"constcase_inplace", constcase_inplace, METH_O, "Convert a writable bytes-like object into const case in place."},
+    {"pathcase_inplace", pathcase_inplace, METH_O, "Convert a writable bytes-like object into path case in place."},
+    {"backslashcase_inplace", backslashcase_inplace, METH_O, "Convert a writable bytes-like object into backslash case in place."},
+    {"spinalcase_inplace", spinalcase_inplace, METH_O, "Convert a writable bytes-like object into spinal case in place."},
+    {"dotcase_inplace", dotcase_inplace, METH_O, "Convert a writable bytes-like object into dot case in place."},
+    {"transform_keys", (PyCFunction)(void(*)(void))transform_keys, METH_VARARGS | METH_KEYWORDS,
+     "transform_keys(obj, case, *, depth=None)\n"
+     "Copy nested dicts, lists and tuples with every str dict key converted by\n"
+     "the named case function. Dict subclasses come back as plain dicts.\n"
+     "depth limits how many levels are walked."},
+    {"cache_configure", (PyCFunction)(void(*)(void))cache_configure, METH_VARARGS | METH_KEYWORDS,
+     "cache_configure(maxsize, intern=False, case=None)\n"
+     "Cache up to maxsize recent conversions per case function (0 disables),\n"
+     "optionally interning results. case limits the change to one function."},
+    {"cache_info", cache_info, METH_NOARGS,
+     "Return {name: (hits, misses, maxsize, currsize)} for every case function."},
+    {"cache_clear", cache_clear, METH_NOARGS, "Empty every conversion cache."},
+    {"detect_case", detect_case, METH_O,
+     "detect_case(s)\n"
+     "Name the case style s is written in: 'snake', 'const', 'camel', 'pascal',\n"
+     "'spinal', 'dot', 'path', 'title', or 'mixed' for none of them."},
+    {"detect_case_many", detect_case_many, METH_O,
+     "detect_case_many(items)\n"
+     "detect_case() for every string in an iterable, as a list."},
+    {"ensure_case", (PyCFunction)(void(*)(void))ensure_case, METH_FASTCALL,
+     "ensure_case(s, case)\n"
+     "Return s unchanged if it is already in the style of the named case\n"
+     "function, else convert it with that function."},
+    {"words", (PyCFunction)(void(*)(void))words, METH_VARARGS | METH_KEYWORDS,
+     "words(s, *, offsets=False)\n"
+     "Split s into the words the case functions see: at separators and before\n"
+     "every uppercase letter. With offsets, return (start, end) pairs instead."},
+    {"convert", (PyCFunction)(void(*)(void))convert, METH_FASTCALL | METH_KEYWORDS,
+     "convert(s, cases)\n"
+     "Return a tuple with s in each named case, e.g. ('snake', 'camel'),\n"
+     "splitting s into words only once."},
+    {"case_equal", (PyCFunction)(void(*)(void))case_equal, METH_FASTCALL,
+     "case_equal(a, b)\n"
+     "True if a and b spell the same words in any case style, e.g.\n"
+     "'userId' and 'USER-ID'. Nothing is allocated."},
+    {"canonical_hash", canonical_hash, METH_O,
+     "canonical_hash(s)\n"
+     "Hash of the words of s, equal for strings that case_equal() matches."},
+    {"convert_arrow", (PyCFunction)(void(*)(void))convert_arrow, METH_VARARGS | METH_KEYWORDS,
+     "convert_arrow(array, case)\n"
+     "Convert every row of an Arrow string or large_string array (any object\n"
+     "implementing __arrow_c_array__) with the named case function, returning\n"
+     "a new ArrowStringArray."},
+    {"convert_file", (PyCFunction)(void(*)(void))convert_file, METH_VARARGS | METH_KEYWORDS,
+     "convert_file(src, dst, case, *, field=None, delimiter=b'\\n', field_delimiter=b',', threads=None)\n"
+     "Convert every record of the delimiter-separated file src, or only its\n"
+     "1-based field, and write the result to dst. The input is memory-mapped\n"
+     "and converted on threads native threads. Returns the number of records."},
+    {"loads", (PyCFunction)(void(*)(void))loads, METH_VARARGS | METH_KEYWORDS,
+     "loads(data, key_case='snake')\n"
+     "Decode a JSON document from str or UTF-8 bytes, converting every object\n"
+     "key with the named case function as it is parsed. key_case=None keeps\n"
+     "keys as they are."},
+    {"enable_stats", (PyCFunction)(void(*)(void))enable_stats, METH_VARARGS | METH_KEYWORDS,
+     "enable_stats(enabled=True)\n"
+     "Turn recording of per-function statistics on or off, returning the\n"
+     "previous setting."},
+    {"stats", stats, METH_NOARGS,
+     "Return call, string, byte, allocation, cache hit and latency counters\n"
+     "for every case function."},
+    {"reset_stats", reset_stats, METH_NOARGS, "Zero every statistics counter."},
+    {NULL, NULL, 0, NULL} // Sentinel
+};
+
+static int module_traverse(PyObject* module, visitproc visit, void* arg) {
+    ModuleState* state = get_module_state(module);
+    Py_VISIT(state->case_index);
+    Py_VISIT(state->collections_abc);
+    Py_VISIT(state->arrow_string_array_type);
+    for (int i = 0; i < STYLE_COUNT; ++i) {
+        Py_VISIT(state->style_names[i]);
+    }
+    return 0;
+}
+
+static int module_clear(PyObject* module) {
+    ModuleState* state = get_module_state(module);
+    Py_CLEAR(state->case_index);
+    Py_CLEAR(state->collections_abc);
+    Py_CLEAR(state->arrow_string_array_type);
+    for (int i = 0; i < STYLE_COUNT; ++i) {
+        Py_CLEAR(state->style_names[i]);
+    }
+    for (int i = 0; i < CASE_COUNT; ++i) {
+        cache_resize(&state->caches[i], 0, 0);  // Cannot fail when disabling
+    }
+    return 0;
+}
+
+static void module_free(void* module) {
+    module_clear((PyObject*)module);
+    parallel_pool_free(&get_module_state((PyObject*)module)->pool);
+}
+
+// Create a type from its spec and add it to the module. Returns a new
+// reference, or NULL with an exception set.
+static PyTypeObject* add_type(PyObject* module, PyType_Spec* spec) {
+    PyTypeObject* type = (PyTypeObject*)PyType_FromModuleAndSpec(module, spec, NULL);
+    if (!type) { return NULL; }
+    if (PyModule_AddType(module, type) < 0) {
+        Py_DECREF(type);
+        return NULL;
+    }
+    return type;
+}
+
+static int module_exec(PyObject* module) {
+    ModuleState* state = get_module_state(module);
+    // FAST_STRINGCASE_SIMD=scalar|sse2|avx2 caps the instruction set, for testing
+    const char* simd = cc_select(Py_GETENV("FAST_STRINGCASE_SIMD"));
+    // FAST_STRINGCASE_STATS=1 records statistics from the first call
+    const char* record_stats = Py_GETENV("FAST_STRINGCASE_STATS");
+    if (record_stats && strcmp(record_stats, "1") == 0) { stats_enabled = 1; }
+    // Helpers are only started by the first call that asks for them
+    parallel_pool_init(&state->pool);
+
+    if (build_case_index(state) < 0 || build_style_names(state) < 0) { return -1; }
+    if (!(state->collections_abc = PyImport_ImportModule("collections.abc"))) { return -1; }
+    PyTypeObject* type;
+    if (!(type = add_type(module, &converter_spec))) { return -1; }
+    Py_DECREF(type);
+    if (!(type = add_type(module, &cnd_spec))) { return -1; }
+    Py_DECREF(type);
+    if (!(type = add_type(module, &stream_spec))) { return -1; }
+    Py_DECREF(type);
+    if (!(state->arrow_string_array_type = add_type(module, &arrow_string_array_spec))) { return -1; }
+#ifndef Py_TPFLAGS_DISALLOW_INSTANTIATION
+    state->arrow_string_array_type->tp_new = NULL;
+#endif
+    PyObject* capsule = PyCapsule_New((void*)&capi, FAST_STRINGCASE_CAPSULE_NAME, NULL);
+    if (!capsule || PyModule_AddObject(module, "_C_API", capsule) < 0) {
+        Py_XDECREF(capsule);
+        return -1;
+    }
+    return PyModule_AddStringConstant(module, "_simd", simd);
+}
+
+static PyModuleDef_Slot fast_stringcase_slots[] = {
+    {Py_mod_exec, module_exec},
+#ifdef Py_mod_multiple_interpreters
+    // Nothing is shared between interpreters but counters and kernel tables
+    {Py_mod_multiple_interpreters, Py_MOD_PER_INTERPRETER_GIL_SUPPORTED},
+#endif
+#ifdef Py_mod_gil
+    // Shared state is in critical sections, per-cache locks or atomics
+    {Py_mod_gil, Py_MOD_GIL_NOT_USED},
+#endif
+    {0, NULL} // Sentinel
 };
 
 static struct PyModuleDef fast_stringcase_module = {
     PyModuleDef_HEAD_INIT,
-    "fast_stringcase",   // name of module
-    "C extension for string case conversions based on stringcase_base.py.", // module documentation, may be NULL
-    -1,       // size of per-interpreter state of the module, or -1 if the module keeps state in global variables.
-    StringCaseMethods
+    .m_name = "fast_stringcase",
+    .m_doc = "C extension for string case conversions based on stringcase_base.py.",
+    .m_size = sizeof(ModuleState),
+    .m_methods = StringCaseMethods,
+    .m_slots = fast_stringcase_slots,
+    .m_traverse = module_traverse,
+    .m_clear = module_clear,
+    .m_free = module_free,
 };
 
 PyMODINIT_FUNC PyInit_fast_stringcase(void) {
-    return PyModule_Create(&fast_stringcase_module);
+    return PyModuleDef_Init(&fast_stringcase_module);
 }
@@ -1,3 +1,16 @@
+import os
+from typing import (Any, ItemsView, Iterable, Iterator, KeysView, Literal, MutableMapping, Sequence, Union,
+                    ValuesView, overload)
+
+WordCase = Literal["lower", "upper", "title", "capital", "preserve"]
+
+# Styles reported by detect_case(), in the order they are checked
+Style = Literal["snake", "const", "camel", "pascal", "spinal", "dot", "path", "title", "mixed"]
+
+# Any object supporting the buffer protocol, e.g. bytes, bytearray, memoryview or mmap
+BytesLike = Union[bytes, bytearray, memoryview]
+
+@overload
 def lowercase(s: str) -> str:
     """Convert the string to lowercase.
 
@@ -12,6 +25,11 @@ def lowercase(s: str) -> str:
         "hello"
     """
     ...
+@overload
+def lowercase(s: BytesLike, out: None = None) -> bytes: ...
+@overload
+def lowercase(s: BytesLike, out: BytesLike) -> int: ...
+@overload
 def uppercase(s: str) -> str:
     """Convert the string to uppercase.
 
@@ -26,6 +44,11 @@ def uppercase(s: str) -> str:
         "HELLO"
     """
     ...
+@overload
+def uppercase(s: BytesLike, out: None = None) -> bytes: ...
+@overload
+def uppercase(s: BytesLike, out: BytesLike) -> int: ...
+@overload
 def snakecase(s: str) -> str:
     """Convert the string to snake_case (lowercase with underscores).
 
@@ -40,6 +63,11 @@ def snakecase(s: str) -> str:
         "hello_world"
     """
     ...
+@overload
+def snakecase(s: BytesLike, out: None = None) -> bytes: ...
+@overload
+def snakecase(s: BytesLike, out: BytesLike) -> int: ...
+@overload
 def camelcase(s: str) -> str:
     """Convert the string to camelCase (lowercase first letter, uppercase after separators).
 
@@ -54,6 +82,11 @@ def camelcase(s: str) -> str:
         "helloWorld"
     """
     ...
+@overload
+def camelcase(s: BytesLike, out: None = None) -> bytes: ...
+@overload
+def camelcase(s: BytesLike, out: BytesLike) -> int: ...
+@overload
 def capitalcase(s: str) -> str:
     """Capitalize each word's first letter except the first (e.g., 'hello world' → 'hello World').
 
@@ -68,6 +101,11 @@ def capitalcase(s: str) -> str:
         "hello World"
     """
     ...
+@overload
+def capitalcase(s: BytesLike, out: None = None) -> bytes: ...
+@overload
+def capitalcase(s: BytesLike, out: BytesLike) -> int: ...
+@overload
 def pascalcase(s: str) -> str:
     """Convert the string to PascalCase (each word starts with uppercase, no underscores).
 
@@ -82,6 +120,11 @@ def pascalcase(s: str) -> str:
         "HelloWorld"
     """
     ...
+@overload
+def pascalcase(s: BytesLike, out: None = None) -> bytes: ...
+@overload
+def pascalcase(s: BytesLike, out: BytesLike) -> int: ...
+@overload
 def constcase(s: str) -> str:
     """Convert the string to UPPERCASE_WITH_UNDERSCORES (constant case).
 
@@ -96,6 +139,11 @@ def constcase(s: str) -> str:
         "HELLO_WORLD"
     """
     ...
+@overload
+def constcase(s: BytesLike, out: None = None) -> bytes: ...
+@overload
+def constcase(s: BytesLike, out: BytesLike) -> int: ...
+@overload
 def pathcase(s: str) -> str:
     """Convert the string to path/case using slashes.
 
@@ -110,6 +158,11 @@ def pathcase(s: str) -> str:
         "hello/world"
     """
     ...
+@overload
+def pathcase(s: BytesLike, out: None = None) -> bytes: ...
+@overload
+def pathcase(s: BytesLike, out: BytesLike) -> int: ...
+@overload
 def backslashcase(s: str) -> str:
     """Convert the string to path\case using backslashes.
 
@@ -124,6 +177,11 @@ def backslashcase(s: str) -> str:
         "hello\\world"
     """
     ...
+@overload
+def backslashcase(s: BytesLike, out: None = None) -> bytes: ...
+@overload
+def backslashcase(s: BytesLike, out: BytesLike) -> int: ...
+@overload
 def spinalcase(s: str) -> str:
     """Convert the string to spinal-case using hyphens.
 
@@ -138,6 +196,11 @@ def spinalcase(s: str) -> str:
         "hello-world"
     """
     ...
+@overload
+def spinalcase(s: BytesLike, out: None = None) -> bytes: ...
+@overload
+def spinalcase(s: BytesLike, out: BytesLike) -> int: ...
+@overload
 def dotcase(s: str) -> str:
     """Convert the string to dot.case using periods.
 
@@ -152,6 +215,11 @@ def dotcase(s: str) -> str:
         "hello.world"
     """
     ...
+@overload
+def dotcase(s: BytesLike, out: None = None) -> bytes: ...
+@overload
+def dotcase(s: BytesLike, out: BytesLike) -> int: ...
+@overload
 def titlecase(s: str) -> str:
     """Convert the string to Title Case Each Word.
 
@@ -166,6 +234,11 @@ def titlecase(s: str) -> str:
         "Hello World"
     """
     ...
+@overload
+def titlecase(s: BytesLike, out: None = None) -> bytes: ...
+@overload
+def titlecase(s: BytesLike, out: BytesLike) -> int: ...
+@overload
 def trimcase(s: str) -> str:
     """Trim whitespace from the start and end of the string.
 
@@ -180,6 +253,11 @@ def trimcase(s: str) -> str:
         "hello"
     """
     ...
+@overload
+def trimcase(s: BytesLike, out: None = None) -> bytes: ...
+@overload
+def trimcase(s: BytesLike, out: BytesLike) -> int: ...
+@overload
 def alphanumcase(s: str) -> str:
     """Remove non-alphanumeric characters from the string.
 
@@ -194,6 +272,11 @@ def alphanumcase(s: str) -> str:
         "helloWorld"
     """
     ...
+@overload
+def alphanumcase(s: BytesLike, out: None = None) -> bytes: ...
+@overload
+def alphanumcase(s: BytesLike, out: BytesLike) -> int: ...
+@overload
 def sentencecase(s: str) -> str:
     """Capitalize the first letter of the sentence and lowercase the rest.
 
@@ -208,3 +291,753 @@ def sentencecase(s: str) -> str:
         "Hello world"
     """
     ...
+@overload
+def sentencecase(s: BytesLike, out: None = None) -> bytes: ...
+@overload
+def sentencecase(s: BytesLike, out: BytesLike) -> int: ...
+def lowercase_many(items: Iterable[str], threads: int | None = None) -> list[str]:
+    """Convert every string in an iterable to lowercase in a single call.
+
+    Args:
+        items (Iterable[str]): A list, tuple or any iterable of strings.
+        threads (int | None): Convert batches of 8192 or more strings on up to
+            this many native threads, with the GIL released.
+
+    Returns:
+        list[str]: The converted strings, in input order.
+
+    Example:
+        >>> lowercase_many(["HeLLo", "WoRLD"])
+        ["hello", "world"]
+    """
+    ...
+def uppercase_many(items: Iterable[str], threads: int | None = None) -> list[str]:
+    """Convert every string in an iterable to uppercase in a single call.
+
+    Args:
+        items (Iterable[str]): A list, tuple or any iterable of strings.
+        threads (int | None): Convert batches of 8192 or more strings on up to
+            this many native threads, with the GIL released.
+
+    Returns:
+        list[str]: The converted strings, in input order.
+
+    Example:
+        >>> uppercase_many(["hElLo", "world"])
+        ["HELLO", "WORLD"]
+    """
+    ...
+def snakecase_many(items: Iterable[str], threads: int | None = None) -> list[str]:
+    """Convert every string in an iterable to snake_case in a single call.
+
+    Args:
+        items (Iterable[str]): A list, tuple or any iterable of strings.
+        threads (int | None): Convert batches of 8192 or more strings on up to
+            this many native threads, with the GIL released.
+
+    Returns:
+        list[str]: The converted strings, in input order.
+
+    Example:
+        >>> snakecase_many(["helloWorld", "FooBar"])
+        ["hello_world", "foo_bar"]
+    """
+    ...
+def camelcase_many(items: Iterable[str], threads: int | None = None) -> list[str]:
+    """Convert every string in an iterable to camelCase in a single call.
+
+    Args:
+        items (Iterable[str]): A list, tuple or any iterable of strings.
+        threads (int | None): Convert batches of 8192 or more strings on up to
+            this many native threads, with the GIL released.
+
+    Returns:
+        list[str]: The converted strings, in input order.
+
+    Example:
+        >>> camelcase_many(["Hello_World", "foo_bar"])
+        ["helloWorld", "fooBar"]
+    """
+    ...
+def capitalcase_many(items: Iterable[str], threads: int | None = None) -> list[str]:
+    """Convert every string in an iterable to capital case in a single call.
+
+    Args:
+        items (Iterable[str]): A list, tuple or any iterable of strings.
+        threads (int | None): Convert batches of 8192 or more strings on up to
+            this many native threads, with the GIL released.
+
+    Returns:
+        list[str]: The converted strings, in input order.
+
+    Example:
+        >>> capitalcase_many(["hello world", "foo"])
+        ["Hello world", "Foo"]
+    """
+    ...
+def pascalcase_many(items: Iterable[str], threads: int | None = None) -> list[str]:
+    """Convert every string in an iterable to PascalCase in a single call.
+
+    Args:
+        items (Iterable[str]): A list, tuple or any iterable of strings.
+        threads (int | None): Convert batches of 8192 or more strings on up to
+            this many native threads, with the GIL released.
+
+    Returns:
+        list[str]: The converted strings, in input order.
+
+    Example:
+        >>> pascalcase_many(["hello_world", "foo_bar"])
+        ["HelloWorld", "FooBar"]
+    """
+    ...
+def constcase_many(items: Iterable[str], threads: int | None = None) -> list[str]:
+    """Convert every string in an iterable to CONSTANT_CASE in a single call.
+
+    Args:
+        items (Iterable[str]): A list, tuple or any iterable of strings.
+        threads (int | None): Convert batches of 8192 or more strings on up to
+            this many native threads, with the GIL released.
+
+    Returns:
+        list[str]: The converted strings, in input order.
+
+    Example:
+        >>> constcase_many(["helloWorld", "foo_bar"])
+        ["HELLO_WORLD", "FOO_BAR"]
+    """
+    ...
+def pathcase_many(items: Iterable[str], threads: int | None = None) -> list[str]:
+    """Convert every string in an iterable to path/case in a single call.
+
+    Args:
+        items (Iterable[str]): A list, tuple or any iterable of strings.
+        threads (int | None): Convert batches of 8192 or more strings on up to
+            this many native threads, with the GIL released.
+
+    Returns:
+        list[str]: The converted strings, in input order.
+
+    Example:
+        >>> pathcase_many(["helloWorld", "foo_bar"])
+        ["hello/world", "foo/bar"]
+    """
+    ...
+def backslashcase_many(items: Iterable[str], threads: int | None = None) -> list[str]:
+    """Convert every string in an iterable to path\case in a single call.
+
+    Args:
+        items (Iterable[str]): A list, tuple or any iterable of strings.
+        threads (int | None): Convert batches of 8192 or more strings on up to
+            this many native threads, with the GIL released.
+
+    Returns:
+        list[str]: The converted strings, in input order.
+
+    Example:
+        >>> backslashcase_many(["helloWorld", "foo_bar"])
+        ["hello\\world", "foo\\bar"]
+    """
+    ...
+def spinalcase_many(items: Iterable[str], threads: int | None = None) -> list[str]:
+    """Convert every string in an iterable to spinal-case in a single call.
+
+    Args:
+        items (Iterable[str]): A list, tuple or any iterable of strings.
+        threads (int | None): Convert batches of 8192 or more strings on up to
+            this many native threads, with the GIL released.
+
+    Returns:
+        list[str]: The converted strings, in input order.
+
+    Example:
+        >>> spinalcase_many(["helloWorld", "foo_bar"])
+        ["hello-world", "foo-bar"]
+    """
+    ...
+def dotcase_many(items: Iterable[str], threads: int | None = None) -> list[str]:
+    """Convert every string in an iterable to dot.case in a single call.
+
+    Args:
+        items (Iterable[str]): A list, tuple or any iterable of strings.
+        threads (int | None): Convert batches of 8192 or more strings on up to
+            this many native threads, with the GIL released.
+
+    Returns:
+        list[str]: The converted strings, in input order.
+
+    Example:
+        >>> dotcase_many(["helloWorld", "foo_bar"])
+        ["hello.world", "foo.bar"]
+    """
+    ...
+def titlecase_many(items: Iterable[str], threads: int | None = None) -> list[str]:
+    """Convert every string in an iterable to Title Case in a single call.
+
+    Args:
+        items (Iterable[str]): A list, tuple or any iterable of strings.
+        threads (int | None): Convert batches of 8192 or more strings on up to
+            this many native threads, with the GIL released.
+
+    Returns:
+        list[str]: The converted strings, in input order.
+
+    Example:
+        >>> titlecase_many(["hello_world", "fooBar"])
+        ["Hello World", "Foo Bar"]
+    """
+    ...
+def trimcase_many(items: Iterable[str], threads: int | None = None) -> list[str]:
+    """Convert every string in an iterable to trimmed form in a single call.
+
+    Args:
+        items (Iterable[str]): A list, tuple or any iterable of strings.
+        threads (int | None): Convert batches of 8192 or more strings on up to
+            this many native threads, with the GIL released.
+
+    Returns:
+        list[str]: The converted strings, in input order.
+
+    Example:
+        >>> trimcase_many(["  hello  ", " foo"])
+        ["hello", "foo"]
+    """
+    ...
+def alphanumcase_many(items: Iterable[str], threads: int | None = None) -> list[str]:
+    """Convert every string in an iterable to alphanumeric form in a single call.
+
+    Args:
+        items (Iterable[str]): A list, tuple or any iterable of strings.
+        threads (int | None): Convert batches of 8192 or more strings on up to
+            this many native threads, with the GIL released.
+
+    Returns:
+        list[str]: The converted strings, in input order.
+
+    Example:
+        >>> alphanumcase_many(["hello!@#World", "foo_bar"])
+        ["helloWorld", "foobar"]
+    """
+    ...
+def sentencecase_many(items: Iterable[str], threads: int | None = None) -> list[str]:
+    """Convert every string in an iterable to Sentence case in a single call.
+
+    Args:
+        items (Iterable[str]): A list, tuple or any iterable of strings.
+        threads (int | None): Convert batches of 8192 or more strings on up to
+            this many native threads, with the GIL released.
+
+    Returns:
+        list[str]: The converted strings, in input order.
+
+    Example:
+        >>> sentencecase_many(["HELLO WORLD", "fooBar"])
+        ["Hello world", "Foo bar"]
+    """
+    ...
+def lowercase_inplace(buffer: BytesLike) -> None:
+    """Convert a writable bytes-like object to lowercase in place, without allocating.
+
+    Args:
+        buffer (BytesLike): A writable buffer, e.g. a bytearray or a memoryview slice.
+
+    Raises:
+        ValueError: If the conversion would change the length.
+
+    Example:
+        >>> buf = bytearray(b"HeLLo")
+        >>> lowercase_inplace(buf)
+        >>> buf
+        bytearray(b"hello")
+    """
+    ...
+def uppercase_inplace(buffer: BytesLike) -> None:
+    """Convert a writable bytes-like object to uppercase in place, without allocating.
+
+    Args:
+        buffer (BytesLike): A writable buffer, e.g. a bytearray or a memoryview slice.
+
+    Raises:
+        ValueError: If the conversion would change the length.
+
+    Example:
+        >>> buf = bytearray(b"hElLo")
+        >>> uppercase_inplace(buf)
+        >>> buf
+        bytearray(b"HELLO")
+    """
+    ...
+def snakecase_inplace(buffer: BytesLike) -> None:
+    """Convert a writable bytes-like object to snake_case in place, without creating a result object.
+
+    Args:
+        buffer (BytesLike): A writable buffer, e.g. a bytearray or a memoryview slice.
+
+    Raises:
+        ValueError: If the conversion would change the length (an uppercase letter after the first byte).
+
+    Example:
+        >>> buf = bytearray(b"hello-world")
+        >>> snakecase_inplace(buf)
+        >>> buf
+        bytearray(b"hello_world")
+    """
+    ...
+def constcase_inplace(buffer: BytesLike) -> None:
+    """Convert a writable bytes-like object to CONST_CASE in place, without creating a result object.
+
+    Args:
+        buffer (BytesLike): A writable buffer, e.g. a bytearray or a memoryview slice.
+
+    Raises:
+        ValueError: If the conversion would change the length (an uppercase letter after the first byte).
+
+    Example:
+        >>> buf = bytearray(b"hello.world")
+        >>> constcase_inplace(buf)
+        >>> buf
+        bytearray(b"HELLO_WORLD")
+    """
+    ...
+def pathcase_inplace(buffer: BytesLike) -> None:
+    """Convert a writable bytes-like object to path/case in place, without creating a result object.
+
+    Args:
+        buffer (BytesLike): A writable buffer, e.g. a bytearray or a memoryview slice.
+
+    Raises:
+        ValueError: If the conversion would change the length (an uppercase letter after the first byte).
+
+    Example:
+        >>> buf = bytearray(b"hello_world")
+        >>> pathcase_inplace(buf)
+        >>> buf
+        bytearray(b"hello/world")
+    """
+    ...
+def backslashcase_inplace(buffer: BytesLike) -> None:
+    """Convert a writable bytes-like object to backslash\case in place, without creating a result object.
+
+    Args:
+        buffer (BytesLike): A writable buffer, e.g. a bytearray or a memoryview slice.
+
+    Raises:
+        ValueError: If the conversion would change the length (an uppercase letter after the first byte).
+
+    Example:
+        >>> buf = bytearray(b"hello_world")
+        >>> backslashcase_inplace(buf)
+        >>> buf
+        bytearray(b"hello\\world")
+    """
+    ...
+def spinalcase_inplace(buffer: BytesLike) -> None:
+    """Convert a writable bytes-like object to spinal-case in place, without creating a result object.
+
+    Args:
+        buffer (BytesLike): A writable buffer, e.g. a bytearray or a memoryview slice.
+
+    Raises:
+        ValueError: If the conversion would change the length (an uppercase letter after the first byte).
+
+    Example:
+        >>> buf = bytearray(b"hello_world")
+        >>> spinalcase_inplace(buf)
+        >>> buf
+        bytearray(b"hello-world")
+    """
+    ...
+def dotcase_inplace(buffer: BytesLike) -> None:
+    """Convert a writable bytes-like object to dot.case in place, without creating a result object.
+
+    Args:
+        buffer (BytesLike): A writable buffer, e.g. a bytearray or a memoryview slice.
+
+    Raises:
+        ValueError: If the conversion would change the length (an uppercase letter after the first byte).
+
+    Example:
+        >>> buf = bytearray(b"hello_world")
+        >>> dotcase_inplace(buf)
+        >>> buf
+        bytearray(b"hello.world")
+    """
+    ...
+class Converter:
+    """A custom case style, compiled once and reusable for any number of calls.
+
+    Input is split into words at ``input_separators``, before an uppercase
+    letter that follows a non-uppercase character and, when ``acronyms`` is
+    true, before the last capital of a run followed by a lowercase letter
+    ("HTTPServer" -> "HTTP", "Server"). Each word is cased by ``word_case``
+    (``first_word_case`` for the first word) and the words are joined with
+    ``joiner``. Word cases: "lower", "upper" (the full mapping, as
+    uppercase() uses), "title" (first letter upper, rest lower), "capital"
+    (first letter upper, rest unchanged), "preserve".
+
+    Args:
+        input_separators (str): Characters that separate words.
+        joiner (str): Text placed between output words.
+        word_case (WordCase): Case of every word after the first.
+        first_word_case (WordCase | None): Case of the first word; defaults to word_case.
+        acronyms (bool): Keep runs of capitals together as one word.
+
+    Example:
+        >>> camel = Converter(joiner="", word_case="capital", first_word_case="lower")
+        >>> camel("parse_HTTP_response")
+        "parseHTTPResponse"
+        >>> Converter(joiner="::", word_case="title")("foo_barBaz")
+        "Foo::Bar::Baz"
+    """
+    def __init__(
+        self,
+        input_separators: str = "-_. ",
+        joiner: str = "_",
+        word_case: WordCase = "lower",
+        first_word_case: WordCase | None = None,
+        acronyms: bool = True,
+    ) -> None: ...
+    def __call__(self, s: str) -> str: ...
+    def many(self, items: Iterable[str]) -> list[str]:
+        """Convert every string in an iterable in a single call."""
+        ...
+def transform_keys(obj: Any, case: str, *, depth: int | None = None) -> Any:
+    """Convert the keys of nested dicts, e.g. a decoded JSON payload, in one call.
+
+    Dicts, lists and tuples are walked and rebuilt with every str dict key
+    converted by the named case function; values are left as they are.
+    Dict subclasses such as OrderedDict and defaultdict are read through
+    their items() and come back as plain dicts. Other objects, including
+    list and tuple subclasses such as named tuples, are returned as is.
+    If two keys convert to the same name the later one wins.
+
+    Args:
+        obj (Any): The structure to convert.
+        case (str): Name of a case function, e.g. "snakecase" or "camelcase".
+        depth (int | None): Number of container levels to walk, or None for all.
+
+    Returns:
+        Any: A converted copy of obj.
+
+    Example:
+        >>> transform_keys({"userName": "Bob", "tags": [{"tagName": "x"}]}, "snakecase")
+        {"user_name": "Bob", "tags": [{"tag_name": "x"}]}
+    """
+    ...
+@overload
+def words(s: str) -> list[str]: ...
+@overload
+def words(s: str, *, offsets: Literal[False]) -> list[str]: ...
+@overload
+def words(s: str, *, offsets: Literal[True]) -> list[tuple[int, int]]:
+    """Split a string into the words the case functions see.
+
+    Words end at separators ("-", "_", ".", " "), which are dropped, and
+    before every uppercase letter, so "HTTPServer" is six words; use a
+    Converter for acronym-aware splitting.
+
+    Args:
+        s (str): The string to split.
+        offsets (bool): Return (start, end) index pairs instead of strings.
+
+    Example:
+        >>> words("parse_httpResponse")
+        ["parse", "http", "Response"]
+    """
+    ...
+def convert(s: str, cases: Sequence[str]) -> tuple[str, ...]:
+    """Convert a string into several cases at once.
+
+    The string is split into words once and every word-based case (the
+    snakecase family, titlecase, camelcase and pascalcase) is built from
+    that split; results equal calling each case function separately. Case
+    names may omit their "case" suffix.
+
+    Args:
+        s (str): The string to convert.
+        cases (Sequence[str]): Case function names, e.g. ("snake", "camel").
+
+    Returns:
+        tuple[str, ...]: s in each of the cases, in order.
+
+    Example:
+        >>> db, json, env, label = convert("userId", ("snake", "camel", "const", "title"))
+        >>> env
+        "USER_ID"
+    """
+    ...
+class CaseNormalizedDict(MutableMapping[str, Any]):
+    """A dict whose str keys match whatever case style they are spelled in.
+
+    Keys are compared by their words: runs of letters and digits, split at
+    any other character, before an uppercase letter that follows a
+    non-uppercase one, and before the last capital of a run followed by a
+    lowercase letter. Letters compare case-insensitively, so "userId",
+    "user_id", "USER-ID" and "User Id" are the same key, while "userid" is
+    another. Lookups scan the key in place and allocate nothing. Keys are
+    kept as first inserted. keys(), values() and items() are live views, and
+    == compares with any mapping by key words, so a spelling in another case
+    matches.
+
+    Example:
+        >>> d = CaseNormalizedDict({"userId": 1})
+        >>> d["USER_ID"]
+        1
+    """
+    def __init__(self, other: Any = ..., /, **kwargs: Any) -> None: ...
+    def __getitem__(self, key: str) -> Any: ...
+    def __setitem__(self, key: str, value: Any) -> None: ...
+    def __delitem__(self, key: str) -> None: ...
+    def __iter__(self) -> Iterator[str]: ...
+    def __len__(self) -> int: ...
+    def __eq__(self, other: object) -> bool: ...
+    def keys(self) -> KeysView[str]: ...
+    def values(self) -> ValuesView[Any]: ...
+    def items(self) -> ItemsView[str, Any]: ...
+    def popitem(self) -> tuple[str, Any]: ...
+    def copy(self) -> CaseNormalizedDict: ...
+
+def case_equal(a: str, b: str) -> bool:
+    """Whether two strings spell the same words in any case style.
+
+    Uses the same rules as CaseNormalizedDict and allocates nothing.
+
+    Example:
+        >>> case_equal("parseHTTPResponse", "PARSE_HTTP_RESPONSE")
+        True
+    """
+    ...
+
+def canonical_hash(s: str) -> int:
+    """Hash of the words of a string; equal for strings case_equal() matches."""
+    ...
+
+def detect_case(s: Union[str, BytesLike]) -> Style:
+    """Name of the case style a string is already written in.
+
+    Styles are checked in the order of the Style literal, so a single
+    lowercase word is "snake" and "" is "snake". Strings that fit no style,
+    e.g. with characters outside letters, digits and the style's separator,
+    are "mixed".
+
+    Example:
+        >>> detect_case("userId"), detect_case("USER_ID"), detect_case("user id")
+        ("camel", "const", "mixed")
+    """
+    ...
+
+def detect_case_many(strings: Iterable[Union[str, BytesLike]]) -> list[Style]:
+    """detect_case() for every string of an iterable."""
+    ...
+
+@overload
+def ensure_case(s: str, case: str) -> str: ...
+@overload
+def ensure_case(s: BytesLike, case: str) -> bytes: ...
+def ensure_case(s: Union[str, BytesLike], case: str) -> Union[str, bytes]:
+    """Return s as it is if it is already in the style of case, else convert it.
+
+    Unlike calling the case function, input already in the style is never
+    rewritten, e.g. constcase("HTTP_CODE") splits the capitals but
+    ensure_case("HTTP_CODE", "const") returns it unchanged. Cases with no
+    style of their own (lowercase, uppercase, capitalcase, backslashcase,
+    trimcase, alphanumcase, sentencecase) always convert.
+
+    Args:
+        s: String, or bytes-like object treated as ASCII.
+        case (str): Case function name, e.g. "snakecase" or "snake".
+    """
+    ...
+
+class StreamConverter:
+    """Convert delimiter-separated records, such as lines, fed in chunks of any size.
+
+    Records are UTF-8 text. Each one is converted by the named case
+    function exactly as ``case(record.decode()).encode()`` would, and
+    returned with its delimiter; a record that is not valid UTF-8 raises
+    ValueError and leaves the stream as it was. The unfinished record at the
+    end of a chunk is held until the chunk that completes it, including a
+    delimiter or a character split across two chunks. Memory is bounded by
+    the chunk size and the longest record. Chunks of 64 KiB or more are
+    converted with the GIL released.
+
+    Args:
+        case (str): Case function name, e.g. "snakecase" or "snake".
+        delimiter (bytes): Record delimiter, one or more bytes.
+
+    Example:
+        >>> stream = StreamConverter("snakecase")
+        >>> stream.feed(b"fooBar\nbazQ"), stream.feed(b"ux\n"), stream.flush()
+        (b"foo_bar\n", b"baz_qux\n", b"")
+    """
+    def __init__(self, case: str, delimiter: bytes = b"\n") -> None: ...
+    def feed(self, chunk: BytesLike) -> bytes:
+        """Convert the records the chunk completes, with their delimiters."""
+        ...
+    def flush(self) -> bytes:
+        """Convert and return the final record, which has no delimiter, and start over."""
+        ...
+    @property
+    def pending(self) -> int:
+        """Bytes of the unfinished record held for the next feed()."""
+        ...
+
+def convert_file(
+    src: str | bytes | os.PathLike,
+    dst: str | bytes | os.PathLike,
+    case: str,
+    *,
+    field: int | None = None,
+    delimiter: bytes = b"\n",
+    field_delimiter: bytes = b",",
+    threads: int | None = None,
+) -> int:
+    """Convert every record of a file, or one field of every record, into dst.
+
+    The input is memory-mapped and cut into chunks of whole records, which
+    are converted on native threads with the GIL released and written to
+    dst in order. Records are UTF-8 text, converted as
+    ``case(record.decode()).encode()`` would; the \\r of a CRLF line ending
+    is kept. A record that is not valid UTF-8 stops the conversion with
+    ValueError, leaving dst with the chunks before it. Fields are split on
+    field_delimiter with no quoting, and records with fewer fields are
+    copied as they are. This is what ``python -m fast_stringcase`` runs.
+
+    Args:
+        src: Input file. It must not be dst.
+        dst: Output file, created or truncated.
+        case (str): Case function name, e.g. "snakecase" or "snake".
+        field (int | None): 1-based field to convert, or None for whole records.
+        delimiter (bytes): Record delimiter, one byte.
+        field_delimiter (bytes): Field delimiter, one byte.
+        threads (int | None): Converting threads; the calling thread writes.
+
+    Returns:
+        int: The number of records.
+
+    Example:
+        >>> convert_file("header.csv", "header_snake.csv", "snake", threads=8)
+        1
+    """
+    ...
+
+class ArrowStringArray:
+    """Arrow string array returned by convert_arrow().
+
+    It implements the Arrow PyCapsule interface, so pyarrow.array(),
+    polars.Series() and other Arrow consumers import it without a copy.
+    """
+    def __len__(self) -> int: ...
+    def __arrow_c_array__(self, requested_schema: object | None = None) -> tuple[object, object]:
+        """Export the array as an (ArrowSchema, ArrowArray) pair of PyCapsules."""
+        ...
+def convert_arrow(array: Any, case: str) -> ArrowStringArray:
+    """Convert every row of an Arrow string or large_string column.
+
+    The column is read through ``__arrow_c_array__`` and converted over its
+    UTF-8 data buffer with the GIL released, without creating a Python
+    object per row. Nulls stay null, and the result keeps the input's offset
+    width. No Arrow library is needed at build or run time.
+
+    Args:
+        array (Any): Any object implementing ``__arrow_c_array__``, e.g. a
+            pyarrow.Array or polars.Series of strings.
+        case (str): Name of a case function, e.g. "snakecase" or "camelcase".
+
+    Returns:
+        ArrowStringArray: The converted column.
+
+    Raises:
+        TypeError: If array is not an Arrow string or large_string array.
+        ValueError: If a row is not valid UTF-8.
+
+    Example:
+        >>> pyarrow.array(convert_arrow(pyarrow.array(["fooBar", None]), "snakecase"))
+        ["foo_bar", null]
+    """
+    ...
+def loads(data: str | BytesLike, key_case: str | None = "snake") -> Any:
+    """Decode a JSON document, converting every object key as it is parsed.
+
+    Gives the same result as transform_keys(json.loads(data), key_case) in a
+    single pass: each key is converted straight from the input, and a key
+    that repeats is converted once per call. Values are decoded as by
+    json.loads, including NaN and Infinity. Bytes-like data must be UTF-8,
+    optionally with a BOM.
+
+    Args:
+        data (str | BytesLike): The JSON text.
+        key_case (str | None): Name of a case function, e.g. "snake" or
+            "camelcase", or None to keep keys as they are.
+
+    Returns:
+        Any: The decoded document.
+
+    Raises:
+        json.JSONDecodeError: If data is not valid JSON.
+
+    Example:
+        >>> loads(b'{"userName": "Bob", "tags": [{"tagName": "x"}]}')
+        {"user_name": "Bob", "tags": [{"tag_name": "x"}]}
+    """
+    ...
+def cache_configure(maxsize: int, intern: bool = False, case: str | None = None) -> None:
+    """Cache recent conversions in front of the case functions.
+
+    Each case function keeps its own cache of up to ``maxsize`` inputs
+    (rounded up to a multiple of 4); a repeated input costs one hash lookup.
+    Reconfiguring empties the affected caches.
+
+    Args:
+        maxsize (int): Entries per case function, or 0 to disable caching.
+        intern (bool): Intern every result, so equal results share one object.
+        case (str | None): Configure only this function, e.g. "snakecase".
+
+    Example:
+        >>> cache_configure(4096, intern=True)
+        >>> snakecase("fooBar") is snakecase("fooBar")
+        True
+    """
+    ...
+def cache_info() -> dict[str, tuple[int, int, int, int]]:
+    """Report the conversion caches.
+
+    Returns:
+        dict[str, tuple[int, int, int, int]]: ``(hits, misses, maxsize, currsize)``
+        for every case function, keyed by its name.
+    """
+    ...
+def cache_clear() -> None:
+    """Empty every conversion cache and reset its counters, keeping its size."""
+    ...
+def enable_stats(enabled: bool = True) -> bool:
+    """Turn recording of per-function statistics on or off.
+
+    Recording is off by default, or on from import when the environment
+    variable ``FAST_STRINGCASE_STATS`` is ``1``. While it is off the case
+    functions skip all bookkeeping.
+
+    Returns:
+        bool: Whether recording was on before the call.
+    """
+    ...
+def stats() -> dict[str, dict[str, Any]]:
+    """Report the counters recorded since the last reset_stats().
+
+    Returns:
+        dict[str, dict[str, Any]]: For every case function, keyed by its name:
+        ``calls`` (of name, name_many and name_inplace), ``strings`` converted,
+        ``input_bytes`` and ``output_bytes`` (str storage size for str),
+        ``allocations`` (result objects and scratch growth), ``cache_hits``,
+        ``time_ns`` spent in calls, and ``latency``, a histogram of call
+        durations from ``"<1us"`` to ``">=100ms"``. Strings converted by
+        transform_keys count towards the case function it used.
+    """
+    ...
+def reset_stats() -> None:
+    """Zero every statistics counter, leaving recording on or off."""
+    ...
+
+# Capsule holding the FastStringcase_CAPI table of fast_stringcase_capi.h,
+# for C extensions; see fast_stringcase.get_include()
+_C_API: object
@@ -0,0 +1,91 @@
+// C API of the fast_stringcase extension, for other extensions that convert
+// case on their own hot paths. The module publishes a FastStringcase_CAPI
+// table as the capsule fast_stringcase._C_API; import it once, then call
+// through it with no Python-level dispatch:
+//
+//     #include "fast_stringcase_capi.h"  // -I fast_stringcase.get_include()
+//
+//     if (FastStringcase_Import() < 0) { return NULL; }  // In PyInit
+//     char out[64];
+//     Py_ssize_t n = FastStringcaseAPI->convert_buffer(FAST_STRINGCASE_SNAKECASE, "userId", 6, out, sizeof(out));
+//
+// Versions only ever add fields at the end of the table, so an extension
+// built against this header works with any module whose version is at least
+// FAST_STRINGCASE_CAPI_VERSION.
+
+#ifndef FAST_STRINGCASE_CAPI_H
+#define FAST_STRINGCASE_CAPI_H
+
+#include <Python.h>
+
+#define FAST_STRINGCASE_CAPI_VERSION 1
+#define FAST_STRINGCASE_CAPSULE_NAME "fast_stringcase._C_API"
+
+// Case numbers, as taken by every function in the table
+#define FAST_STRINGCASE_LOWERCASE 0
+#define FAST_STRINGCASE_UPPERCASE 1
+#define FAST_STRINGCASE_SNAKECASE 2
+#define FAST_STRINGCASE_CAMELCASE 3
+#define FAST_STRINGCASE_CAPITALCASE 4
+#define FAST_STRINGCASE_PASCALCASE 5
+#define FAST_STRINGCASE_CONSTCASE 6
+#define FAST_STRINGCASE_PATHCASE 7
+#define FAST_STRINGCASE_BACKSLASHCASE 8
+#define FAST_STRINGCASE_SPINALCASE 9
+#define FAST_STRINGCASE_DOTCASE 10
+#define FAST_STRINGCASE_TITLECASE 11
+#define FAST_STRINGCASE_TRIMCASE 12
+#define FAST_STRINGCASE_ALPHANUMCASE 13
+#define FAST_STRINGCASE_SENTENCECASE 14
+#define FAST_STRINGCASE_CASE_COUNT 15
+
+typedef struct {
+    int version;     // FAST_STRINGCASE_CAPI_VERSION the module was built with
+    int case_count;  // Cases the module knows; case numbers run below it
+
+    // Case number for a name such as "snakecase" or "snake", or -1 with
+    // ValueError set. Needs the GIL.
+    int (*find_case)(const char* name);
+
+    // Raw kernels over bytes, which are treated as ASCII as by the Python
+    // functions. They touch no Python object and may be called without the
+    // GIL. Both return -1 for an unknown case or a negative length.
+
+    // Length of the converted input
+    Py_ssize_t (*measure)(int case_number, const char* input, Py_ssize_t len);
+    // Write the converted input to output, which must not overlap it, and
+    // return its length. If that exceeds capacity, nothing is written and
+    // the needed capacity is returned. No NUL is appended.
+    Py_ssize_t (*convert_buffer)(int case_number, const char* input, Py_ssize_t len, char* output,
+                                 Py_ssize_t capacity);
+
+    // The Python-level functions, without the conversion cache. convert()
+    // takes a str (returning str) or a bytes-like object (returning bytes);
+    // convert_many() takes any iterable of str and returns a list. Both
+    // return a new reference, or NULL with an exception set, and need the
+    // GIL.
+    PyObject* (*convert)(int case_number, PyObject* obj);
+    PyObject* (*convert_many)(int case_number, PyObject* items);
+} FastStringcase_CAPI;
+
+#ifndef FAST_STRINGCASE_MODULE
+
+// Set by FastStringcase_Import(), in each translation unit that includes this
+static const FastStringcase_CAPI* FastStringcaseAPI;
+
+// Import the C API. Returns 0, or -1 with an exception set.
+static inline int FastStringcase_Import(void) {
+    const FastStringcase_CAPI* api = (const FastStringcase_CAPI*)PyCapsule_Import(FAST_STRINGCASE_CAPSULE_NAME, 0);
+    if (!api) { return -1; }
+    if (api->version < FAST_STRINGCASE_CAPI_VERSION) {
+        PyErr_Format(PyExc_ImportError, "fast_stringcase C API version %d is older than the %d this was built for",
+                     api->version, FAST_STRINGCASE_CAPI_VERSION);
+        return -1;
+    }
+    FastStringcaseAPI = api;
+    return 0;
+}
+
+#endif // FAST_STRINGCASE_MODULE
+
+#endif // FAST_STRINGCASE_CAPI_H
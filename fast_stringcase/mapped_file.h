@@ -0,0 +1,219 @@
+// Read-only memory-mapped input and unbuffered sequential output for
+// convert_file(). Opening and closing need the GIL and set OSError;
+// output_write() may be called without it and records the error code for
+// output_error() to raise afterwards.
+//
+// Paths are the objects produced by PyUnicode_FSConverter (bytes) on POSIX
+// and PyUnicode_FSDecoder (str) on Windows; see MAPPED_PATH_CONVERTER.
+
+#ifndef FAST_STRINGCASE_MAPPED_FILE_H
+#define FAST_STRINGCASE_MAPPED_FILE_H
+
+#include <Python.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#define MAPPED_PATH_CONVERTER PyUnicode_FSDecoder
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MAPPED_PATH_CONVERTER PyUnicode_FSConverter
+#endif
+
+typedef struct {
+    const char* data;  // NULL for an empty file
+    Py_ssize_t size;
+#if defined(_WIN32)
+    HANDLE file;
+    HANDLE mapping;
+#else
+    int fd;
+#endif
+} MappedFile;
+
+typedef struct {
+#if defined(_WIN32)
+    HANDLE file;
+    DWORD error;       // Of the first failed write
+#else
+    int fd;
+    int error;
+#endif
+} OutputFile;
+
+#if defined(_WIN32)
+
+static int mapped_open(MappedFile* mapped, PyObject* path) {
+    mapped->data = NULL;
+    mapped->size = 0;
+    mapped->mapping = NULL;
+    wchar_t* wide = PyUnicode_AsWideCharString(path, NULL);
+    if (!wide) { return -1; }
+    mapped->file = CreateFileW(wide, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN,
+                               NULL);
+    PyMem_Free(wide);
+    if (mapped->file == INVALID_HANDLE_VALUE) { goto error; }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(mapped->file, &size)) { goto error; }
+    if ((unsigned long long)size.QuadPart > (unsigned long long)PY_SSIZE_T_MAX) {
+        CloseHandle(mapped->file);
+        PyErr_SetString(PyExc_OverflowError, "input file is too large to map");
+        return -1;
+    }
+    mapped->size = (Py_ssize_t)size.QuadPart;
+    if (mapped->size == 0) { return 0; }
+    mapped->mapping = CreateFileMappingW(mapped->file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mapped->mapping) { goto error; }
+    mapped->data = (const char*)MapViewOfFile(mapped->mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!mapped->data) { goto error; }
+    return 0;
+
+error:
+    PyErr_SetExcFromWindowsErrWithFilenameObject(PyExc_OSError, GetLastError(), path);
+    if (mapped->mapping) { CloseHandle(mapped->mapping); }
+    if (mapped->file != INVALID_HANDLE_VALUE) { CloseHandle(mapped->file); }
+    return -1;
+}
+
+static void mapped_close(MappedFile* mapped) {
+    if (mapped->data) { UnmapViewOfFile(mapped->data); }
+    if (mapped->mapping) { CloseHandle(mapped->mapping); }
+    CloseHandle(mapped->file);
+}
+
+// Create or truncate the output. The input is open without write sharing,
+// so naming it as the output fails here rather than corrupting it.
+static int output_open(OutputFile* output, PyObject* path, const MappedFile* input) {
+    (void)input;
+    output->error = 0;
+    wchar_t* wide = PyUnicode_AsWideCharString(path, NULL);
+    if (!wide) { return -1; }
+    output->file = CreateFileW(wide, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    PyMem_Free(wide);
+    if (output->file == INVALID_HANDLE_VALUE) {
+        PyErr_SetExcFromWindowsErrWithFilenameObject(PyExc_OSError, GetLastError(), path);
+        return -1;
+    }
+    return 0;
+}
+
+// Write all of data; returns 0, or -1 with the error recorded
+static int output_write(OutputFile* output, const char* data, Py_ssize_t len) {
+    while (len > 0) {
+        DWORD part = len > (1 << 30) ? (1 << 30) : (DWORD)len;
+        DWORD written;
+        if (!WriteFile(output->file, data, part, &written, NULL)) {
+            output->error = GetLastError();
+            return -1;
+        }
+        data += written;
+        len -= written;
+    }
+    return 0;
+}
+
+static int output_close(OutputFile* output) {
+    if (!CloseHandle(output->file) && !output->error) { output->error = GetLastError(); }
+    return output->error ? -1 : 0;
+}
+
+static void output_error(const OutputFile* output, PyObject* path) {
+    PyErr_SetExcFromWindowsErrWithFilenameObject(PyExc_OSError, output->error, path);
+}
+
+#else
+
+// OSError from errno for a path as given to PyUnicode_FSConverter
+static void mapped_path_error(PyObject* path) {
+    int saved = errno;
+    PyObject* name = PyUnicode_DecodeFSDefaultAndSize(PyBytes_AS_STRING(path), PyBytes_GET_SIZE(path));
+    errno = saved;
+    PyErr_SetFromErrnoWithFilenameObject(PyExc_OSError, name ? name : path);
+    Py_XDECREF(name);
+}
+
+static int mapped_open(MappedFile* mapped, PyObject* path) {
+    mapped->data = NULL;
+    mapped->size = 0;
+    mapped->fd = open(PyBytes_AS_STRING(path), O_RDONLY);
+    struct stat st;
+    if (mapped->fd < 0 || fstat(mapped->fd, &st) < 0) { goto error; }
+    if ((unsigned long long)st.st_size > (unsigned long long)PY_SSIZE_T_MAX) {
+        close(mapped->fd);
+        PyErr_SetString(PyExc_OverflowError, "input file is too large to map");
+        return -1;
+    }
+    mapped->size = (Py_ssize_t)st.st_size;
+    if (mapped->size == 0) { return 0; }
+    void* data = mmap(NULL, (size_t)mapped->size, PROT_READ, MAP_PRIVATE, mapped->fd, 0);
+    if (data == MAP_FAILED) { goto error; }
+#if defined(MADV_SEQUENTIAL)
+    madvise(data, (size_t)mapped->size, MADV_SEQUENTIAL);
+#endif
+    mapped->data = (const char*)data;
+    return 0;
+
+error:
+    mapped_path_error(path);
+    if (mapped->fd >= 0) { close(mapped->fd); }
+    return -1;
+}
+
+static void mapped_close(MappedFile* mapped) {
+    if (mapped->data) { munmap((void*)mapped->data, (size_t)mapped->size); }
+    close(mapped->fd);
+}
+
+// Create or truncate the output, refusing the input file itself: truncating
+// it would pull the pages out from under the mapping.
+static int output_open(OutputFile* output, PyObject* path, const MappedFile* input) {
+    output->error = 0;
+    output->fd = open(PyBytes_AS_STRING(path), O_WRONLY | O_CREAT, 0666);
+    struct stat out_st, in_st;
+    if (output->fd < 0 || fstat(output->fd, &out_st) < 0 || fstat(input->fd, &in_st) < 0) { goto error; }
+    if (out_st.st_dev == in_st.st_dev && out_st.st_ino == in_st.st_ino) {
+        close(output->fd);
+        PyErr_SetString(PyExc_ValueError, "input and output are the same file");
+        return -1;
+    }
+    if (S_ISREG(out_st.st_mode) && ftruncate(output->fd, 0) < 0) { goto error; }
+    return 0;
+
+error:
+    mapped_path_error(path);
+    if (output->fd >= 0) { close(output->fd); }
+    return -1;
+}
+
+// Write all of data; returns 0, or -1 with the error recorded
+static int output_write(OutputFile* output, const char* data, Py_ssize_t len) {
+    while (len > 0) {
+        // Some systems reject single writes of 2 GiB or more
+        ssize_t written = write(output->fd, data, (size_t)(len > (1 << 30) ? (1 << 30) : len));
+        if (written < 0) {
+            if (errno == EINTR) { continue; }
+            output->error = errno;
+            return -1;
+        }
+        data += written;
+        len -= written;
+    }
+    return 0;
+}
+
+static int output_close(OutputFile* output) {
+    if (close(output->fd) < 0 && !output->error) { output->error = errno; }
+    return output->error ? -1 : 0;
+}
+
+static void output_error(const OutputFile* output, PyObject* path) {
+    errno = output->error;
+    mapped_path_error(path);
+}
+
+#endif
+
+#endif // FAST_STRINGCASE_MAPPED_FILE_H
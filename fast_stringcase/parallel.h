@@ -0,0 +1,261 @@
+// Minimal fork-join helper for the parallel batch functions: runs a task
+// over [0, count) in fixed-size chunks on a pool of native threads, handing
+// out chunks through an atomic counter so uneven string lengths still
+// balance.
+//
+// Tasks run without the GIL and must not touch Python objects beyond
+// reading immutable data the caller keeps alive.
+
+#ifndef FAST_STRINGCASE_PARALLEL_H
+#define FAST_STRINGCASE_PARALLEL_H
+
+#include <Python.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <process.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#define PARALLEL_MAX_THREADS 256
+
+typedef void (*parallel_task)(void* arg, Py_ssize_t start, Py_ssize_t end);
+
+typedef struct {
+    volatile Py_ssize_t next; // First index not yet handed out
+    Py_ssize_t count;
+    Py_ssize_t chunk;
+    parallel_task task;
+    void* arg;
+} ParallelJob;
+
+static inline Py_ssize_t parallel_claim(ParallelJob* job) {
+#if defined(_MSC_VER)
+#if defined(_WIN64)
+    return (Py_ssize_t)InterlockedExchangeAdd64((volatile LONG64*)&job->next, (LONG64)job->chunk);
+#else
+    return (Py_ssize_t)InterlockedExchangeAdd((volatile LONG*)&job->next, (LONG)job->chunk);
+#endif
+#else
+    return __atomic_fetch_add(&job->next, job->chunk, __ATOMIC_RELAXED);
+#endif
+}
+
+static void parallel_work(ParallelJob* job) {
+    for (;;) {
+        Py_ssize_t start = parallel_claim(job);
+        if (start >= job->count) { return; }
+        Py_ssize_t end = job->count - start > job->chunk ? start + job->chunk : job->count;
+        job->task(job->arg, start, end);
+    }
+}
+
+// --- Thread Pool ---
+//
+// Helper threads are started the first time a batch asks for them and kept
+// until the module is freed, so a call pays for a wake-up rather than for
+// creating and joining threads. Groups waiting for helpers queue on
+// `pending`; an idle helper takes a slot from the first one and works on
+// its job until every chunk has been handed out.
+
+#if defined(_WIN32)
+typedef SRWLOCK parallel_mutex;
+typedef CONDITION_VARIABLE parallel_cond;
+typedef HANDLE parallel_thread_t;
+#define parallel_mutex_init(m) InitializeSRWLock(m)
+#define parallel_mutex_destroy(m) ((void)(m))
+#define parallel_lock(m) AcquireSRWLockExclusive(m)
+#define parallel_unlock(m) ReleaseSRWLockExclusive(m)
+#define parallel_cond_init(c) InitializeConditionVariable(c)
+#define parallel_cond_destroy(c) ((void)(c))
+#define parallel_wait(c, m) SleepConditionVariableSRW(c, m, INFINITE, 0)
+#define parallel_broadcast(c) WakeAllConditionVariable(c)
+#else
+typedef pthread_mutex_t parallel_mutex;
+typedef pthread_cond_t parallel_cond;
+typedef pthread_t parallel_thread_t;
+#define parallel_mutex_init(m) pthread_mutex_init(m, NULL)
+#define parallel_mutex_destroy(m) pthread_mutex_destroy(m)
+#define parallel_lock(m) pthread_mutex_lock(m)
+#define parallel_unlock(m) pthread_mutex_unlock(m)
+#define parallel_cond_init(c) pthread_cond_init(c, NULL)
+#define parallel_cond_destroy(c) pthread_cond_destroy(c)
+#define parallel_wait(c, m) pthread_cond_wait(c, m)
+#define parallel_broadcast(c) pthread_cond_broadcast(c)
+#endif
+
+struct ParallelGroup;
+
+typedef struct {
+    parallel_mutex lock;   // Guards everything below
+    parallel_cond wake;    // A group was queued, or the pool is stopping
+    parallel_cond left;    // A helper finished with its group
+    struct ParallelGroup* pending; // Groups with helper slots left, oldest first
+    int wanted;            // Helper slots left over all pending groups
+    int available;         // Helpers not working on a group
+    int started;
+    int stopping;
+    int ready;             // parallel_pool_init() has run
+#if !defined(_WIN32)
+    pid_t pid;             // A forked child has none of its parent's helpers
+#endif
+    parallel_thread_t threads[PARALLEL_MAX_THREADS];
+} ParallelPool;
+
+// A job running on helper threads while the calling thread does other work
+typedef struct ParallelGroup {
+    ParallelJob job;
+    ParallelPool* pool;         // NULL if no helper was asked for
+    struct ParallelGroup* next; // In pool->pending
+    int wanted;                 // Helper slots not yet taken
+    int running;                // Helpers working on the job
+} ParallelGroup;
+
+static void parallel_pool_reset(ParallelPool* pool) {
+    parallel_mutex_init(&pool->lock);
+    parallel_cond_init(&pool->wake);
+    parallel_cond_init(&pool->left);
+    pool->pending = NULL;
+    pool->wanted = pool->available = pool->started = pool->stopping = 0;
+#if !defined(_WIN32)
+    pool->pid = getpid();
+#endif
+}
+
+static void parallel_pool_init(ParallelPool* pool) {
+    parallel_pool_reset(pool);
+    pool->ready = 1;
+}
+
+static void parallel_helper(ParallelPool* pool) {
+    parallel_lock(&pool->lock);
+    while (!pool->stopping) {
+        ParallelGroup* group = pool->pending;
+        if (!group) {
+            parallel_wait(&pool->wake, &pool->lock);
+            continue;
+        }
+        group->running++;
+        pool->available--;
+        pool->wanted--;
+        if (--group->wanted == 0) { pool->pending = group->next; }
+        parallel_unlock(&pool->lock);
+        parallel_work(&group->job);
+        parallel_lock(&pool->lock);
+        pool->available++;
+        if (--group->running == 0) { parallel_broadcast(&pool->left); }
+    }
+    parallel_unlock(&pool->lock);
+}
+
+#if defined(_WIN32)
+static unsigned __stdcall parallel_thread(void* pool) {
+    parallel_helper((ParallelPool*)pool);
+    return 0;
+}
+#else
+static void* parallel_thread(void* pool) {
+    parallel_helper((ParallelPool*)pool);
+    return NULL;
+}
+#endif
+
+// Stop and join every helper. The pool must have no groups left.
+static void parallel_pool_free(ParallelPool* pool) {
+    if (!pool->ready) { return; }
+    pool->ready = 0;
+#if !defined(_WIN32)
+    if (pool->pid != getpid()) { return; }
+#endif
+    parallel_lock(&pool->lock);
+    pool->stopping = 1;
+    parallel_broadcast(&pool->wake);
+    parallel_unlock(&pool->lock);
+    for (int i = 0; i < pool->started; ++i) {
+#if defined(_WIN32)
+        WaitForSingleObject(pool->threads[i], INFINITE);
+        CloseHandle(pool->threads[i]);
+#else
+        pthread_join(pool->threads[i], NULL);
+#endif
+    }
+    parallel_cond_destroy(&pool->left);
+    parallel_cond_destroy(&pool->wake);
+    parallel_mutex_destroy(&pool->lock);
+}
+
+// Start task over [0, count) on up to nthreads - 1 of the pool's helpers
+// and return at once; parallel_join() has the calling thread make up the
+// last one. The group must stay where it is until joined.
+static void parallel_start(ParallelPool* pool, ParallelGroup* group, Py_ssize_t count, Py_ssize_t chunk,
+                           int nthreads, parallel_task task, void* arg) {
+    ParallelJob job = {0, count, chunk, task, arg};
+    group->job = job;
+    group->pool = NULL;
+    group->next = NULL;
+    group->wanted = group->running = 0;
+    Py_ssize_t chunks = (count + chunk - 1) / chunk;
+    if (nthreads > chunks) { nthreads = (int)chunks; }
+    if (nthreads > PARALLEL_MAX_THREADS) { nthreads = PARALLEL_MAX_THREADS; }
+    if (nthreads < 2) { return; }
+
+#if !defined(_WIN32)
+    // Only the forking thread survives in the child, so nothing holds the lock
+    if (pool->pid != getpid()) { parallel_pool_reset(pool); }
+#endif
+    parallel_lock(&pool->lock);
+    group->pool = pool;
+    group->wanted = nthreads - 1;
+    pool->wanted += group->wanted;
+    ParallelGroup** tail = &pool->pending;
+    while (*tail) { tail = &(*tail)->next; }
+    *tail = group;
+    // Enough helpers for every slot; if one cannot be started the
+    // callers pick up its share
+    while (pool->wanted > pool->available && pool->started < PARALLEL_MAX_THREADS) {
+#if defined(_WIN32)
+        uintptr_t handle = _beginthreadex(NULL, 0, parallel_thread, pool, 0, NULL);
+        if (!handle) { break; }
+        pool->threads[pool->started++] = (HANDLE)handle;
+#else
+        if (pthread_create(&pool->threads[pool->started], NULL, parallel_thread, pool) != 0) { break; }
+        pool->started++;
+#endif
+        pool->available++;
+    }
+    parallel_broadcast(&pool->wake);
+    parallel_unlock(&pool->lock);
+}
+
+// Work on the group's task until it is done, then wait for the helpers
+// still finishing a chunk. Slots no helper took by then are withdrawn.
+static void parallel_join(ParallelGroup* group) {
+    parallel_work(&group->job);
+    ParallelPool* pool = group->pool;
+    if (!pool) { return; }  // Never queued
+    parallel_lock(&pool->lock);
+    if (group->wanted) {
+        ParallelGroup** link = &pool->pending;
+        while (*link != group) { link = &(*link)->next; }
+        *link = group->next;
+        pool->wanted -= group->wanted;
+        group->wanted = 0;
+    }
+    while (group->running) {
+        parallel_wait(&pool->left, &pool->lock);
+    }
+    parallel_unlock(&pool->lock);
+}
+
+// Run task over [0, count) on up to nthreads threads, the calling thread
+// included. If a helper cannot be started the others pick up its share.
+static void parallel_for(ParallelPool* pool, Py_ssize_t count, Py_ssize_t chunk, int nthreads, parallel_task task,
+                         void* arg) {
+    ParallelGroup group;
+    parallel_start(pool, &group, count, chunk, nthreads, task, arg);
+    parallel_join(&group);
+}
+
+#endif // FAST_STRINGCASE_PARALLEL_H
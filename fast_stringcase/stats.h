@@ -0,0 +1,99 @@
+// Counters behind fast_stringcase.stats(): atomic 64-bit adds, so they stay
+// exact when conversions run without the GIL, and a monotonic clock for the
+// latency histogram. Recording is off unless enabled at run time, which
+// costs one branch per call.
+
+#ifndef FAST_STRINGCASE_STATS_H
+#define FAST_STRINGCASE_STATS_H
+
+#include <stdint.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+// Latency buckets are decades from 1us to 100ms, plus one for anything slower
+#define STATS_LATENCY_BUCKETS 7
+
+typedef struct {
+    volatile int64_t calls;         // Calls of name, name_many and name_inplace
+    volatile int64_t strings;       // Strings and buffers converted
+    volatile int64_t input_bytes;
+    volatile int64_t output_bytes;
+    volatile int64_t allocations;   // Result objects and scratch buffer growth
+    volatile int64_t cache_hits;
+    volatile int64_t time_ns;       // Total time spent in calls
+    volatile int64_t latency[STATS_LATENCY_BUCKETS];
+} CaseStats;
+
+static volatile int stats_enabled;
+
+static inline void stats_add(volatile int64_t* counter, int64_t value) {
+#if defined(_MSC_VER)
+    InterlockedExchangeAdd64((volatile LONG64*)counter, (LONG64)value);
+#else
+    __atomic_fetch_add(counter, value, __ATOMIC_RELAXED);
+#endif
+}
+
+static inline int64_t stats_load(volatile int64_t* counter) {
+#if defined(_MSC_VER)
+    return (int64_t)InterlockedCompareExchange64((volatile LONG64*)counter, 0, 0);
+#else
+    return __atomic_load_n(counter, __ATOMIC_RELAXED);
+#endif
+}
+
+static inline void stats_store(volatile int64_t* counter, int64_t value) {
+#if defined(_MSC_VER)
+    InterlockedExchange64((volatile LONG64*)counter, (LONG64)value);
+#else
+    __atomic_store_n(counter, value, __ATOMIC_RELAXED);
+#endif
+}
+
+// Nanoseconds from an arbitrary fixed point
+static inline int64_t stats_now(void) {
+#if defined(_WIN32)
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    if (!frequency.QuadPart) { QueryPerformanceFrequency(&frequency); }
+    QueryPerformanceCounter(&counter);
+    return (int64_t)((double)counter.QuadPart * 1e9 / (double)frequency.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+// Start timing a call; 0 when recording is off
+static inline int64_t stats_begin(void) {
+    return stats_enabled ? stats_now() : 0;
+}
+
+// Count a call started by stats_begin
+static inline void stats_end(CaseStats* stats, int64_t start) {
+    if (!start) { return; }
+    int64_t elapsed = stats_now() - start;
+    int bucket = 0;
+    for (int64_t bound = 1000; bucket < STATS_LATENCY_BUCKETS - 1 && elapsed >= bound; bound *= 10) {
+        bucket++;
+    }
+    stats_add(&stats->calls, 1);
+    stats_add(&stats->time_ns, elapsed);
+    stats_add(&stats->latency[bucket], 1);
+}
+
+// Count converted strings or buffers
+static inline void stats_convert(CaseStats* stats, int64_t strings, int64_t input_bytes, int64_t output_bytes,
+                                 int64_t allocations) {
+    stats_add(&stats->strings, strings);
+    stats_add(&stats->input_bytes, input_bytes);
+    stats_add(&stats->output_bytes, output_bytes);
+    stats_add(&stats->allocations, allocations);
+}
+
+#endif // FAST_STRINGCASE_STATS_H
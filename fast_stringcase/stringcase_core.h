@@ -0,0 +1,743 @@
+// Header-only conversion core of fast_stringcase, independent of CPython.
+//
+// Everything needed to convert text lives here: the ASCII kernels with
+// their measure functions and normalization checks, and the per-width
+// Unicode kernels. The Python module (fast_stringcase.c) is a binding over
+// these functions, and C or C++ programs can include this header directly.
+// It is plain C99 that also compiles as C++. Call cc_select() once to pick
+// the vector kernels; until then the portable scalar code is used.
+//
+// For every case NAME there is:
+//   NAME_kernel(string, len, out)    ASCII bytes to ASCII bytes; `out` needs
+//                                    NAME's measure(string, len) + 1 bytes
+//   *_measure(string, len)           exact output length of the kernel
+//   NAME_normalized(string, len)     1 when the kernel would copy its input
+//   uk_NAME_ucs1/ucs2/ucs4(data, len, out)
+//                                    code units of that width to UTF-32;
+//                                    `out` needs room for UK_MAX_OUT * len
+// and utf8_is_ascii/utf8_convert to take UTF-8 text through the ucs4
+// kernels, word_spans with the words_* emitters to produce several cases
+// from one split, and style_classes/style_detect to tell which case style
+// a string is already in.
+
+#ifndef FAST_STRINGCASE_STRINGCASE_CORE_H
+#define FAST_STRINGCASE_STRINGCASE_CORE_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include "charclass.h"
+#include "unicase.h"
+
+// --- Kernels ---
+//
+// Each kernel converts `len` ASCII bytes from `string` into `out` and returns the
+// number of bytes written. Every kernel has a matching measure function that
+// returns that exact count without writing, so the result can be allocated
+// at its final size and the kernel can write straight into it. `out` always
+// has room for one more byte (the str terminator), which a kernel may use as
+// scratch; callers rewrite it afterwards.
+//
+// Long inputs are handed to the vector primitives in charclass.h (cc_ops)
+// wherever a block can be converted without per-byte decisions; the scalar
+// loops handle everything else and are the whole path without SIMD.
+
+// Number of bytes to process with scalar code before retrying a vector run
+static inline fsc_ssize_t scalar_stop(fsc_ssize_t i, fsc_ssize_t len) {
+    fsc_ssize_t width = cc_ops->width;
+    return width && len - i > width ? i + width : len;
+}
+
+// Equivalent to Python's lowercase(string)
+static inline fsc_ssize_t lowercase_kernel(const char* string, fsc_ssize_t len, char* out) {
+    cc_ops->lower(string, len, out);
+    return len;
+}
+
+// Equivalent to Python's uppercase(string)
+static inline fsc_ssize_t uppercase_kernel(const char* string, fsc_ssize_t len, char* out) {
+    cc_ops->upper(string, len, out);
+    return len;
+}
+
+// Shared single-pass kernel for snakecase and the cases derived from it.
+// Python: re.sub(r"_", joiner, snakecase(string)), with the result optionally
+// upper-cased, computed without materializing the snakecase intermediate.
+static inline fsc_ssize_t snake_joined_kernel(const char* string, fsc_ssize_t len, char* out,
+                                              char joiner, int upper) {
+    if (len == 0) { return 0; }
+
+    // Lowercase first char
+    unsigned char first_char = (unsigned char)string[0];
+    fsc_ssize_t result_idx = 0;
+    out[result_idx++] = is_snake_separator(first_char) ? joiner
+                        : upper ? ascii_toupper(first_char) : ascii_tolower(first_char);
+
+    fsc_ssize_t i = 1;
+    while (i < len) {
+        if (cc_ops->width && len - i >= cc_ops->width) {
+            fsc_ssize_t run = cc_ops->snake_run(string + i, len - i, out + result_idx, joiner, upper);
+            i += run;
+            result_idx += run;
+        }
+        for (fsc_ssize_t stop = scalar_stop(i, len); i < stop; ++i) {
+            unsigned char current_char = (unsigned char)string[i];
+            if (is_snake_separator(current_char)) {
+                out[result_idx++] = joiner;
+            } else if (ascii_isupper(current_char)) {
+                // Prepend the joiner for uppercase letters after index 0
+                out[result_idx++] = joiner;
+                out[result_idx++] = upper ? current_char : ascii_tolower(current_char);
+            } else {
+                out[result_idx++] = upper ? ascii_toupper(current_char) : current_char;
+            }
+        }
+    }
+    return result_idx;
+}
+
+// Equivalent to Python's snakecase(string)
+// string = re.sub(r"[\-\.\s]", '_', str(string))
+// return lowercase(string[0]) + re.sub(r"[A-Z]", lambda matched: '_' + lowercase(matched.group(0)), string[1:])
+static inline fsc_ssize_t snakecase_kernel(const char* string, fsc_ssize_t len, char* out) {
+    return snake_joined_kernel(string, len, out, '_', 0);
+}
+
+// Shared kernel for camelcase and pascalcase; only the first character differs.
+static inline fsc_ssize_t camel_kernel(const char* string, fsc_ssize_t len, char* out, int capitalize_first) {
+    fsc_ssize_t result_idx = 0;
+    int capitalize_next = 0; // Flag to capitalize the next *alphanumeric* character
+
+    // Process the string character by character
+    fsc_ssize_t i = 0;
+    while (i < len) {
+        // Alphanumeric runs in the middle of a word are copied unchanged
+        if (cc_ops->width && len - i >= cc_ops->width && result_idx > 0 && !capitalize_next) {
+            fsc_ssize_t run = cc_ops->span_alnum(string + i, len - i);
+            memcpy(out + result_idx, string + i, run);
+            i += run;
+            result_idx += run;
+        }
+        for (fsc_ssize_t stop = scalar_stop(i, len); i < stop; ++i) {
+            unsigned char current_char = (unsigned char)string[i];
+
+            if (is_snake_separator(current_char)) {
+                capitalize_next = 1; // Mark next alphanumeric to be capitalized
+            } else if (ascii_isalnum(current_char)) {
+                if (result_idx == 0) { // First character of the result string
+                    out[result_idx++] = capitalize_first ? ascii_toupper(current_char)
+                                                         : ascii_tolower(current_char);
+                } else if (capitalize_next) {
+                    out[result_idx++] = ascii_toupper(current_char);
+                    capitalize_next = 0; // Reset flag
+                } else {
+                    // Preserve existing case if not after separator
+                    out[result_idx++] = current_char;
+                }
+            }
+            // Ignore other characters
+        }
+    }
+    return result_idx;
+}
+
+// Equivalent to Python's camelcase(string)
+// string = re.sub(r"\w[\s\W]+\w", '', str(string)) # Skipping this complex regex part
+// return lowercase(string[0]) + re.sub(r"[\-_\.\s]([a-z])", lambda matched: uppercase(matched.group(1)), string[1:])
+static inline fsc_ssize_t camelcase_kernel(const char* string, fsc_ssize_t len, char* out) {
+    return camel_kernel(string, len, out, 0);
+}
+
+// Equivalent to Python's capitalcase(string)
+// return uppercase(string[0]) + string[1:]
+static inline fsc_ssize_t capitalcase_kernel(const char* string, fsc_ssize_t len, char* out) {
+    if (len == 0) { return 0; }
+    out[0] = ascii_toupper((unsigned char)string[0]);
+    if (len > 1) {
+        memcpy(out + 1, string + 1, len - 1);
+    }
+    return len;
+}
+
+// Equivalent to Python's pascalcase(string)
+// return capitalcase(camelcase(string))
+static inline fsc_ssize_t pascalcase_kernel(const char* string, fsc_ssize_t len, char* out) {
+    return camel_kernel(string, len, out, 1);
+}
+
+// Equivalent to Python's constcase(string)
+// return uppercase(snakecase(string))
+static inline fsc_ssize_t constcase_kernel(const char* string, fsc_ssize_t len, char* out) {
+    return snake_joined_kernel(string, len, out, '_', 1);
+}
+
+// Equivalent to Python's pathcase(string)
+// string = snakecase(string)
+// return re.sub(r"_", "/", string)
+static inline fsc_ssize_t pathcase_kernel(const char* string, fsc_ssize_t len, char* out) {
+    return snake_joined_kernel(string, len, out, '/', 0);
+}
+
+// Equivalent to Python's backslashcase(string)
+// str1 = re.sub(r"_", r"\\", snakecase(string))
+static inline fsc_ssize_t backslashcase_kernel(const char* string, fsc_ssize_t len, char* out) {
+    return snake_joined_kernel(string, len, out, '\\', 0);
+}
+
+// Equivalent to Python's spinalcase(string)
+// return re.sub(r"_", "-", snakecase(string))
+static inline fsc_ssize_t spinalcase_kernel(const char* string, fsc_ssize_t len, char* out) {
+    return snake_joined_kernel(string, len, out, '-', 0);
+}
+
+// Equivalent to Python's dotcase(string)
+// return re.sub(r"_", ".", snakecase(string))
+static inline fsc_ssize_t dotcase_kernel(const char* string, fsc_ssize_t len, char* out) {
+    return snake_joined_kernel(string, len, out, '.', 0);
+}
+
+// Equivalent to Python's titlecase(string)
+// return ' '.join([capitalcase(word) for word in snakecase(string).split("_")])
+// Every snakecase underscore becomes a space and starts a new word, so an
+// uppercase letter after index 0 is emitted as ' ' followed by itself.
+static inline fsc_ssize_t titlecase_kernel(const char* string, fsc_ssize_t len, char* out) {
+    fsc_ssize_t result_idx = 0;
+    int capitalize_next = 1; // Capitalize first letter of first word
+
+    fsc_ssize_t i = 0;
+    while (i < len) {
+        if (cc_ops->width && i > 0 && len - i >= cc_ops->width) {
+            fsc_ssize_t run = cc_ops->title_run(string + i, len - i, out + result_idx);
+            i += run;
+            result_idx += run;
+            capitalize_next = is_snake_separator(string[i - 1]);
+        }
+        for (fsc_ssize_t stop = scalar_stop(i, len); i < stop; ++i) {
+            unsigned char current_char = (unsigned char)string[i];
+            if (is_snake_separator(current_char)) {
+                out[result_idx++] = ' '; // Replace separator with space
+                capitalize_next = 1; // Capitalize next letter
+            } else if (i > 0 && ascii_isupper(current_char)) {
+                out[result_idx++] = ' ';
+                out[result_idx++] = current_char;
+                capitalize_next = 0;
+            } else if (capitalize_next) {
+                out[result_idx++] = ascii_toupper(current_char);
+                capitalize_next = 0;
+            } else {
+                // Title case usually lowercases subsequent letters within a word
+                out[result_idx++] = ascii_tolower(current_char);
+            }
+        }
+    }
+    return result_idx;
+}
+
+// Finds the [start, end) range of `string` left after stripping whitespace
+static inline void trim_bounds(const char* string, fsc_ssize_t len, fsc_ssize_t* start, fsc_ssize_t* end) {
+    fsc_ssize_t first = 0;
+    while (first < len && ascii_isspace((unsigned char)string[first])) {
+        first++;
+    }
+    fsc_ssize_t last = len;
+    while (last > first && ascii_isspace((unsigned char)string[last - 1])) {
+        last--;
+    }
+    *start = first;
+    *end = last;
+}
+
+// Equivalent to Python's trimcase(string)
+// return str(string).strip()
+static inline fsc_ssize_t trimcase_kernel(const char* string, fsc_ssize_t len, char* out) {
+    fsc_ssize_t start, end;
+    trim_bounds(string, len, &start, &end);
+    memcpy(out, string + start, end - start);
+    return end - start;
+}
+
+// Equivalent to Python's alphanumcase(string)
+// return re.sub("\W+", "", string)
+static inline fsc_ssize_t alphanumcase_kernel(const char* string, fsc_ssize_t len, char* out) {
+    return cc_ops->compact_alnum(string, len, out);
+}
+
+// Returns 1 for the characters sentencecase turns into (trimmed) whitespace
+static inline int is_sentence_blank(char c) {
+    return is_snake_separator(c) || ascii_isspace((unsigned char)c);
+}
+
+// Separators and whitespace at either end of the input only ever produce
+// whitespace that the final trim removes, so sentencecase skips them up
+// front and emits the remaining span without a trailing trim pass.
+static inline void sentence_bounds(const char* string, fsc_ssize_t len, fsc_ssize_t* start, fsc_ssize_t* end) {
+    fsc_ssize_t first = 0;
+    while (first < len && is_sentence_blank(string[first])) { first++; }
+    fsc_ssize_t last = len;
+    while (last > first && is_sentence_blank(string[last - 1])) { last--; }
+    *start = first;
+    *end = last;
+}
+
+// Equivalent to Python's sentencecase(string) - Simplified C implementation
+// Python:
+// joiner = ' '
+// string = re.sub(r"[\-_\.\s]", joiner, str(string))
+// return capitalcase(trimcase(re.sub(r"[A-Z]", lambda matched: joiner + lowercase(matched.group(0)), string)))
+// C Implementation (approximated):
+// 1. Replace separators with space.
+// 2. Insert space before uppercase letters (except first char of string).
+// 3. Trim result.
+// 4. Capitalize first letter of trimmed result.
+static inline fsc_ssize_t sentencecase_kernel(const char* string, fsc_ssize_t len, char* out) {
+    fsc_ssize_t start, end;
+    sentence_bounds(string, len, &start, &end);
+    if (start == end) { return 0; }
+
+    // Capitalize the first letter; it is never a separator after trimming
+    fsc_ssize_t result_idx = 0;
+    out[result_idx++] = ascii_toupper((unsigned char)string[start]);
+    int last_was_space = 0;
+
+    fsc_ssize_t i = start + 1;
+    while (i < end) {
+        if (cc_ops->width && end - i >= cc_ops->width) {
+            fsc_ssize_t run = cc_ops->sentence_run(string + i, end - i, out + result_idx);
+            i += run;
+            result_idx += run;
+            last_was_space = is_snake_separator(string[i - 1]);
+        }
+        for (fsc_ssize_t stop = scalar_stop(i, end); i < stop; ++i) {
+            unsigned char current_char = (unsigned char)string[i];
+            if (is_snake_separator(current_char)) {
+                // Add space only if the last char wasn't already a space
+                if (!last_was_space) {
+                    out[result_idx++] = ' ';
+                    last_was_space = 1;
+                }
+                continue;
+            }
+            // Add space before uppercase if previous wasn't space
+            if (ascii_isupper(current_char) && !last_was_space) {
+                out[result_idx++] = ' ';
+            }
+            out[result_idx++] = ascii_tolower(current_char); // Add other chars as lowercase
+            last_was_space = 0;
+        }
+    }
+    return result_idx;
+}
+
+// --- Unicode Kernels ---
+//
+// Strings with any non-ASCII character are converted code point by code
+// point straight from their PyUnicode storage, one instantiation per kind.
+
+typedef fsc_ssize_t (*unicode_kernel)(const void* data, fsc_ssize_t len, uint32_t* out);
+
+// Most code points a Unicode kernel writes per code point read: a joiner
+// and a letter, or a full uppercase expansion
+#define UK_MAX_OUT (UC_UPPER_MAX > 2 ? UC_UPPER_MAX : 2)
+
+#define UK_CHAR uint8_t
+#define UK_SUFFIX ucs1
+#include "unicode_kernels.h"
+#undef UK_CHAR
+#undef UK_SUFFIX
+
+#define UK_CHAR uint16_t
+#define UK_SUFFIX ucs2
+#include "unicode_kernels.h"
+#undef UK_CHAR
+#undef UK_SUFFIX
+
+#define UK_CHAR uint32_t
+#define UK_SUFFIX ucs4
+#include "unicode_kernels.h"
+#undef UK_CHAR
+#undef UK_SUFFIX
+
+// Indexed by PyUnicode kind >> 1: 1-byte, 2-byte and 4-byte storage
+#define UNICODE_KERNELS(name) {uk_##name##_ucs1, uk_##name##_ucs2, uk_##name##_ucs4}
+
+// --- Measure Functions ---
+
+// lowercase, uppercase and capitalcase never change the length
+static inline fsc_ssize_t same_length_measure(const char* string, fsc_ssize_t len) {
+    (void)string;
+    return len;
+}
+
+// snakecase and every case built on it add one joiner per uppercase letter after index 0
+static inline fsc_ssize_t snake_measure(const char* string, fsc_ssize_t len) {
+    return len > 1 ? len + cc_ops->count_upper(string + 1, len - 1) : len;
+}
+
+// camelcase, pascalcase and alphanumcase keep only alphanumeric characters
+static inline fsc_ssize_t alnum_measure(const char* string, fsc_ssize_t len) {
+    return cc_ops->count_alnum(string, len);
+}
+
+static inline fsc_ssize_t trim_measure(const char* string, fsc_ssize_t len) {
+    fsc_ssize_t start, end;
+    trim_bounds(string, len, &start, &end);
+    return end - start;
+}
+
+static inline fsc_ssize_t sentence_measure(const char* string, fsc_ssize_t len) {
+    fsc_ssize_t start, end;
+    sentence_bounds(string, len, &start, &end);
+    if (start == end) { return 0; }
+    return 1 + cc_ops->count_sentence(string + start + 1, end - start - 1);
+}
+
+// --- Normalization Checks ---
+//
+// Each check returns 1 when the kernel would reproduce its ASCII input
+// unchanged, so the input object can be returned as is. They scan only up
+// to the first byte that rules this out.
+
+// True when no byte of string[start:] is in `classes`
+static inline int none_in(const char* string, fsc_ssize_t len, fsc_ssize_t start, unsigned int classes) {
+    return start >= len || cc_ops->span_without(string + start, len - start, classes) == len - start;
+}
+
+static inline int lowercase_normalized(const char* string, fsc_ssize_t len) {
+    return none_in(string, len, 0, CC_CLASS_UPPER);
+}
+
+static inline int uppercase_normalized(const char* string, fsc_ssize_t len) {
+    return none_in(string, len, 0, CC_CLASS_LOWER);
+}
+
+static inline int snakecase_normalized(const char* string, fsc_ssize_t len) {
+    return none_in(string, len, 0, CC_CLASS_UPPER | CC_CLASS_DASH | CC_CLASS_DOT | CC_CLASS_SPACE);
+}
+
+static inline int camelcase_normalized(const char* string, fsc_ssize_t len) {
+    return (len == 0 || !ascii_isupper((unsigned char)string[0])) && none_in(string, len, 0, CC_CLASS_NON_ALNUM);
+}
+
+static inline int capitalcase_normalized(const char* string, fsc_ssize_t len) {
+    return len == 0 || !ascii_islower((unsigned char)string[0]);
+}
+
+static inline int pascalcase_normalized(const char* string, fsc_ssize_t len) {
+    return (len == 0 || !ascii_islower((unsigned char)string[0])) && none_in(string, len, 0, CC_CLASS_NON_ALNUM);
+}
+
+// Only letter-free tails survive: uppercase letters after index 0 gain a joiner
+static inline int constcase_normalized(const char* string, fsc_ssize_t len) {
+    return (len == 0 || !cc_in_classes((unsigned char)string[0], CC_CLASS_LOWER | CC_CLASS_DASH | CC_CLASS_DOT | CC_CLASS_SPACE))
+        && none_in(string, len, 1, CC_CLASS_UPPER | CC_CLASS_LOWER | CC_CLASS_DASH | CC_CLASS_DOT | CC_CLASS_SPACE);
+}
+
+static inline int pathcase_normalized(const char* string, fsc_ssize_t len) {
+    return none_in(string, len, 0, CC_CLASS_UPPER | CC_CLASS_SEPARATORS);
+}
+
+static inline int backslashcase_normalized(const char* string, fsc_ssize_t len) {
+    return pathcase_normalized(string, len);
+}
+
+static inline int spinalcase_normalized(const char* string, fsc_ssize_t len) {
+    return none_in(string, len, 0, CC_CLASS_UPPER | CC_CLASS_DOT | CC_CLASS_SPACE | CC_CLASS_UNDERSCORE);
+}
+
+static inline int dotcase_normalized(const char* string, fsc_ssize_t len) {
+    return none_in(string, len, 0, CC_CLASS_UPPER | CC_CLASS_DASH | CC_CLASS_SPACE | CC_CLASS_UNDERSCORE);
+}
+
+// A single word with a non-lowercase first character
+static inline int titlecase_normalized(const char* string, fsc_ssize_t len) {
+    return (len == 0 || !cc_in_classes((unsigned char)string[0], CC_CLASS_LOWER | CC_CLASS_SEPARATORS))
+        && none_in(string, len, 1, CC_CLASS_UPPER | CC_CLASS_SEPARATORS);
+}
+
+static inline int trimcase_normalized(const char* string, fsc_ssize_t len) {
+    return len == 0 || (!ascii_isspace((unsigned char)string[0]) && !ascii_isspace((unsigned char)string[len - 1]));
+}
+
+static inline int alphanumcase_normalized(const char* string, fsc_ssize_t len) {
+    return none_in(string, len, 0, CC_CLASS_NON_ALNUM);
+}
+
+// A single word: separators would become (or collapse into) spaces
+static inline int sentencecase_normalized(const char* string, fsc_ssize_t len) {
+    return len == 0 || (!is_sentence_blank(string[0]) && !ascii_islower((unsigned char)string[0])
+                        && !ascii_isspace((unsigned char)string[len - 1])
+                        && none_in(string, len, 1, CC_CLASS_UPPER | CC_CLASS_SEPARATORS));
+}
+
+// --- Style Detection ---
+//
+// A string's case style is decided from the union of its character
+// classes, found in one scan (cc_classes_present). Each style allows at
+// most one kind of separator and rules out some classes; bytes outside the
+// letters, digits and separators rule out every style. A string can be in
+// several styles at once ("id" is snake, camel, spinal, dot and path
+// case), and style_detect reports the first in STYLE_ order.
+
+#define STYLE_SNAKE 0
+#define STYLE_CONST 1
+#define STYLE_CAMEL 2
+#define STYLE_PASCAL 3
+#define STYLE_SPINAL 4
+#define STYLE_DOT 5
+#define STYLE_PATH 6
+#define STYLE_TITLE 7
+#define STYLE_MIXED 8   // In none of the styles above
+#define STYLE_COUNT 9
+
+#define STYLE_SEPARATORS (CC_CLASS_SEPARATORS | CC_CLASS_SLASH)
+
+typedef struct {
+    const char* name;
+    unsigned int separator;  // The separator class allowed, or 0
+    unsigned int forbidden;  // Classes the style rules out
+} StyleRule;
+
+// In STYLE_ order
+static const StyleRule style_rules[STYLE_COUNT] = {
+    {"snake", CC_CLASS_UNDERSCORE, CC_CLASS_UPPER},
+    {"const", CC_CLASS_UNDERSCORE, CC_CLASS_LOWER},
+    {"camel", 0, CC_CLASS_UPPER_INITIAL},
+    {"pascal", 0, CC_CLASS_LOWER_INITIAL},
+    {"spinal", CC_CLASS_DASH, CC_CLASS_UPPER},
+    {"dot", CC_CLASS_DOT, CC_CLASS_UPPER},
+    {"path", CC_CLASS_SLASH, CC_CLASS_UPPER},
+    {"title", CC_CLASS_SPACE, CC_CLASS_UPPER_INNER | CC_CLASS_LOWER_INITIAL},
+    {"mixed", 0, 0},
+};
+
+// Classes of an ASCII string for style_matches; uk_style_classes_* give the
+// same for code points
+static inline unsigned int style_classes(const char* string, fsc_ssize_t len) {
+    if (len == 0) { return 0; }
+    return cc_position_class(cc_class_of((unsigned char)string[0]), 1)
+         | cc_ops->classes_present(string + 1, len - 1);
+}
+
+// 1 when a string with these classes is in the style (never STYLE_MIXED)
+static inline int style_matches(unsigned int classes, int style) {
+    const StyleRule* rule = &style_rules[style];
+    return style < STYLE_MIXED
+        && !(classes & (CC_CLASS_OTHER | (STYLE_SEPARATORS & ~rule->separator) | rule->forbidden));
+}
+
+static inline int style_detect(unsigned int classes) {
+    int style = 0;
+    while (style < STYLE_MIXED && !style_matches(classes, style)) { style++; }
+    return style;
+}
+
+// --- Words ---
+//
+// The snakecase family, titlecase, camelcase and pascalcase all see the
+// same words: input is split at every separator, which is dropped, and
+// before every uppercase letter after index 0. Runs of separators leave
+// empty words, which is how "a__b" keeps both underscores in snakecase.
+// word_spans records that split once, and each emitter below rebuilds its
+// kernel's exact output from it, so several cases of one string cost a
+// single scan of the input.
+
+// Store [start, end) of every word in `spans` (room for 2 * (len + 1)) and
+// return the number of words, 0 for empty input. Identifiers are short and
+// their words shorter, so this is a plain scalar scan.
+static inline fsc_ssize_t word_spans(const char* string, fsc_ssize_t len, fsc_ssize_t* spans) {
+    if (len == 0) { return 0; }
+    fsc_ssize_t count = 0;
+    fsc_ssize_t start = 0;
+    for (fsc_ssize_t i = 0; i < len; ++i) {
+        unsigned char current_char = (unsigned char)string[i];
+        if (is_snake_separator(current_char)) {
+            spans[2 * count] = start;
+            spans[2 * count++ + 1] = i;
+            start = i + 1;
+        } else if (i > 0 && ascii_isupper(current_char)) {
+            spans[2 * count] = start;
+            spans[2 * count++ + 1] = i;
+            start = i;
+        }
+    }
+    spans[2 * count] = start;
+    spans[2 * count++ + 1] = len;
+    return count;
+}
+
+// Characters in all words, i.e. the input less its separators
+static inline fsc_ssize_t words_length(const fsc_ssize_t* spans, fsc_ssize_t count) {
+    fsc_ssize_t total = 0;
+    for (fsc_ssize_t k = 0; k < count; ++k) {
+        total += spans[2 * k + 1] - spans[2 * k];
+    }
+    return total;
+}
+
+// snakecase and the cases derived from it: words lower-cased (upper-cased
+// for constcase) and joined by `joiner`. Writes words_length + count - 1 bytes.
+static inline fsc_ssize_t words_join(const char* string, const fsc_ssize_t* spans, fsc_ssize_t count,
+                                     char joiner, int upper, char* out) {
+    fsc_ssize_t result_idx = 0;
+    for (fsc_ssize_t k = 0; k < count; ++k) {
+        if (k > 0) { out[result_idx++] = joiner; }
+        for (fsc_ssize_t i = spans[2 * k]; i < spans[2 * k + 1]; ++i) {
+            unsigned char current_char = (unsigned char)string[i];
+            out[result_idx++] = upper ? ascii_toupper(current_char) : ascii_tolower(current_char);
+        }
+    }
+    return result_idx;
+}
+
+// titlecase: words capitalized and joined by spaces. Only the first letter
+// of a word can be uppercase, so the rest is copied as is.
+static inline fsc_ssize_t words_title(const char* string, const fsc_ssize_t* spans, fsc_ssize_t count, char* out) {
+    fsc_ssize_t result_idx = 0;
+    for (fsc_ssize_t k = 0; k < count; ++k) {
+        fsc_ssize_t start = spans[2 * k], word_len = spans[2 * k + 1] - start;
+        if (k > 0) { out[result_idx++] = ' '; }
+        if (word_len == 0) { continue; }
+        out[result_idx] = ascii_toupper((unsigned char)string[start]);
+        memcpy(out + result_idx + 1, string + start + 1, word_len - 1);
+        result_idx += word_len;
+    }
+    return result_idx;
+}
+
+// camelcase and pascalcase: only alphanumerics are kept, the first one
+// lower-cased (upper-cased for pascalcase), and the first one after each
+// separator upper-cased unless it was that first one. A word that starts
+// right where the previous one ended was split before an uppercase letter,
+// not at a separator. Writes alnum_measure bytes.
+static inline fsc_ssize_t words_camel(const char* string, const fsc_ssize_t* spans, fsc_ssize_t count,
+                                      int capitalize_first, char* out) {
+    fsc_ssize_t result_idx = 0;
+    int capitalize_next = 0;
+    for (fsc_ssize_t k = 0; k < count; ++k) {
+        if (k > 0 && spans[2 * k] != spans[2 * k - 1]) { capitalize_next = 1; }
+        for (fsc_ssize_t i = spans[2 * k]; i < spans[2 * k + 1]; ++i) {
+            unsigned char current_char = (unsigned char)string[i];
+            if (!ascii_isalnum(current_char)) { continue; }
+            if (result_idx == 0) {
+                current_char = capitalize_first ? ascii_toupper(current_char) : ascii_tolower(current_char);
+            } else if (capitalize_next) {
+                current_char = ascii_toupper(current_char);
+                capitalize_next = 0;
+            }
+            out[result_idx++] = (char)current_char;
+        }
+    }
+    return result_idx;
+}
+
+// --- UTF-8 ---
+//
+// Text stored as UTF-8 (Arrow string columns, files, C++ std::string) goes
+// through the ASCII kernels directly when it is pure ASCII, and otherwise is
+// decoded to UTF-32, converted by the ucs4 kernels and encoded again.
+
+// Bytes out per byte in for any kernel on UTF-8 text: an ASCII byte becomes
+// at most two, and a code point of two or more bytes at most one ASCII
+// joiner and UK_MAX_OUT code points of up to four bytes each
+#define UTF8_MAX_OUT ((1 + 4 * UK_MAX_OUT + 1) / 2)
+
+// 1 when no byte of string has the high bit set
+static inline int utf8_is_ascii(const char* string, fsc_ssize_t len) {
+    fsc_ssize_t i = 0;
+    // Four words per test, which compilers turn into vector loads
+    for (; i + 32 <= len; i += 32) {
+        uint64_t words[4];
+        memcpy(words, string + i, 32);
+        if ((words[0] | words[1] | words[2] | words[3]) & 0x8080808080808080ull) { return 0; }
+    }
+    for (; i + 8 <= len; i += 8) {
+        uint64_t word;
+        memcpy(&word, string + i, 8);
+        if (word & 0x8080808080808080ull) { return 0; }
+    }
+    for (; i < len; ++i) {
+        if ((unsigned char)string[i] & 0x80) { return 0; }
+    }
+    return 1;
+}
+
+// Decode len bytes into at most len code points in `out`, returning how
+// many were written, or -1 if the input is not valid UTF-8 (truncated,
+// overlong or surrogate sequences included).
+static inline fsc_ssize_t utf8_decode(const char* string, fsc_ssize_t len, uint32_t* out) {
+    const unsigned char* s = (const unsigned char*)string;
+    fsc_ssize_t count = 0;
+    fsc_ssize_t i = 0;
+    while (i < len) {
+        uint32_t c = s[i];
+        if (c < 0x80) {
+            out[count++] = c;
+            i++;
+            continue;
+        }
+        fsc_ssize_t extra;
+        uint32_t min;
+        if ((c & 0xE0) == 0xC0) { extra = 1; min = 0x80; c &= 0x1F; }
+        else if ((c & 0xF0) == 0xE0) { extra = 2; min = 0x800; c &= 0x0F; }
+        else if ((c & 0xF8) == 0xF0) { extra = 3; min = 0x10000; c &= 0x07; }
+        else { return -1; }
+        if (len - i <= extra) { return -1; }
+        for (fsc_ssize_t j = 1; j <= extra; ++j) {
+            if ((s[i + j] & 0xC0) != 0x80) { return -1; }
+            c = (c << 6) | (s[i + j] & 0x3F);
+        }
+        if (c < min || c > 0x10FFFF || (c >= 0xD800 && c <= 0xDFFF)) { return -1; }
+        out[count++] = c;
+        i += extra + 1;
+    }
+    return count;
+}
+
+// Bytes utf8_encode writes for `count` code points
+static inline fsc_ssize_t utf8_measure(const uint32_t* code_points, fsc_ssize_t count) {
+    fsc_ssize_t len = count;
+    for (fsc_ssize_t i = 0; i < count; ++i) {
+        uint32_t c = code_points[i];
+        len += (c >= 0x80) + (c >= 0x800) + (c >= 0x10000);
+    }
+    return len;
+}
+
+// Encode `count` code points into `out`, returning the number of bytes written
+static inline fsc_ssize_t utf8_encode(const uint32_t* code_points, fsc_ssize_t count, char* out) {
+    unsigned char* o = (unsigned char*)out;
+    fsc_ssize_t len = 0;
+    for (fsc_ssize_t i = 0; i < count; ++i) {
+        uint32_t c = code_points[i];
+        if (c < 0x80) {
+            o[len++] = (unsigned char)c;
+        } else if (c < 0x800) {
+            o[len++] = (unsigned char)(0xC0 | (c >> 6));
+            o[len++] = (unsigned char)(0x80 | (c & 0x3F));
+        } else if (c < 0x10000) {
+            o[len++] = (unsigned char)(0xE0 | (c >> 12));
+            o[len++] = (unsigned char)(0x80 | ((c >> 6) & 0x3F));
+            o[len++] = (unsigned char)(0x80 | (c & 0x3F));
+        } else {
+            o[len++] = (unsigned char)(0xF0 | (c >> 18));
+            o[len++] = (unsigned char)(0x80 | ((c >> 12) & 0x3F));
+            o[len++] = (unsigned char)(0x80 | ((c >> 6) & 0x3F));
+            o[len++] = (unsigned char)(0x80 | (c & 0x3F));
+        }
+    }
+    return len;
+}
+
+// Convert non-ASCII UTF-8 with a ucs4 kernel: decode into `code_points`,
+// which needs room for (1 + UK_MAX_OUT) * len, convert, and encode into
+// `out`, which needs UTF8_MAX_OUT * len bytes. Returns the bytes written,
+// or -1 if the input is not valid UTF-8.
+static inline fsc_ssize_t utf8_convert(unicode_kernel kernel, const char* string, fsc_ssize_t len,
+                                       uint32_t* code_points, char* out) {
+    fsc_ssize_t count = utf8_decode(string, len, code_points);
+    if (count < 0) { return -1; }
+    uint32_t* converted = code_points + count;
+    return utf8_encode(converted, kernel(code_points, count, converted), out);
+}
+
+#endif // FAST_STRINGCASE_STRINGCASE_CORE_H
@@ -0,0 +1,94 @@
+// Code point classes and simple case mappings for the non-ASCII kernels.
+//
+// Code points below 0x80 go through the ASCII helpers from charclass.h, so a
+// character is classified the same way whether or not the rest of its
+// string is ASCII. Everything else is looked up in the generated tables.
+
+#ifndef FAST_STRINGCASE_UNICASE_H
+#define FAST_STRINGCASE_UNICASE_H
+
+#include <stdint.h>
+
+#include "charclass.h"
+#include "unicase_data.h"
+
+static inline const UnicaseRecord* uc_record(uint32_t cp) {
+    if (cp >= UC_LIMIT) { return &uc_records[0]; }
+    unsigned int block = uc_index1[cp >> UC_SHIFT];
+    return &uc_records[uc_index2[(block << UC_SHIFT) | (cp & ((1u << UC_SHIFT) - 1))]];
+}
+
+static inline int uc_isupper(uint32_t cp) {
+    return cp < 0x80 ? ascii_isupper((unsigned char)cp) : (uc_record(cp)->flags & UC_UPPER) != 0;
+}
+
+static inline int uc_islower(uint32_t cp) {
+    return cp < 0x80 ? ascii_islower((unsigned char)cp) : (uc_record(cp)->flags & UC_LOWER) != 0;
+}
+
+static inline int uc_isalnum(uint32_t cp) {
+    return cp < 0x80 ? ascii_isalnum((unsigned char)cp) : (uc_record(cp)->flags & UC_ALNUM) != 0;
+}
+
+static inline int uc_isspace(uint32_t cp) {
+    return cp < 0x80 ? ascii_isspace((unsigned char)cp) : (uc_record(cp)->flags & UC_SPACE) != 0;
+}
+
+static inline uint32_t uc_tolower(uint32_t cp) {
+    return cp < 0x80 ? ascii_tolower((unsigned char)cp) : (uint32_t)((int32_t)cp + uc_record(cp)->lower);
+}
+
+static inline uint32_t uc_toupper(uint32_t cp) {
+    return cp < 0x80 ? ascii_toupper((unsigned char)cp) : (uint32_t)((int32_t)cp + uc_record(cp)->upper);
+}
+
+// Copy the full uppercase mapping of a flagged code point to out; returns
+// its length. Rare, so kept out of the kernels' loops.
+#if defined(__GNUC__)
+__attribute__((noinline, cold))
+#endif
+static int uc_upper_expansion(uint32_t cp, uint32_t* out) {
+    size_t low = 0, high = sizeof(uc_upper_expansions) / sizeof(uc_upper_expansions[0]);
+    while (uc_upper_expansions[low].cp != cp) {
+        size_t mid = (low + high) / 2;
+        if (uc_upper_expansions[mid].cp <= cp) { low = mid; } else { high = mid; }
+    }
+    const uint32_t* upper = uc_upper_expansions[low].upper;
+    int count = 0;
+    while (count < UC_UPPER_MAX && upper[count]) {
+        out[count] = upper[count];
+        count++;
+    }
+    return count;
+}
+
+// Full uppercase mapping, as str.upper() gives it: the simple mapping, or a
+// SpecialCasing expansion such as U+00DF (ß) to "SS". Writes up to
+// UC_UPPER_MAX code points to out and returns how many.
+static inline int uc_toupper_full(uint32_t cp, uint32_t* out) {
+    if (cp < 0x80) {
+        out[0] = ascii_toupper((unsigned char)cp);
+        return 1;
+    }
+    const UnicaseRecord* record = uc_record(cp);
+    if (record->flags & UC_UPPER_EXPANDS) { return uc_upper_expansion(cp, out); }
+    out[0] = (uint32_t)((int32_t)cp + record->upper);
+    return 1;
+}
+
+// is_snake_separator for code points; never truncate to char first
+static inline int uc_is_separator(uint32_t cp) {
+    return cp < 0x80 && is_snake_separator((char)cp);
+}
+
+// cc_class_of for code points: cased letters by their case, other letters
+// and digits 0, and everything else CC_CLASS_OTHER
+static inline unsigned int uc_class_of(uint32_t cp) {
+    if (cp < 0x80) { return cc_class_of((unsigned char)cp); }
+    const UnicaseRecord* record = uc_record(cp);
+    if (record->flags & UC_UPPER) { return CC_CLASS_UPPER; }
+    if (record->flags & UC_LOWER) { return CC_CLASS_LOWER; }
+    return record->flags & UC_ALNUM ? 0 : CC_CLASS_OTHER;
+}
+
+#endif // FAST_STRINGCASE_UNICASE_H
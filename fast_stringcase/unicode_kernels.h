@@ -0,0 +1,217 @@
+// Case kernels for text that is not pure ASCII, instantiated once per code
+// unit width (the three PyUnicode kinds) by stringcase_core.h. Do not
+// include directly.
+//
+// The includer defines:
+//   UK_CHAR     uint8_t, uint16_t or uint32_t, the storage unit of the input
+//   UK_SUFFIX   name suffix for the instantiated functions
+//
+// Each kernel reads `len` code points from `data` and writes UCS-4 code
+// points to `out`, returning how many it wrote; `out` must have room for
+// UK_MAX_OUT * len. They follow the ASCII kernels in stringcase_core.h one
+// for one, with classification and simple case mapping from unicase.h.
+// uppercase and constcase, which uppercase every letter as str.upper()
+// does, use the full mapping, so 'ß' becomes "SS".
+
+#define UK_JOIN2(a, b) a##_##b
+#define UK_JOIN(a, b) UK_JOIN2(a, b)
+#define UK_FN(name) UK_JOIN(name, UK_SUFFIX)
+
+static inline fsc_ssize_t UK_FN(uk_lowercase)(const void* data, fsc_ssize_t len, uint32_t* out) {
+    const UK_CHAR* string = (const UK_CHAR*)data;
+    for (fsc_ssize_t i = 0; i < len; i++) {
+        out[i] = uc_tolower(string[i]);
+    }
+    return len;
+}
+
+static inline fsc_ssize_t UK_FN(uk_uppercase)(const void* data, fsc_ssize_t len, uint32_t* out) {
+    const UK_CHAR* string = (const UK_CHAR*)data;
+    fsc_ssize_t result_idx = 0;
+    for (fsc_ssize_t i = 0; i < len; i++) {
+        result_idx += uc_toupper_full(string[i], out + result_idx);
+    }
+    return result_idx;
+}
+
+static inline fsc_ssize_t UK_FN(uk_snake_joined)(const void* data, fsc_ssize_t len, uint32_t* out,
+                                                 uint32_t joiner, int upper) {
+    const UK_CHAR* string = (const UK_CHAR*)data;
+    if (len == 0) { return 0; }
+
+    fsc_ssize_t result_idx = 0;
+    uint32_t first_char = string[0];
+    if (uc_is_separator(first_char)) {
+        out[result_idx++] = joiner;
+    } else if (upper) {
+        result_idx += uc_toupper_full(first_char, out);
+    } else {
+        out[result_idx++] = uc_tolower(first_char);
+    }
+
+    for (fsc_ssize_t i = 1; i < len; ++i) {
+        uint32_t current_char = string[i];
+        if (uc_is_separator(current_char)) {
+            out[result_idx++] = joiner;
+        } else if (uc_isupper(current_char)) {
+            out[result_idx++] = joiner;
+            out[result_idx++] = upper ? current_char : uc_tolower(current_char);
+        } else if (upper) {
+            result_idx += uc_toupper_full(current_char, out + result_idx);
+        } else {
+            out[result_idx++] = current_char;
+        }
+    }
+    return result_idx;
+}
+
+static inline fsc_ssize_t UK_FN(uk_snakecase)(const void* data, fsc_ssize_t len, uint32_t* out) {
+    return UK_FN(uk_snake_joined)(data, len, out, '_', 0);
+}
+
+static inline fsc_ssize_t UK_FN(uk_constcase)(const void* data, fsc_ssize_t len, uint32_t* out) {
+    return UK_FN(uk_snake_joined)(data, len, out, '_', 1);
+}
+
+static inline fsc_ssize_t UK_FN(uk_pathcase)(const void* data, fsc_ssize_t len, uint32_t* out) {
+    return UK_FN(uk_snake_joined)(data, len, out, '/', 0);
+}
+
+static inline fsc_ssize_t UK_FN(uk_backslashcase)(const void* data, fsc_ssize_t len, uint32_t* out) {
+    return UK_FN(uk_snake_joined)(data, len, out, '\\', 0);
+}
+
+static inline fsc_ssize_t UK_FN(uk_spinalcase)(const void* data, fsc_ssize_t len, uint32_t* out) {
+    return UK_FN(uk_snake_joined)(data, len, out, '-', 0);
+}
+
+static inline fsc_ssize_t UK_FN(uk_dotcase)(const void* data, fsc_ssize_t len, uint32_t* out) {
+    return UK_FN(uk_snake_joined)(data, len, out, '.', 0);
+}
+
+static inline fsc_ssize_t UK_FN(uk_camel)(const void* data, fsc_ssize_t len, uint32_t* out, int capitalize_first) {
+    const UK_CHAR* string = (const UK_CHAR*)data;
+    fsc_ssize_t result_idx = 0;
+    int capitalize_next = 0;
+
+    for (fsc_ssize_t i = 0; i < len; ++i) {
+        uint32_t current_char = string[i];
+        if (uc_is_separator(current_char)) {
+            capitalize_next = 1;
+        } else if (uc_isalnum(current_char)) {
+            if (result_idx == 0) {
+                out[result_idx++] = capitalize_first ? uc_toupper(current_char) : uc_tolower(current_char);
+            } else if (capitalize_next) {
+                out[result_idx++] = uc_toupper(current_char);
+                capitalize_next = 0;
+            } else {
+                out[result_idx++] = current_char;
+            }
+        }
+    }
+    return result_idx;
+}
+
+static inline fsc_ssize_t UK_FN(uk_camelcase)(const void* data, fsc_ssize_t len, uint32_t* out) {
+    return UK_FN(uk_camel)(data, len, out, 0);
+}
+
+static inline fsc_ssize_t UK_FN(uk_pascalcase)(const void* data, fsc_ssize_t len, uint32_t* out) {
+    return UK_FN(uk_camel)(data, len, out, 1);
+}
+
+static inline fsc_ssize_t UK_FN(uk_capitalcase)(const void* data, fsc_ssize_t len, uint32_t* out) {
+    const UK_CHAR* string = (const UK_CHAR*)data;
+    for (fsc_ssize_t i = 0; i < len; i++) {
+        out[i] = i == 0 ? uc_toupper(string[i]) : string[i];
+    }
+    return len;
+}
+
+static inline fsc_ssize_t UK_FN(uk_titlecase)(const void* data, fsc_ssize_t len, uint32_t* out) {
+    const UK_CHAR* string = (const UK_CHAR*)data;
+    fsc_ssize_t result_idx = 0;
+    int capitalize_next = 1;
+
+    for (fsc_ssize_t i = 0; i < len; ++i) {
+        uint32_t current_char = string[i];
+        if (uc_is_separator(current_char)) {
+            out[result_idx++] = ' ';
+            capitalize_next = 1;
+        } else if (i > 0 && uc_isupper(current_char)) {
+            out[result_idx++] = ' ';
+            out[result_idx++] = current_char;
+            capitalize_next = 0;
+        } else if (capitalize_next) {
+            out[result_idx++] = uc_toupper(current_char);
+            capitalize_next = 0;
+        } else {
+            out[result_idx++] = uc_tolower(current_char);
+        }
+    }
+    return result_idx;
+}
+
+static inline fsc_ssize_t UK_FN(uk_trimcase)(const void* data, fsc_ssize_t len, uint32_t* out) {
+    const UK_CHAR* string = (const UK_CHAR*)data;
+    fsc_ssize_t start = 0, end = len;
+    while (start < end && uc_isspace(string[start])) { start++; }
+    while (end > start && uc_isspace(string[end - 1])) { end--; }
+    for (fsc_ssize_t i = start; i < end; i++) {
+        out[i - start] = string[i];
+    }
+    return end - start;
+}
+
+static inline fsc_ssize_t UK_FN(uk_alphanumcase)(const void* data, fsc_ssize_t len, uint32_t* out) {
+    const UK_CHAR* string = (const UK_CHAR*)data;
+    fsc_ssize_t written = 0;
+    for (fsc_ssize_t i = 0; i < len; i++) {
+        out[written] = string[i];
+        written += uc_isalnum(string[i]);
+    }
+    return written;
+}
+
+static inline fsc_ssize_t UK_FN(uk_sentencecase)(const void* data, fsc_ssize_t len, uint32_t* out) {
+    const UK_CHAR* string = (const UK_CHAR*)data;
+    fsc_ssize_t start = 0, end = len;
+    while (start < end && (uc_is_separator(string[start]) || uc_isspace(string[start]))) { start++; }
+    while (end > start && (uc_is_separator(string[end - 1]) || uc_isspace(string[end - 1]))) { end--; }
+    if (start == end) { return 0; }
+
+    fsc_ssize_t result_idx = 0;
+    out[result_idx++] = uc_toupper(string[start]);
+    int last_was_space = 0;
+
+    for (fsc_ssize_t i = start + 1; i < end; ++i) {
+        uint32_t current_char = string[i];
+        if (uc_is_separator(current_char)) {
+            if (!last_was_space) {
+                out[result_idx++] = ' ';
+                last_was_space = 1;
+            }
+            continue;
+        }
+        if (uc_isupper(current_char) && !last_was_space) {
+            out[result_idx++] = ' ';
+        }
+        out[result_idx++] = uc_tolower(current_char);
+        last_was_space = 0;
+    }
+    return result_idx;
+}
+
+// style_classes for code points
+static inline unsigned int UK_FN(uk_style_classes)(const void* data, fsc_ssize_t len) {
+    const UK_CHAR* string = (const UK_CHAR*)data;
+    unsigned int classes = 0;
+    for (fsc_ssize_t i = 0; i < len; ++i) {
+        classes |= cc_position_class(uc_class_of(string[i]), i == 0 || uc_is_separator(string[i - 1]));
+    }
+    return classes;
+}
+
+#undef UK_JOIN2
+#undef UK_JOIN
+#undef UK_FN
@@ -6,6 +6,20 @@ include_dirs = [sysconfig.get_paths()["include"], sysconfig.get_paths()["platinc
 module = Extension(
     "fast_stringcase.fast_stringcase",
     sources=["fast_stringcase/fast_stringcase.c"],
+    depends=[
+        "fast_stringcase/stringcase_core.h",
+        "fast_stringcase/charclass.h",
+        "fast_stringcase/charclass_simd.h",
+        "fast_stringcase/unicase.h",
+        "fast_stringcase/unicase_data.h",
+        "fast_stringcase/unicode_kernels.h",
+        "fast_stringcase/parallel.h",
+        "fast_stringcase/mapped_file.h",
+        "fast_stringcase/converter_kernel.h",
+        "fast_stringcase/stats.h",
+        "fast_stringcase/arrow_c_data.h",
+        "fast_stringcase/fast_stringcase_capi.h",
+    ],
     include_dirs=include_dirs,
 )
 
@@ -26,7 +40,7 @@ setup(
     download_url='https://pypi.org/project/fast-stringcase/',
     ext_modules=[module],
     packages=["fast_stringcase"],
-    package_data={'fast_stringcase': ['fast_stringcase.pyi','py.typed']},
+    package_data={'fast_stringcase': ['fast_stringcase.pyi','py.typed','*.h']},
     classifiers=[
         "Programming Language :: Python :: 3",
         "Operating System :: OS Independent",
@@ -1,6 +1,87 @@
+import collections.abc
+import ctypes
+import json
+import os
+import random
+import struct
+import sys
+import tempfile
+import threading
+import time
 import unittest
+import warnings
 from unittest import TestCase
 import fast_stringcase as stringcase
+from fast_stringcase import __main__ as cli
+
+
+# A minimal Arrow C Data Interface producer and consumer over ctypes, so the
+# Arrow entry points are tested without pyarrow.
+class ArrowSchema(ctypes.Structure):
+    _fields_ = [("format", ctypes.c_char_p), ("name", ctypes.c_char_p), ("metadata", ctypes.c_char_p),
+                ("flags", ctypes.c_int64), ("n_children", ctypes.c_int64), ("children", ctypes.c_void_p),
+                ("dictionary", ctypes.c_void_p), ("release", ctypes.c_void_p), ("private_data", ctypes.c_void_p)]
+
+
+class ArrowArray(ctypes.Structure):
+    _fields_ = [("length", ctypes.c_int64), ("null_count", ctypes.c_int64), ("offset", ctypes.c_int64),
+                ("n_buffers", ctypes.c_int64), ("n_children", ctypes.c_int64),
+                ("buffers", ctypes.POINTER(ctypes.c_void_p)), ("children", ctypes.c_void_p),
+                ("dictionary", ctypes.c_void_p), ("release", ctypes.c_void_p), ("private_data", ctypes.c_void_p)]
+
+
+capsule_new = ctypes.pythonapi.PyCapsule_New
+capsule_new.restype = ctypes.py_object
+capsule_new.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_void_p]
+capsule_pointer = ctypes.pythonapi.PyCapsule_GetPointer
+capsule_pointer.restype = ctypes.c_void_p
+capsule_pointer.argtypes = [ctypes.py_object, ctypes.c_char_p]
+arrow_release = ctypes.CFUNCTYPE(None, ctypes.c_void_p)
+noop_release = arrow_release(lambda pointer: None)
+
+
+class ArrowProducer:
+    """Arrow string array of `values` (str, raw bytes or None), sliced at `offset`."""
+
+    def __init__(self, values, offset=0, large=False, format=None):
+        code = "q" if large else "i"
+        encoded = [v.encode() if isinstance(v, str) else v for v in values]
+        offsets = [0]
+        for v in encoded:
+            offsets.append(offsets[-1] + len(v or b""))
+        validity = bytearray((len(values) + 7) // 8)
+        for i, v in enumerate(values):
+            if v is not None:
+                validity[i >> 3] |= 1 << (i & 7)
+        data = b"".join(v for v in encoded if v)
+        self.memory = [ctypes.create_string_buffer(bytes(validity), len(validity) or 1),
+                       ctypes.create_string_buffer(struct.pack("%d%s" % (len(offsets), code), *offsets)),
+                       ctypes.create_string_buffer(data, len(data) or 1)]
+        self.buffers = (ctypes.c_void_p * 3)(*[ctypes.addressof(b) for b in self.memory])
+        release = ctypes.cast(noop_release, ctypes.c_void_p)
+        self.schema = ArrowSchema(format or (b"U" if large else b"u"), b"", None, 2, 0, None, None, release, None)
+        self.array = ArrowArray(len(values) - offset, values[offset:].count(None), offset, 3, 0,
+                                self.buffers, None, None, release, None)
+
+    def __arrow_c_array__(self, requested_schema=None):
+        return (capsule_new(ctypes.addressof(self.schema), b"arrow_schema", None),
+                capsule_new(ctypes.addressof(self.array), b"arrow_array", None))
+
+
+def arrow_consume(obj):
+    """(format, values) of an exported Arrow string array, releasing it as a consumer would."""
+    schema_capsule, array_capsule = obj.__arrow_c_array__()
+    schema = ArrowSchema.from_address(capsule_pointer(schema_capsule, b"arrow_schema"))
+    array = ArrowArray.from_address(capsule_pointer(array_capsule, b"arrow_array"))
+    code, width = ("q", 8) if schema.format == b"U" else ("i", 4)
+    offsets = struct.unpack("%d%s" % (array.length + 1, code),
+                            ctypes.string_at(array.buffers[1], width * (array.length + 1)))
+    data = ctypes.string_at(array.buffers[2], offsets[-1])
+    validity = ctypes.string_at(array.buffers[0], (array.length + 7) // 8) if array.buffers[0] else None
+    values = [None if validity is not None and not validity[i >> 3] >> (i & 7) & 1
+              else data[offsets[i]:offsets[i + 1]].decode() for i in range(array.length)]
+    arrow_release(array.release)(ctypes.addressof(array))
+    return schema.format.decode(), values
 
 
 class TestFastStringcase(TestCase):
@@ -57,6 +138,631 @@ class TestFastStringcase(TestCase):
         self.assertEqual(stringcase.alphanumcase("_Foo., Bar"), "FooBar")
         self.assertEqual(stringcase.alphanumcase("Foo_123 Bar!"), "Foo123Bar")
 
+    def test_long_strings(self):
+        # Long enough to go through the vector kernels, with odd tails
+        for n in (1, 7, 33, 101):
+            self.assertEqual(stringcase.lowercase("FooBar-baz" * n), "foobar-baz" * n)
+            self.assertEqual(stringcase.uppercase("FooBar-baz" * n), "FOOBAR-BAZ" * n)
+            self.assertEqual(stringcase.snakecase("foo_bar baz-" * n), "foo_bar_baz_" * n)
+            self.assertEqual(stringcase.snakecase("FooBar" * n), "foo_bar" + "_foo_bar" * (n - 1))
+            self.assertEqual(stringcase.constcase("foo.bar" * n), "FOO_BAR" * n)
+            self.assertEqual(stringcase.spinalcase("foo_bar " * n), "foo-bar-" * n)
+            self.assertEqual(stringcase.titlecase("foo_bar " * n), "Foo Bar " * n)
+            self.assertEqual(stringcase.sentencecase("foo_bar " * n), "Foo bar" + " foo bar" * (n - 1))
+            self.assertEqual(stringcase.camelcase("foo_bar" * n), "fooBar" * n)
+            self.assertEqual(stringcase.alphanumcase("a-b!" * n), "ab" * n)
+
+    def test_already_normalized(self):
+        s = "foo_bar_baz"
+        self.assertIs(stringcase.snakecase(s), s)
+        self.assertIs(stringcase.lowercase(s), s)
+        self.assertEqual(stringcase.snakecase("foo\0Bar"), "foo\0_bar")
+        self.assertRaises(TypeError, stringcase.snakecase, 1)
+        self.assertRaises(TypeError, stringcase.snakecase)
+
+    def test_unicode(self):
+        self.assertEqual(stringcase.snakecase("StraßeÄpfel"), "straße_äpfel")
+        # Full uppercase mappings, as str.upper() gives them
+        self.assertEqual(stringcase.constcase("straße"), "STRASSE")
+        self.assertEqual(stringcase.constcase("größe_öl"), "GRÖSSE_ÖL")
+        self.assertEqual(stringcase.constcase("ﬃx.ΐ" * 50), "ﬃx.ΐ".upper().replace(".", "_") * 50)
+        self.assertEqual(stringcase.uppercase("straße"), "STRASSE")
+        self.assertEqual(arrow_consume(stringcase.convert_arrow(ArrowProducer(["straße"]), "constcase")),
+                         ("u", ["STRASSE"]))
+        self.assertEqual(stringcase.camelcase("größe_öl"), "größeÖl")
+        self.assertEqual(stringcase.titlecase("çaÇa"), "Ça Ça")
+        self.assertEqual(stringcase.uppercase("ÿ"), "Ÿ")
+        self.assertEqual(stringcase.uppercase("ı"), "I")
+        self.assertEqual(stringcase.trimcase("\u3000名前\u3000"), "名前")
+        self.assertEqual(stringcase.alphanumcase("名前_値!"), "名前値")
+        self.assertEqual(stringcase.spinalcase("\U0001d400\U0001e900"), "\U0001d400-\U0001e922")
+
+    def test_many(self):
+        items = ["foo_bar_baz", "FooBarBaz", "", "x"]
+        for name in ("camelcase", "constcase", "pathcase", "sentencecase", "snakecase", "titlecase"):
+            single = getattr(stringcase, name)
+            many = getattr(stringcase, name + "_many")
+            expected = [single(s) for s in items]
+            self.assertEqual(many(items), expected)
+            self.assertEqual(many(tuple(items)), expected)
+            self.assertEqual(many(s for s in items), expected)
+        self.assertEqual(stringcase.snakecase_many([]), [])
+        self.assertRaises(TypeError, stringcase.snakecase_many, ["foo", 1])
+        self.assertRaises(TypeError, stringcase.snakecase_many, 1)
+
+    def test_many_threads(self):
+        class Str(str):
+            pass
+        # Large enough to take the parallel path, with every kind of item
+        items = ["fooBar", "foo_bar", "ÄpfelBaum", Str("foo_bar"), ""] * 4000
+        for name in ("snakecase", "camelcase", "sentencecase", "alphanumcase"):
+            single = getattr(stringcase, name)
+            many = getattr(stringcase, name + "_many")
+            expected = [single(s) for s in items]
+            self.assertEqual(many(items, threads=4), expected)
+            self.assertEqual(many(iter(items), threads=3), expected)
+            self.assertEqual(many(items[:10], threads=4), expected[:10])
+        self.assertIs(stringcase.snakecase_many(items, threads=2)[1], items[1])
+        self.assertRaises(TypeError, stringcase.snakecase_many, items + [1], threads=2)
+        self.assertRaises(ValueError, stringcase.snakecase_many, items, threads=0)
+        self.assertRaises(TypeError, stringcase.snakecase_many, items, workers=2)
+
+        # Several callers share the module's helper threads
+        expected = stringcase.snakecase_many(items)
+        results = []
+        callers = [threading.Thread(target=lambda t=t: results.append(stringcase.snakecase_many(items, threads=t)))
+                   for t in (2, 3, 8, 2)]
+        for caller in callers:
+            caller.start()
+        for caller in callers:
+            caller.join()
+        self.assertEqual(results, [expected] * 4)
+        # A forked child starts helpers of its own
+        if hasattr(os, "fork"):
+            with warnings.catch_warnings():
+                # 3.12+ warns about forking with the helpers running
+                warnings.simplefilter("ignore", DeprecationWarning)
+                pid = os.fork()
+            if pid == 0:
+                os._exit(0 if stringcase.snakecase_many(items, threads=4) == expected else 1)
+            self.assertEqual(os.waitpid(pid, 0)[1], 0)
+
+    def test_bytes(self):
+        self.assertEqual(stringcase.snakecase(b"FooBar"), b"foo_bar")
+        self.assertEqual(stringcase.camelcase(bytearray(b"foo_bar")), b"fooBar")
+        self.assertEqual(stringcase.alphanumcase(memoryview(b"a-b!c")[1:]), b"bc")
+        data = b"foo_bar"
+        self.assertIs(stringcase.snakecase(data), data)
+
+        out = bytearray(7)
+        self.assertEqual(stringcase.snakecase(b"FooBar", out=out), 7)
+        self.assertEqual(out, b"foo_bar")
+        self.assertRaises(ValueError, stringcase.snakecase, b"FooBar", out=bytearray(6))
+        self.assertRaises(TypeError, stringcase.snakecase, "FooBar", out=bytearray(8))
+        self.assertRaises(BufferError, stringcase.snakecase, b"FooBar", out=b"12345678")
+
+        buf = bytearray(b"foo_bar baz")
+        self.assertIsNone(stringcase.spinalcase_inplace(buf))
+        self.assertEqual(buf, b"foo-bar-baz")
+        stringcase.uppercase_inplace(memoryview(buf)[4:])
+        self.assertEqual(buf, b"foo-BAR-BAZ")
+        self.assertRaises(ValueError, stringcase.pathcase_inplace, buf)
+        self.assertEqual(buf, b"foo-BAR-BAZ")
+        self.assertRaises(BufferError, stringcase.lowercase_inplace, b"FOO")
+
+    def test_converter(self):
+        title = stringcase.Converter(joiner="::", word_case="title")
+        self.assertEqual(title("foo_barBaz"), "Foo::Bar::Baz")
+        self.assertEqual(title.many(["HTTPServer", "a--b"]), ["Http::Server", "A::B"])
+        camel = stringcase.Converter(joiner="", word_case="capital", first_word_case="lower")
+        self.assertEqual(camel("parse_HTTP_response"), "parseHTTPResponse")
+        self.assertEqual(camel("HTTPServerError"), "httpServerError")
+        self.assertEqual(stringcase.Converter(acronyms=False)("HTTPServer"), "h_t_t_p_server")
+        self.assertEqual(stringcase.Converter(joiner="__")("fooBar-baz"), "foo__bar__baz")
+        self.assertEqual(stringcase.Converter(input_separators="/", joiner="·")("ÄpfelBaum/x"), "äpfel·baum·x")
+        self.assertEqual(stringcase.Converter()("__"), "")
+        shout = stringcase.Converter(word_case="upper")
+        self.assertEqual(shout("straße"), "STRASSE")
+        self.assertEqual(shout("straße"), stringcase.uppercase("straße"))
+        self.assertEqual(shout("größe_öl"), stringcase.constcase("größe_öl"))
+        self.assertEqual(shout("ﬃx·ΐ" * 50), ("ﬃx·ΐ" * 50).upper())
+        self.assertEqual(stringcase.Converter(joiner="·", first_word_case="upper")("maßBand"), "MASS·band")
+        self.assertRaises(ValueError, stringcase.Converter, word_case="shouty")
+        self.assertRaises(TypeError, title, b"foo")
+
+    def test_transform_keys(self):
+        payload = {"userName": "Bob", "tagList": [{"tagName": "x"}, ("a", {"innerKey": 1})], 3: "fooBar"}
+        self.assertEqual(stringcase.transform_keys(payload, "snakecase"),
+                         {"user_name": "Bob", "tag_list": [{"tag_name": "x"}, ("a", {"inner_key": 1})], 3: "fooBar"})
+        self.assertEqual(stringcase.transform_keys(payload, "snakecase", depth=1),
+                         {"user_name": "Bob", "tag_list": [{"tagName": "x"}, ("a", {"innerKey": 1})], 3: "fooBar"})
+        self.assertEqual(stringcase.transform_keys([{"foo_bar": 1}], "camelcase"), [{"fooBar": 1}])
+        self.assertEqual(payload["userName"], "Bob")
+        self.assertEqual(stringcase.transform_keys("fooBar", "snakecase"), "fooBar")
+        ordered = collections.OrderedDict([("userName", 1), ("tagList", collections.defaultdict(list, tagName=2))])
+        ordered.move_to_end("userName")
+        result = stringcase.transform_keys([ordered], "snakecase")
+        self.assertEqual(result, [{"tag_list": {"tag_name": 2}, "user_name": 1}])
+        self.assertEqual(list(result[0]), ["tag_list", "user_name"])
+        self.assertIs(type(result[0]), dict)
+        self.assertIs(type(result[0]["tag_list"]), dict)
+        self.assertRaises(ValueError, stringcase.transform_keys, payload, "nocase")
+        self.assertRaises(ValueError, stringcase.transform_keys, payload, "snakecase", depth=-1)
+
+    def test_words(self):
+        self.assertEqual(stringcase.words("parse_HTTPResponse  code"), ["parse", "H", "T", "T", "P", "Response", "code"])
+        self.assertEqual(stringcase.words("größeStraße_名前"), ["größe", "Straße", "名前"])
+        self.assertEqual(stringcase.words("fooBar", offsets=True), [(0, 3), (3, 6)])
+        self.assertEqual(stringcase.words(""), [])
+        self.assertEqual(stringcase.words("_-. "), [])
+
+        cases = ["lowercase", "uppercase", "snakecase", "camelcase", "capitalcase", "pascalcase", "constcase",
+                 "pathcase", "backslashcase", "spinalcase", "dotcase", "titlecase", "trimcase", "alphanumcase",
+                 "sentencecase"]
+        for s in ["userAccountId", "a__b", "_$Za0", " $ 0/bX$Z- q", "HTTP_response.code", "", "Größe_Straße",
+                  "x_yZ" * 32, "x_yZ" * 40]:
+            expected = tuple(getattr(stringcase, case)(s) for case in cases)
+            self.assertEqual(stringcase.convert(s, cases), expected)
+            self.assertEqual(stringcase.convert(s, [case[:-4] for case in cases]), expected)
+        self.assertEqual(stringcase.convert("userAccountId", ("snake", "camel", "const", "title")),
+                         ("user_account_id", "userAccountId", "USER_ACCOUNT_ID", "User Account Id"))
+        self.assertRaises(ValueError, stringcase.convert, "foo", ["nocase"])
+        self.assertRaises(TypeError, stringcase.convert, "foo", "snake")
+        self.assertRaises(TypeError, stringcase.convert, b"foo", ["snake"])
+
+    def test_case_normalized_dict(self):
+        d = stringcase.CaseNormalizedDict({"userId": 1}, HTTPServer=2)
+        for key in ["userId", "user_id", "USER-ID", "User Id", "__user.id"]:
+            self.assertEqual(d[key], 1)
+        self.assertEqual(d.get("http_server"), 2)
+        self.assertNotIn("userid", d)
+        self.assertNotIn(1, d)
+        self.assertIsNone(d.get(1))
+        d["USER_ID"] = 3
+        self.assertEqual(list(d.items()), [("userId", 3), ("HTTPServer", 2)])
+        self.assertIn("user-id", d.keys())
+        self.assertIn(("USER_ID", 3), d.items())
+        self.assertEqual(list(d.values()), [3, 2])
+        self.assertIsInstance(d, collections.abc.MutableMapping)
+        self.assertEqual(d, {"userId": 3, "HTTPServer": 2})
+        self.assertEqual(d, {"user_id": 3, "http_server": 2})
+        self.assertNotEqual(d, {"userId": 3, "user_id": 3})
+        self.assertNotEqual(d, {"userId": 3, "HTTPServer": 1})
+        self.assertNotEqual(d, {1: 3, "HTTPServer": 2})
+        self.assertNotEqual(d, [("userId", 3), ("HTTPServer", 2)])
+        self.assertEqual(d, stringcase.CaseNormalizedDict(USER_ID=3, httpServer=2))
+        self.assertEqual(repr(d), "CaseNormalizedDict({'userId': 3, 'HTTPServer': 2})")
+        self.assertRaises(KeyError, d.__getitem__, "userName")
+        self.assertRaises(TypeError, d.__setitem__, 1, 2)
+
+        for i in range(1000):
+            d["key%dValue" % i] = i
+        for i in range(0, 1000, 2):
+            del d["KEY%d_VALUE" % i]
+        self.assertEqual(len(d), 502)
+        self.assertEqual(list(d)[:3], ["userId", "HTTPServer", "key1Value"])
+        self.assertEqual(d.pop("key999-value"), 999)
+        self.assertEqual(d.pop("key999-value", None), None)
+        self.assertEqual(d.setdefault("größeStraße", []), [])
+        self.assertIs(d["Größe_Straße"], d["größe straße"])
+        copy = d.copy()
+        d.clear()
+        self.assertEqual((len(d), len(copy)), (0, 502))
+        self.assertEqual(list(stringcase.CaseNormalizedDict([("aB", 1)]).keys()), ["aB"])
+        self.assertEqual(copy.popitem(), ("größeStraße", []))
+        self.assertEqual(len(copy), 501)
+        self.assertRaises(KeyError, stringcase.CaseNormalizedDict().popitem)
+
+        self.assertTrue(stringcase.case_equal("parseHTTPResponse", "PARSE_HTTP_RESPONSE"))
+        self.assertTrue(stringcase.case_equal("名前Value", "名前_value"))
+        self.assertFalse(stringcase.case_equal("userId", "userid"))
+        self.assertEqual(stringcase.canonical_hash("userId"), stringcase.canonical_hash("-user  ID-"))
+        self.assertRaises(TypeError, stringcase.case_equal, "a", b"a")
+
+    def test_detect_case(self):
+        styles = {"userId": "camel", "user_id": "snake", "USER_ID": "const", "HTTPServer": "pascal",
+                  "User Id": "title", "user-id": "spinal", "user.id": "dot", "src/user": "path", "x!": "mixed",
+                  "Foo_Bar": "mixed", "user id": "mixed", "": "snake", "größeWert": "camel", "GRÖSSE": "const"}
+        for value, style in styles.items():
+            self.assertEqual(stringcase.detect_case(value), style, value)
+        self.assertEqual(stringcase.detect_case(b"userId"), "camel")
+        self.assertEqual(stringcase.detect_case("x" * 100 + "Y"), "camel")
+        self.assertEqual(stringcase.detect_case_many(list(styles)), list(styles.values()))
+        self.assertEqual(stringcase.detect_case_many(iter(["a_b", "A-b"])), ["snake", "mixed"])
+
+        value = "user_id"
+        self.assertIs(stringcase.ensure_case(value, "snakecase"), value)
+        self.assertEqual(stringcase.ensure_case("userId", "snake"), "user_id")
+        self.assertEqual(stringcase.ensure_case("HTTP_CODE", "const"), "HTTP_CODE")
+        self.assertEqual(stringcase.ensure_case("httpCode", "const"), stringcase.constcase("httpCode"))
+        self.assertEqual(stringcase.ensure_case(bytearray(b"user_id"), "snake"), b"user_id")
+        self.assertEqual(stringcase.ensure_case("fooBar", "lower"), "foobar")
+        self.assertRaises(TypeError, stringcase.detect_case, 1)
+        self.assertRaises(TypeError, stringcase.detect_case_many, ["a", 1])
+        self.assertRaises(ValueError, stringcase.ensure_case, "a", "nope")
+
+    def test_stream(self):
+        data = b"fooBar\nHTTPCode\n\nbaz qux\nlastOne"
+        expected = b"\n".join(stringcase.snakecase(line) for line in data.split(b"\n"))
+        for size in [1, 2, 5, len(data)]:
+            stream = stringcase.StreamConverter("snakecase")
+            chunks = [stream.feed(data[i:i + size]) for i in range(0, len(data), size)]
+            self.assertEqual(stream.pending, len(b"lastOne"))
+            self.assertEqual(b"".join(chunks) + stream.flush(), expected)
+            self.assertEqual(stream.pending, 0)
+
+        # A delimiter split across chunks still ends its record
+        stream = stringcase.StreamConverter("const", delimiter=b"\r\n")
+        self.assertEqual(stream.feed(bytearray(b"fooBar\r")), b"")
+        self.assertEqual(stream.feed(memoryview(b"\nbazQux\r\n")), b"FOO_BAR\r\nBAZ_QUX\r\n")
+        self.assertEqual(stream.flush(), b"")
+        self.assertEqual(repr(stream), "StreamConverter('constcase', delimiter=b'\\r\\n')")
+
+        big = b"someIdentifier\n" * 10000
+        stream = stringcase.StreamConverter("spinalcase")
+        self.assertEqual(stream.feed(big), b"some-identifier\n" * 10000)
+
+        # Multibyte characters, split across chunks, convert as str does
+        text = "über_straße\näpfelBaum\nﬃx·ΐ\nHTTPCode\n\nГрößeЁж"
+        data = text.encode()
+        for case in ["camelcase", "constcase", "titlecase", "alphanumcase", "spinalcase", "uppercase"]:
+            expected = "\n".join(getattr(stringcase, case)(line) for line in text.split("\n")).encode()
+            for size in [1, 2, 3, 7, len(data)]:
+                stream = stringcase.StreamConverter(case)
+                chunks = [stream.feed(data[i:i + size]) for i in range(0, len(data), size)]
+                self.assertEqual(b"".join(chunks) + stream.flush(), expected, (case, size))
+        stream = stringcase.StreamConverter("constcase")
+        self.assertEqual(stream.feed("straße\n".encode() * 20000), b"STRASSE\n" * 20000)
+        self.assertEqual(stream.feed(b"foo\xff"), b"")
+        self.assertRaises(ValueError, stream.feed, b"Bar\nbaz\n")
+        self.assertEqual(stream.pending, 4)
+        self.assertRaises(ValueError, stream.flush)
+
+        self.assertRaises(ValueError, stringcase.StreamConverter, "nocase")
+        self.assertRaises(ValueError, stringcase.StreamConverter, "snakecase", delimiter=b"")
+        self.assertRaises(TypeError, stringcase.StreamConverter("snakecase").feed, "text")
+
+    def test_cache(self):
+        stringcase.cache_configure(8, intern=True, case="snakecase")
+        try:
+            first = stringcase.snakecase("FooBar")
+            self.assertIs(stringcase.snakecase("".join(["Foo", "Bar"])), first)
+            for i in range(100):
+                self.assertEqual(stringcase.snakecase("FooBar%d" % i), "foo_bar%d" % i)
+            self.assertEqual(stringcase.snakecase("FooBar"), "foo_bar")
+            hits, misses, maxsize, currsize = stringcase.cache_info()["snakecase"]
+            self.assertEqual((hits + misses, maxsize), (103, 8))
+            self.assertLessEqual(currsize, 8)
+            self.assertEqual(stringcase.cache_info()["camelcase"], (0, 0, 0, 0))
+            stringcase.cache_clear()
+            self.assertEqual(stringcase.cache_info()["snakecase"], (0, 0, 8, 0))
+            self.assertRaises(ValueError, stringcase.cache_configure, -1)
+            self.assertRaises(ValueError, stringcase.cache_configure, 8, case="nocase")
+        finally:
+            stringcase.cache_configure(0)
+
+    def test_convert_file(self):
+        records = [b"userId,firstName,HTTPCode", b"", b"only", b"a,bC,dE\r", b"x" * 5000] * 3000
+        data = b"\n".join(records)
+        with tempfile.TemporaryDirectory() as tmp:
+            src, dst = os.path.join(tmp, "in.csv"), os.path.join(tmp, "out.csv")
+            for tail in [b"", b"\n"]:
+                with open(src, "wb") as f:
+                    f.write(data + tail)
+                for threads in [None, 3]:
+                    self.assertEqual(stringcase.convert_file(src, dst, "snakecase", threads=threads), len(records))
+                    with open(dst, "rb") as f:
+                        self.assertEqual(f.read(), b"\n".join(
+                            stringcase.snakecase(r[:-1]) + b"\r" if r.endswith(b"\r") else stringcase.snakecase(r)
+                            for r in records) + tail)
+
+                def field2(r):
+                    parts = r.split(b",")
+                    if len(parts) > 1:
+                        parts[1] = stringcase.constcase(parts[1].rstrip(b"\r")) + b"\r" * parts[1].endswith(b"\r")
+                    return b",".join(parts)
+                self.assertEqual(cli.main(["--case", "const", "--field", "2", src, dst]), 0)
+                with open(dst, "rb") as f:
+                    self.assertEqual(f.read(), b"\n".join(field2(r) for r in records) + tail)
+
+            with open(src, "wb") as f:
+                f.write(b"a\tfooBar;b\tbazQux")
+            stringcase.convert_file(src, dst, "spinal", field=2, delimiter=b";", field_delimiter=b"\t")
+            with open(dst, "rb") as f:
+                self.assertEqual(f.read(), b"a\tfoo-bar;b\tbaz-qux")
+            # Multibyte records convert as the str functions do, also in a field
+            text = "über_straße\näpfelBaum\r\nﬃx·ΐ\nid,größe_öl,x\n" * 20000
+            with open(src, "wb") as f:
+                f.write(text.encode())
+            lines = text.split("\n")
+            for case in ["camelcase", "constcase", "titlecase", "alphanumcase"]:
+                convert = getattr(stringcase, case)
+                self.assertEqual(stringcase.convert_file(src, dst, case, threads=2), len(lines) - 1)
+                with open(dst, "rb") as f:
+                    self.assertEqual(f.read().decode(), "\n".join(
+                        convert(r[:-1]) + "\r" if r.endswith("\r") else convert(r) for r in lines))
+            stringcase.convert_file(src, dst, "constcase", field=2)
+            with open(dst, "rb") as f:
+                self.assertEqual(f.read().decode(), text.replace("größe_öl", "GRÖSSE_ÖL"))
+            with open(src, "wb") as f:
+                f.write(b"fooBar\n" * 300000 + b"caf\xe9\nbazQux\n")
+            self.assertRaisesRegex(ValueError, "record 300001", stringcase.convert_file, src, dst, "snakecase")
+            with open(dst, "rb") as f:
+                self.assertEqual(set(f.read().split(b"\n")), {b"foo_bar", b""})
+
+            open(src, "wb").close()
+            self.assertEqual(stringcase.convert_file(src, dst, "snakecase"), 0)
+
+            self.assertRaises(ValueError, stringcase.convert_file, src, src, "snakecase")
+            self.assertRaises(FileNotFoundError, stringcase.convert_file, os.path.join(tmp, "none"), dst, "snakecase")
+            self.assertRaises(ValueError, stringcase.convert_file, src, dst, "nocase")
+            self.assertRaises(ValueError, stringcase.convert_file, src, dst, "snakecase", field=0)
+            self.assertRaises(TypeError, stringcase.convert_file, src, dst, "snakecase", delimiter=b"\r\n")
+
+    def test_arrow(self):
+        values = ["helloWorld", None, "FooBar baz", "größeStraße", "名前Value", "", "x" * 100]
+        result = stringcase.convert_arrow(ArrowProducer(values), "snakecase")
+        self.assertIsInstance(result, stringcase.ArrowStringArray)
+        self.assertEqual(len(result), 7)
+        self.assertEqual(arrow_consume(result), ("u", [None if v is None else stringcase.snakecase(v) for v in values]))
+        # Exports share the buffers, which outlive the array object
+        exported = result.__arrow_c_array__()
+        del result
+        del exported
+        for case in ["camelcase", "titlecase", "sentencecase", "alphanumcase"]:
+            for large in [False, True]:
+                result = stringcase.convert_arrow(ArrowProducer(values, offset=1, large=large), case)
+                expected = [None if v is None else getattr(stringcase, case)(v) for v in values[1:]]
+                self.assertEqual(arrow_consume(result), ("U" if large else "u", expected))
+        self.assertEqual(arrow_consume(stringcase.convert_arrow(ArrowProducer([]), "dotcase")), ("u", []))
+
+        self.assertRaises(ValueError, stringcase.convert_arrow, ArrowProducer(["ok", b"\xff"]), "snakecase")
+        self.assertRaises(TypeError, stringcase.convert_arrow, ArrowProducer(["ok"], format=b"i"), "snakecase")
+        self.assertRaises(TypeError, stringcase.convert_arrow, ["ok"], "snakecase")
+        self.assertRaises(ValueError, stringcase.convert_arrow, ArrowProducer(["ok"]), "nocase")
+
+    def test_loads(self):
+        docs = ['{"userName": "Bob", "tagList": [{"tagName": "x"}, {"tagName": "y"}], "HTTPCode": 200}',
+                '[1, -0, 3.5, -1.5E-3, 12345678901234567890, true, false, null, NaN, -Infinity, "s"]',
+                '{"a\\u00e9B": "\\ud83d\\ude00 \\ud800 \\n\\"", "größeWert": {"": []}, "dupKey": 1, "dup_key": 2}']
+        for doc in docs:
+            for case in ["snakecase", "camelcase", "constcase"]:
+                expected = repr(stringcase.transform_keys(json.loads(doc), case))
+                self.assertEqual(repr(stringcase.loads(doc, case)), expected)
+                self.assertEqual(repr(stringcase.loads(doc.encode(), key_case=case)), expected)
+            self.assertEqual(repr(stringcase.loads(doc, None)), repr(json.loads(doc)))
+        self.assertEqual(stringcase.loads(b'\xef\xbb\xbf{"fooBar": 1}'), {"foo_bar": 1})
+        self.assertEqual(stringcase.loads(bytearray(b' {"fooBar": 1} '), "spinal"), {"foo-bar": 1})
+
+        for doc in ['', '{"a": 1,}', '[1, ]', '[1 2]', '"abc', '"a\x01"', '"\\x"', '"\\u12zz"', '{"é": 1} x', '\ufeff{}']:
+            with self.assertRaises(json.JSONDecodeError) as expected:
+                json.loads(doc)
+            with self.assertRaises(json.JSONDecodeError) as raised:
+                stringcase.loads(doc)
+            self.assertEqual((raised.exception.msg, raised.exception.pos),
+                             (expected.exception.msg, expected.exception.pos))
+
+        def outcome(loads, doc):
+            try:
+                return repr(loads(doc))
+            except json.JSONDecodeError as e:
+                return e.msg, e.pos
+
+        # Random fragments: mostly malformed, in the order json reports errors
+        pieces = list('{}[]",:\\ ntrufalse0123456789-.eEN\x01\n') + ['\\u', '\\ud800', '"aB"', '{"k":', 'é', '名']
+        rng = random.Random(21)
+        for _ in range(20000):
+            doc = "".join(rng.choice(pieces) for _ in range(rng.randint(0, 12)))
+            self.assertEqual(outcome(lambda d: stringcase.loads(d, None), doc), outcome(json.loads, doc), doc)
+        self.assertRaises(UnicodeDecodeError, stringcase.loads, b'"\xff"')
+        self.assertRaises(RecursionError, stringcase.loads, "[" * 100000)
+        self.assertRaises(TypeError, stringcase.loads, 1)
+        self.assertRaises(ValueError, stringcase.loads, "{}", "nocase")
+
+    def test_c_api(self):
+        class CAPI(ctypes.Structure):
+            _fields_ = [("version", ctypes.c_int), ("case_count", ctypes.c_int),
+                        ("find_case", ctypes.PYFUNCTYPE(ctypes.c_int, ctypes.c_char_p)),
+                        ("measure", ctypes.CFUNCTYPE(ctypes.c_ssize_t, ctypes.c_int, ctypes.c_char_p, ctypes.c_ssize_t)),
+                        ("convert_buffer", ctypes.CFUNCTYPE(ctypes.c_ssize_t, ctypes.c_int, ctypes.c_char_p,
+                                                            ctypes.c_ssize_t, ctypes.c_char_p, ctypes.c_ssize_t)),
+                        ("convert", ctypes.PYFUNCTYPE(ctypes.py_object, ctypes.c_int, ctypes.py_object)),
+                        ("convert_many", ctypes.PYFUNCTYPE(ctypes.py_object, ctypes.c_int, ctypes.py_object))]
+
+        get_pointer = ctypes.pythonapi.PyCapsule_GetPointer
+        get_pointer.restype = ctypes.c_void_p
+        get_pointer.argtypes = [ctypes.py_object, ctypes.c_char_p]
+        api = CAPI.from_address(get_pointer(stringcase._C_API, b"fast_stringcase._C_API"))
+        self.assertEqual((api.version, api.case_count), (1, 15))
+        self.assertTrue(os.path.isfile(os.path.join(stringcase.get_include(), "fast_stringcase_capi.h")))
+
+        snake = api.find_case(b"snake")
+        self.assertEqual(snake, api.find_case(b"snakecase"))
+        self.assertRaises(ValueError, api.find_case, b"nocase")
+        self.assertEqual(api.measure(snake, b"helloWorld", 10), 11)
+        for capacity in [11, 12, 64]:  # Exact fits go through a temporary
+            out = ctypes.create_string_buffer(b"#" * capacity, capacity)
+            self.assertEqual(api.convert_buffer(snake, b"helloWorld", 10, out, capacity), 11)
+            self.assertEqual(out.raw, b"hello_world" + b"#" * (capacity - 11))
+        long_input = b"fooBar" * 100
+        out = ctypes.create_string_buffer(700)
+        self.assertEqual(api.convert_buffer(snake, long_input, 600, out, 700), 700)
+        self.assertEqual(out.raw, stringcase.snakecase(long_input))
+        self.assertEqual(api.convert_buffer(snake, b"helloWorld", 10, out, 5), 11)  # Too small: nothing written
+        self.assertEqual(api.convert_buffer(snake, b"", 0, None, 0), 0)
+        self.assertEqual(api.convert_buffer(99, b"x", 1, out, 700), -1)
+
+        self.assertEqual(api.convert(snake, "helloWorld"), "hello_world")
+        self.assertEqual(api.convert(snake, bytearray(b"helloWorld")), b"hello_world")
+        self.assertEqual(api.convert_many(snake, ("fooBar", "名前X")), ["foo_bar", "名前_x"])
+        self.assertRaises(TypeError, api.convert, snake, 1)
+        self.assertRaises(ValueError, api.convert, 99, "x")
+
+    def test_stats(self):
+        previous = stringcase.enable_stats()
+        try:
+            stringcase.reset_stats()
+            stringcase.snakecase("helloWorld")
+            stringcase.snakecase("hello")
+            stringcase.snakecase_many(["fooBar", "名前X"])
+            stringcase.snakecase(b"fooBar")
+            stringcase.snakecase_inplace(bytearray(b"foo"))
+            snake = stringcase.stats()["snakecase"]
+            self.assertEqual(snake["calls"], 5)
+            self.assertEqual(snake["strings"], 6)
+            self.assertEqual(snake["input_bytes"], 10 + 5 + 6 + 3 * 2 + 6 + 3)
+            self.assertEqual(snake["allocations"], 5)  # The non-ASCII item also grows the scratch buffer
+            self.assertEqual(sum(snake["latency"].values()), 5)
+            self.assertGreater(snake["time_ns"], 0)
+            self.assertEqual(stringcase.stats()["camelcase"]["calls"], 0)
+
+            stringcase.enable_stats(False)
+            stringcase.snakecase("fooBar")
+            self.assertEqual(stringcase.stats()["snakecase"]["calls"], 5)
+            stringcase.reset_stats()
+            self.assertEqual(stringcase.stats()["snakecase"]["strings"], 0)
+        finally:
+            stringcase.enable_stats(previous)
+            stringcase.reset_stats()
+
+    def test_threads(self):
+        # Every thread shares the caches, one CaseNormalizedDict and one
+        # StreamConverter; on a free-threaded build they really run at once
+        words = ["userId%d" % i for i in range(200)] + ["größeWert%d" % i for i in range(50)]
+        expected = [stringcase.snakecase(w) for w in words]
+        shared = stringcase.CaseNormalizedDict()
+        stream = stringcase.StreamConverter("snakecase")
+        errors = []
+
+        def work(seed):
+            try:
+                for round_ in range(20):
+                    self.assertEqual([stringcase.snakecase(w) for w in words], expected)
+                    self.assertEqual(stringcase.snakecase_many(words), expected)
+                    for w in words[seed::8]:
+                        shared[w] = seed
+                        self.assertIn(stringcase.spinalcase(w), shared)
+                    try:
+                        out = stream.feed(b"fooBar\nbazQux\n")
+                        self.assertEqual(len(out) % len(b"foo_bar\n"), 0)
+                    except RuntimeError:
+                        pass  # Another thread's feed() is converting
+                    if seed == 0 and round_ % 5 == 0:
+                        stringcase.cache_clear()
+            except Exception as e:
+                errors.append(e)
+
+        stringcase.cache_configure(64)
+        try:
+            threads = [threading.Thread(target=work, args=(seed,)) for seed in range(8)]
+            for t in threads:
+                t.start()
+            for t in threads:
+                t.join()
+        finally:
+            stringcase.cache_configure(0)
+        self.assertEqual(errors, [])
+        self.assertEqual(len(shared), len(words))
+        self.assertEqual(stream.flush(), b"")
+
+    def test_shared_buffer_mutation(self):
+        # Without the GIL the writer runs between measuring and converting;
+        # every result must be that of one whole state of the buffer
+        states = [b"ab" * 100, b"aB" * 100, b"AB_" * 66 + b"xy"]
+        json_states = [b'{"userId": 1}', b'{"user_x": 1}']
+        data, doc = bytearray(states[0]), bytearray(json_states[0])
+        snakes = {stringcase.snakecase(s) for s in states}
+        keys = [{"user_id": 1}, {"user_x": 1}]
+        stop, errors = threading.Event(), []
+
+        def writer():
+            i = 0
+            while not stop.is_set():
+                i += 1
+                data[:] = states[i % len(states)]
+                doc[:] = json_states[i % 2]
+
+        def reader():
+            try:
+                out = bytearray(512)
+                for _ in range(3000):
+                    self.assertIn(stringcase.snakecase(data), snakes)
+                    self.assertIn(bytes(out[:stringcase.snakecase(data, out=out)]), snakes)
+                    self.assertIn(stringcase.loads(doc), keys)
+                    try:
+                        stringcase.snakecase_inplace(data)
+                    except ValueError:
+                        pass
+            except Exception as e:
+                errors.append(e)
+
+        previous = sys.getswitchinterval()
+        sys.setswitchinterval(1e-6)
+        threads = [threading.Thread(target=writer)] + [threading.Thread(target=reader) for _ in range(3)]
+        try:
+            for t in threads:
+                t.start()
+            for t in threads[1:]:
+                t.join()
+        finally:
+            stop.set()
+            threads[0].join()
+            sys.setswitchinterval(previous)
+        self.assertEqual(errors, [])
+
+    @unittest.skipUnless(not getattr(sys, "_is_gil_enabled", lambda: True)() and (os.cpu_count() or 1) >= 4,
+                         "needs a free-threaded build and 4 CPUs")
+    def test_threads_scale(self):
+        words = ["parseHTTPResponse%d" % i for i in range(1000)]
+
+        def work():
+            for _ in range(200):
+                for w in words:
+                    stringcase.snakecase(w)
+
+        def elapsed(count):
+            threads = [threading.Thread(target=work) for _ in range(count)]
+            start = time.perf_counter()
+            for t in threads:
+                t.start()
+            for t in threads:
+                t.join()
+            return time.perf_counter() - start
+
+        one = min(elapsed(1) for _ in range(3))
+        four = min(elapsed(4) for _ in range(3))
+        # Four times the work in well under four times the time
+        self.assertLess(four, 2 * one)
+
+    def test_subinterpreters(self):
+        try:
+            import _interpreters as interpreters
+            create = lambda: interpreters.create(interpreters.new_config("isolated"))
+            run = interpreters.exec
+        except ImportError:
+            try:
+                import _xxsubinterpreters as interpreters
+            except ImportError:
+                self.skipTest("no subinterpreter support")
+            create = lambda: interpreters.create(isolated=True)
+            run = interpreters.run_string
+        # Each interpreter, with its own GIL, gets its own caches and types
+        path = os.path.dirname(os.path.dirname(os.path.abspath(stringcase.__file__)))
+        stringcase.cache_configure(8)
+        try:
+            interp = create()
+            try:
+                self.assertIsNone(run(interp, "import sys\n"
+                                              "sys.path.insert(0, %r)\n"
+                                              "import fast_stringcase as f\n"
+                                              "assert f.cache_info()['snakecase'] == (0, 0, 0, 0)\n"
+                                              "assert f.CaseNormalizedDict(userId=1)['user_id'] == 1\n" % path))
+            finally:
+                interpreters.destroy(interp)
+            self.assertEqual(stringcase.cache_info()["snakecase"][2], 8)
+        finally:
+            stringcase.cache_configure(0)
+
 
 if __name__ == "__main__":
     unittest.main()
@@ -0,0 +1,155 @@
+"""Generate fast_stringcase/unicase_data.h from the running Python's unicodedata.
+
+    python tools/gen_unicase.py
+
+Every code point maps to a record of class flags and simple (one-to-one)
+case-mapping deltas. Records are looked up through a two-stage table whose
+block size is chosen to minimise the total size. Code points whose full
+uppercase mapping is longer than one code point, such as U+00DF (ß -> SS),
+are flagged, and their expansions are listed in a separate sorted table.
+"""
+
+import sys
+import unicodedata
+from pathlib import Path
+
+OUTPUT = Path(__file__).resolve().parent.parent / "fast_stringcase" / "unicase_data.h"
+
+UC_UPPER = 0x01
+UC_LOWER = 0x02
+UC_ALNUM = 0x04
+UC_SPACE = 0x08
+UC_UPPER_EXPANDS = 0x10
+
+
+def simple_lower(ch):
+    lower = ch.lower()
+    # Only U+0130 lowercases to more than one character; its simple mapping
+    # is the first one
+    return lower[0]
+
+
+def simple_upper(ch):
+    upper = ch.upper()
+    if len(upper) == 1:
+        return upper
+    # Characters such as U+1FB3 whose full uppercase mapping expands have a
+    # simple mapping to their single-character titlecase form, if any
+    title = ch.title()
+    return title if len(title) == 1 else ch
+
+
+def record(cp):
+    ch = chr(cp)
+    flags = ((UC_UPPER if ch.isupper() else 0)
+             | (UC_LOWER if ch.islower() else 0)
+             | (UC_ALNUM if ch.isalnum() else 0)
+             | (UC_SPACE if ch.isspace() else 0)
+             | (UC_UPPER_EXPANDS if len(ch.upper()) > 1 else 0))
+    return (flags, ord(simple_lower(ch)) - cp, ord(simple_upper(ch)) - cp)
+
+
+def split(indices, shift):
+    block_size = 1 << shift
+    blocks, index1, index2 = {}, [], []
+    for start in range(0, len(indices), block_size):
+        block = tuple(indices[start:start + block_size])
+        if block not in blocks:
+            blocks[block] = len(blocks)
+            index2.extend(block)
+        index1.append(blocks[block])
+    return index1, index2
+
+
+def ctype(values):
+    return "uint8_t" if max(values) < 256 else "uint16_t"
+
+
+def size(values):
+    return len(values) * (1 if max(values) < 256 else 2)
+
+
+def emit_array(lines, decl, values, per_line=16):
+    lines.append(decl + " = {")
+    for start in range(0, len(values), per_line):
+        lines.append("    " + ", ".join(str(v) for v in values[start:start + per_line]) + ",")
+    lines.append("};")
+
+
+def main():
+    records = {(0, 0, 0): 0}
+    indices = []
+    for cp in range(sys.maxunicode + 1):
+        indices.append(records.setdefault(record(cp), len(records)))
+    assert len(records) < 256
+    expansions = [(cp, chr(cp).upper()) for cp in range(sys.maxunicode + 1) if len(chr(cp).upper()) > 1]
+    upper_max = max(len(upper) for cp, upper in expansions)
+
+    # Everything past the last interesting code point uses record 0
+    limit = max(cp for cp, index in enumerate(indices) if index) + 1
+
+    best = None
+    for shift in range(4, 11):
+        block_size = 1 << shift
+        padded = indices[:(limit + block_size - 1) // block_size * block_size]
+        padded += [0] * (-len(padded) % block_size)
+        index1, index2 = split(padded, shift)
+        total = size(index1) + size(index2)
+        if best is None or total < best[0]:
+            best = (total, shift, len(padded), index1, index2)
+    total, shift, limit, index1, index2 = best
+
+    lines = [
+        "// Generated by tools/gen_unicase.py from Unicode %s. Do not edit." % unicodedata.unidata_version,
+        "",
+        "#ifndef FAST_STRINGCASE_UNICASE_DATA_H",
+        "#define FAST_STRINGCASE_UNICASE_DATA_H",
+        "",
+        "#include <stdint.h>",
+        "",
+        "#define UC_UPPER 0x%02x" % UC_UPPER,
+        "#define UC_LOWER 0x%02x" % UC_LOWER,
+        "#define UC_ALNUM 0x%02x" % UC_ALNUM,
+        "#define UC_SPACE 0x%02x" % UC_SPACE,
+        "#define UC_UPPER_EXPANDS 0x%02x // Full uppercase mapping is in uc_upper_expansions" % UC_UPPER_EXPANDS,
+        "",
+        "#define UC_UPPER_MAX %d // Longest full uppercase mapping, in code points" % upper_max,
+        "#define UC_SHIFT %d" % shift,
+        "#define UC_LIMIT 0x%X // Code points from here on use record 0" % limit,
+        "",
+        "typedef struct {",
+        "    uint8_t flags;",
+        "    int32_t lower; // Simple lowercase mapping minus the code point",
+        "    int32_t upper; // Simple uppercase mapping minus the code point",
+        "} UnicaseRecord;",
+        "",
+        "static const UnicaseRecord uc_records[] = {",
+    ]
+    for flags, lower, upper in sorted(records, key=records.get):
+        lines.append("    {0x%02x, %d, %d}," % (flags, lower, upper))
+    lines.append("};")
+    lines.append("")
+    emit_array(lines, "static const %s uc_index1[]" % ctype(index1), index1)
+    lines.append("")
+    emit_array(lines, "static const %s uc_index2[]" % ctype(index2), index2)
+    lines.append("")
+    lines.append("typedef struct {")
+    lines.append("    uint32_t cp;")
+    lines.append("    uint32_t upper[UC_UPPER_MAX]; // Full uppercase mapping, 0-padded")
+    lines.append("} UnicaseExpansion;")
+    lines.append("")
+    lines.append("// By code point, for binary search")
+    lines.append("static const UnicaseExpansion uc_upper_expansions[] = {")
+    for cp, upper in expansions:
+        padded = [ord(c) for c in upper] + [0] * (upper_max - len(upper))
+        lines.append("    {0x%04X, {%s}}," % (cp, ", ".join("0x%04X" % c if c else "0" for c in padded)))
+    lines.append("};")
+    lines.append("")
+    lines.append("#endif // FAST_STRINGCASE_UNICASE_DATA_H")
+    OUTPUT.write_text("\n".join(lines) + "\n")
+    print("%s: %d records, shift %d, %d bytes of index, %d expansions"
+          % (OUTPUT.name, len(records), shift, total, len(expansions)))
+
+
+if __name__ == "__main__":
+    main()